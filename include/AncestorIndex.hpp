@@ -0,0 +1,130 @@
+/**
+* @file AncestorIndex.hpp
+* @brief The AncestorIndex class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-20
+*/
+
+
+
+#ifndef GRAVITREE_ANCESTORINDEX_HPP
+#define GRAVITREE_ANCESTORINDEX_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace gravitree
+{
+
+/**
+* @brief An index over a forest of slots for finding lowest common ancestors
+* in O(log d) time, where d is the depth of the tree. It stores, for each
+* slot, its depth and its 2^k-th ancestor for every k (binary lifting).
+* Adding a leaf updates the index in O(log d) time, while re-parenting a slot
+* causes the index to be rebuilt in O(n log d) time on its next use.
+*/
+class AncestorIndex
+{
+  public:
+    /**
+    * @brief The parent of a slot which has none.
+    */
+    static constexpr size_t const NO_PARENT = static_cast<size_t>(-1);
+
+    /**
+    * @brief Create a new empty index.
+    */
+    AncestorIndex();
+
+    /**
+    * @brief Add a slot as a new leaf. The slot must not be in use.
+    *
+    * @param slot The slot.
+    * @param parent The parent slot (or NO_PARENT).
+    */
+    void add(
+        size_t slot,
+        size_t parent);
+
+    /**
+    * @brief Remove a slot. The slot must no longer have any children.
+    *
+    * @param slot The slot.
+    */
+    void remove(
+        size_t slot) noexcept;
+
+    /**
+    * @brief Change the parent of a slot.
+    *
+    * @param slot The slot.
+    * @param parent The new parent slot (or NO_PARENT).
+    */
+    void setParent(
+        size_t slot,
+        size_t parent) noexcept;
+
+    /**
+    * @brief Get the parent of a slot.
+    *
+    * @param slot The slot.
+    *
+    * @return The parent slot (or NO_PARENT).
+    */
+    size_t parent(
+        size_t slot) const noexcept;
+
+    /**
+    * @brief Get the depth of a slot (the number of ancestors it has).
+    *
+    * @param slot The slot.
+    *
+    * @return The depth.
+    */
+    size_t depth(
+        size_t slot) const;
+
+    /**
+    * @brief Find the deepest slot which is an ancestor of (or equal to) both
+    * of the given slots.
+    *
+    * @param a The first slot.
+    * @param b The second slot.
+    *
+    * @return The common ancestor, or NO_PARENT if the slots are in different
+    * trees.
+    */
+    size_t lowestCommonAncestor(
+        size_t a,
+        size_t b) const;
+
+    /**
+    * @brief Rebuild the index now if it is stale. Queries never modify an
+    * up-to-date index, so after this they may be made from several threads
+    * at once.
+    */
+    void update() const;
+
+  private:
+    // m_jumps[k][slot] is the 2^k-th ancestor of slot, or the root of its
+    // tree if it has fewer ancestors
+    mutable std::vector<std::vector<size_t>> m_jumps;
+    mutable std::vector<size_t> m_depths;
+    std::vector<size_t> m_parents;
+    mutable bool m_stale;
+
+    /**
+    * @brief Fill in the depth and ancestors of a slot from those of its
+    * parent.
+    *
+    * @param slot The slot.
+    */
+    void link(
+        size_t slot) const noexcept;
+};
+
+}
+
+#endif
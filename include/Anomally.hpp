@@ -0,0 +1,304 @@
+/**
+* @file Anomally.hpp
+* @brief The Anomally class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-14
+*/
+
+
+
+#ifndef GRAVITREE_ANOMALLY_HPP
+#define GRAVITREE_ANOMALLY_HPP
+
+#include "Types.hpp"
+
+#include <cstddef>
+
+namespace gravitree
+{
+
+/**
+* @brief Conversions between the true, eccentric (or hyperbolic) and mean
+* anomallies. Each conversion also has an array version, a bulk interface
+* which converts every element in turn as the single version does, so that
+* callers holding arrays of anomallies need not write the loop themselves.
+*/
+class Anomally
+{
+  public:
+    /**
+    * @brief Convert a true anomally to an eccentric anomally.
+    *
+    * @param trueAnomally The true anomally (v).
+    * @param eccentricity The eccentricity of the orbit (e < 1).
+    *
+    * @return The eccentric anomally (E).
+    */
+    static radian_type eccentricFromTrue(
+        radian_type trueAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert many true anomallies to eccentric anomallies at once. Each
+    * result is identical to that of the single version.
+    *
+    * @param trueAnomallies The true anomallies (v).
+    * @param eccentricities The eccentricity of each orbit (e < 1).
+    * @param eccentricAnomallies The array to fill with the eccentric anomallies
+    * (E).
+    * @param num The number of anomallies.
+    */
+    static void eccentricFromTrue(
+        radian_type const * trueAnomallies,
+        double const * eccentricities,
+        radian_type * eccentricAnomallies,
+        size_t num) noexcept;
+
+    /**
+    * @brief Convert an eccentric anomally to a mean anomally using Kepler's
+    * equation.
+    *
+    * \f[
+    *    M = E - e \sin E
+    * \f]
+    *
+    * @param eccentricAnomally The eccentric anomally (E).
+    * @param eccentricity The eccentricity of the orbit (e < 1).
+    *
+    * @return The mean anomally (M).
+    */
+    static radian_type meanFromEccentric(
+        radian_type eccentricAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert many eccentric anomallies to mean anomallies at once. Each
+    * result is identical to that of the single version.
+    *
+    * @param eccentricAnomallies The eccentric anomallies (E).
+    * @param eccentricities The eccentricity of each orbit (e < 1).
+    * @param meanAnomallies The array to fill with the mean anomallies (M).
+    * @param num The number of anomallies.
+    */
+    static void meanFromEccentric(
+        radian_type const * eccentricAnomallies,
+        double const * eccentricities,
+        radian_type * meanAnomallies,
+        size_t num) noexcept;
+
+    /**
+    * @brief Convert a mean anomally to an eccentric anomally by solving
+    * Kepler's equation. This uses a fixed amount of work (no iteration) and
+    * is accurate to within a few ulp for all e < 1.
+    *
+    * @param meanAnomally The mean anomally (M).
+    * @param eccentricity The eccentricity of the orbit (e < 1).
+    *
+    * @return The eccentric anomally (E), differing from M by less than pi.
+    */
+    static radian_type eccentricFromMean(
+        radian_type meanAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert a mean anomally to an eccentric anomally, starting from
+    * the eccentric anomally of a nearby mean anomally (e.g., that of the
+    * previous time step). When the guess is close this converges in one or
+    * two iterations without evaluating any trigonometric functions beyond
+    * those of the guess, otherwise it falls back to the single version.
+    *
+    * @param meanAnomally The mean anomally (M).
+    * @param eccentricity The eccentricity of the orbit (e < 1).
+    * @param guess The eccentric anomally of a nearby mean anomally.
+    *
+    * @return The eccentric anomally (E).
+    */
+    static radian_type eccentricFromMean(
+        radian_type meanAnomally,
+        double eccentricity,
+        radian_type guess) noexcept;
+
+    /**
+    * @brief Convert many mean anomallies to eccentric anomallies at once.
+    * Each result is identical to that of the single version.
+    *
+    * @param meanAnomallies The mean anomallies (M).
+    * @param eccentricities The eccentricity of each orbit (e < 1).
+    * @param eccentricAnomallies The array to fill with the eccentric
+    * anomallies (E).
+    * @param num The number of anomallies.
+    */
+    static void eccentricFromMean(
+        radian_type const * meanAnomallies,
+        double const * eccentricities,
+        radian_type * eccentricAnomallies,
+        size_t num) noexcept;
+
+    /**
+    * @brief Convert a true anomally to a hyperbolic anomally.
+    *
+    * @param trueAnomally The true anomally (v), within the asymptotes of the
+    * orbit.
+    * @param eccentricity The eccentricity of the orbit (e > 1).
+    *
+    * @return The hyperbolic anomally (H).
+    */
+    static radian_type hyperbolicFromTrue(
+        radian_type trueAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert many true anomallies to hyperbolic anomallies at once. Each
+    * result is identical to that of the single version.
+    *
+    * @param trueAnomallies The true anomallies (v).
+    * @param eccentricities The eccentricity of each orbit (e > 1).
+    * @param hyperbolicAnomallies The array to fill with the hyperbolic
+    * anomallies (H).
+    * @param num The number of anomallies.
+    */
+    static void hyperbolicFromTrue(
+        radian_type const * trueAnomallies,
+        double const * eccentricities,
+        radian_type * hyperbolicAnomallies,
+        size_t num) noexcept;
+
+    /**
+    * @brief Convert a hyperbolic anomally to a mean anomally using the
+    * hyperbolic form of Kepler's equation.
+    *
+    * \f[
+    *    M = e \sinh H - H
+    * \f]
+    *
+    * @param hyperbolicAnomally The hyperbolic anomally (H).
+    * @param eccentricity The eccentricity of the orbit (e > 1).
+    *
+    * @return The mean anomally (M).
+    */
+    static radian_type meanFromHyperbolic(
+        radian_type hyperbolicAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert many hyperbolic anomallies to mean anomallies at once. Each
+    * result is identical to that of the single version.
+    *
+    * @param hyperbolicAnomallies The hyperbolic anomallies (H).
+    * @param eccentricities The eccentricity of each orbit (e > 1).
+    * @param meanAnomallies The array to fill with the mean anomallies (M).
+    * @param num The number of anomallies.
+    */
+    static void meanFromHyperbolic(
+        radian_type const * hyperbolicAnomallies,
+        double const * eccentricities,
+        radian_type * meanAnomallies,
+        size_t num) noexcept;
+
+    /**
+    * @brief Convert a mean anomally to a hyperbolic anomally by solving the
+    * hyperbolic form of Kepler's equation. Like eccentricFromMean(), this
+    * uses a fixed amount of work, and remains accurate as the eccentricity
+    * approaches one (near parabolic orbits).
+    *
+    * @param meanAnomally The mean anomally (M).
+    * @param eccentricity The eccentricity of the orbit (e > 1).
+    *
+    * @return The hyperbolic anomally (H).
+    */
+    static radian_type hyperbolicFromMean(
+        radian_type meanAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert a mean anomally to a hyperbolic anomally, starting from
+    * the hyperbolic anomally of a nearby mean anomally, as the eccentric
+    * version above.
+    *
+    * @param meanAnomally The mean anomally (M).
+    * @param eccentricity The eccentricity of the orbit (e > 1).
+    * @param guess The hyperbolic anomally of a nearby mean anomally.
+    *
+    * @return The hyperbolic anomally (H).
+    */
+    static radian_type hyperbolicFromMean(
+        radian_type meanAnomally,
+        double eccentricity,
+        radian_type guess) noexcept;
+
+    /**
+    * @brief Convert many mean anomallies to hyperbolic anomallies at once.
+    * Each result is identical to that of the single version.
+    *
+    * @param meanAnomallies The mean anomallies (M).
+    * @param eccentricities The eccentricity of each orbit (e > 1).
+    * @param hyperbolicAnomallies The array to fill with the hyperbolic
+    * anomallies (H).
+    * @param num The number of anomallies.
+    */
+    static void hyperbolicFromMean(
+        radian_type const * meanAnomallies,
+        double const * eccentricities,
+        radian_type * hyperbolicAnomallies,
+        size_t num) noexcept;
+
+    /**
+    * @brief Convert a hyperbolic anomally to a true anomally.
+    *
+    * @param hyperbolicAnomally The hyperbolic anomally (H).
+    * @param eccentricity The eccentricity of the orbit (e > 1).
+    *
+    * @return The true anomally (v).
+    */
+    static radian_type trueFromHyperbolic(
+        radian_type hyperbolicAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert many hyperbolic anomallies to true anomallies at once. Each
+    * result is identical to that of the single version.
+    *
+    * @param hyperbolicAnomallies The hyperbolic anomallies (H).
+    * @param eccentricities The eccentricity of each orbit (e > 1).
+    * @param trueAnomallies The array to fill with the true anomallies (v).
+    * @param num The number of anomallies.
+    */
+    static void trueFromHyperbolic(
+        radian_type const * hyperbolicAnomallies,
+        double const * eccentricities,
+        radian_type * trueAnomallies,
+        size_t num) noexcept;
+
+    /**
+    * @brief Convert an eccentric anomally to a true anomally.
+    *
+    * @param eccentricAnomally The eccentric anomally (E).
+    * @param eccentricity The eccentricity of the orbit (e < 1).
+    *
+    * @return The true anomally (v).
+    */
+    static radian_type trueFromEccentric(
+        radian_type eccentricAnomally,
+        double eccentricity) noexcept;
+
+    /**
+    * @brief Convert many eccentric anomallies to true anomallies at once. Each
+    * result is identical to that of the single version.
+    *
+    * @param eccentricAnomallies The eccentric anomallies (E).
+    * @param eccentricities The eccentricity of each orbit (e < 1).
+    * @param trueAnomallies The array to fill with the true anomallies (v).
+    * @param num The number of anomallies.
+    */
+    static void trueFromEccentric(
+        radian_type const * eccentricAnomallies,
+        double const * eccentricities,
+        radian_type * trueAnomallies,
+        size_t num) noexcept;
+};
+
+}
+
+#endif
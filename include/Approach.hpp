@@ -0,0 +1,85 @@
+/**
+* @file Approach.hpp
+* @brief The Approach class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-24
+*/
+
+
+
+#ifndef GRAVITREE_APPROACH_HPP
+#define GRAVITREE_APPROACH_HPP
+
+#include "Body.hpp"
+#include "Types.hpp"
+
+namespace gravitree
+{
+
+/**
+* @brief The closest approach of one body to another over some interval of
+* time.
+*/
+class Approach
+{
+  public:
+    /**
+    * @brief Create a new approach.
+    *
+    * @param body The body being approached.
+    * @param time The time of the closest approach, in seconds from the
+    * current time of the system.
+    * @param distance The distance between the bodies at that time.
+    */
+    Approach(
+        Body const * const body,
+        second_type const time,
+        meter_type const distance) noexcept :
+      m_body(body),
+      m_time(time),
+      m_distance(distance)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the body being approached.
+    *
+    * @return The body.
+    */
+    inline Body const * body() const noexcept
+    {
+      return m_body;
+    }
+
+    /**
+    * @brief Get the time of the closest approach.
+    *
+    * @return The seconds from the current time of the system.
+    */
+    inline second_type time() const noexcept
+    {
+      return m_time;
+    }
+
+    /**
+    * @brief Get the distance between the bodies at their closest.
+    *
+    * @return The distance.
+    */
+    inline meter_type distance() const noexcept
+    {
+      return m_distance;
+    }
+
+  private:
+    Body const * m_body;
+    second_type m_time;
+    meter_type m_distance;
+};
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+/**
+* @file AttitudeArray.hpp
+* @brief The AttitudeArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_ATTITUDEARRAY_HPP
+#define GRAVITREE_ATTITUDEARRAY_HPP
+
+#include "Quaternion.hpp"
+#include "Rotation.hpp"
+#include "Types.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace gravitree
+{
+
+/**
+* @brief A structure-of-arrays store of the attitudes (orientation and
+* constant angular velocity) of bodies, indexed by slot. The orientation of
+* each slot is a unit quaternion taking vectors from the body's frame to the
+* frame its position is given in, and its angular velocity is about an axis
+* in that same frame.
+*
+* Propagating by a time step multiplies each orientation by the rotation of
+* its angular velocity over the step. As the step is usually the same from
+* tick to tick, these rotations are cached per slot, so that most passes are
+* a branch-free quaternion product over dense arrays without any
+* trigonometry. Unused slots hold the identity and no angular velocity.
+*/
+class AttitudeArray
+{
+  public:
+    /**
+    * @brief Create a new empty array.
+    */
+    AttitudeArray();
+
+    /**
+    * @brief Get the number of slots.
+    *
+    * @return The number of slots.
+    */
+    size_t size() const noexcept;
+
+    /**
+    * @brief Set the attitude of a slot, adding slots as needed.
+    *
+    * @param slot The slot.
+    * @param orientation The orientation (a unit quaternion).
+    * @param angularVelocity The angular velocity (an axis, and an angle in
+    * radians per second).
+    */
+    void add(
+        size_t slot,
+        Quaternion const & orientation,
+        Rotation const & angularVelocity);
+
+    /**
+    * @brief Reset a slot to the identity with no angular velocity.
+    *
+    * @param slot The slot.
+    */
+    void remove(
+        size_t slot) noexcept;
+
+    /**
+    * @brief Get the orientation of a slot.
+    *
+    * @param slot The slot.
+    *
+    * @return The orientation.
+    */
+    Quaternion orientation(
+        size_t slot) const noexcept;
+
+    /**
+    * @brief Set the orientation of a slot.
+    *
+    * @param slot The slot.
+    * @param orientation The orientation (a unit quaternion).
+    */
+    void setOrientation(
+        size_t slot,
+        Quaternion const & orientation) noexcept;
+
+    /**
+    * @brief Set the angular velocity of a slot.
+    *
+    * @param slot The slot.
+    * @param angularVelocity The angular velocity (an axis, and an angle in
+    * radians per second).
+    */
+    void setAngularVelocity(
+        size_t slot,
+        Rotation const & angularVelocity) noexcept;
+
+    /**
+    * @brief Advance the orientations of a range of slots. Ranges which do not
+    * overlap may be propagated concurrently.
+    *
+    * @param begin The first slot.
+    * @param end The slot after the last.
+    * @param seconds The time step.
+    */
+    void propagate(
+        size_t begin,
+        size_t end,
+        second_type seconds) noexcept;
+
+  private:
+    // the orientation quaternions
+    std::vector<double> m_w;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+
+    // the angular velocity vectors (radians per second about each axis)
+    std::vector<double> m_rateX;
+    std::vector<double> m_rateY;
+    std::vector<double> m_rateZ;
+
+    // the rotation over the most recent step, and the length of that step
+    // (NaN when the rotation must be recomputed)
+    std::vector<double> m_stepW;
+    std::vector<double> m_stepX;
+    std::vector<double> m_stepY;
+    std::vector<double> m_stepZ;
+    std::vector<second_type> m_stepSeconds;
+
+    /**
+    * @brief Recompute the cached rotation of a slot for a time step.
+    *
+    * @param slot The slot.
+    * @param seconds The time step.
+    */
+    void updateStep(
+        size_t slot,
+        second_type seconds) noexcept;
+};
+
+}
+
+#endif
@@ -56,6 +56,15 @@ class Body
     */
     kilo_type mass() const noexcept;
 
+    /**
+    * @brief Set the mass of the object. The mass of a body in a SolarSystem
+    * must be changed through SolarSystem::setMass().
+    *
+    * @param mass The mass.
+    */
+    void setMass(
+        kilo_type mass) noexcept;
+
     /**
     * @brief Get the angular velocity of this object.
     *
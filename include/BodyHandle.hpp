@@ -0,0 +1,112 @@
+/**
+* @file BodyHandle.hpp
+* @brief The BodyHandle class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-18
+*/
+
+
+
+#ifndef GRAVITREE_BODYHANDLE_HPP
+#define GRAVITREE_BODYHANDLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gravitree
+{
+
+/**
+* @brief A reference to a body in a SolarSystem which resolves in constant
+* time. It is made of the slot the body occupies and the generation of that
+* slot, so a handle to a removed body is detected as stale even after its
+* slot has been reused.
+*/
+class BodyHandle
+{
+  public:
+    using generation_type = uint32_t;
+
+    /**
+    * @brief Create a handle which refers to no body.
+    */
+    BodyHandle() noexcept :
+      m_slot(static_cast<size_t>(-1)),
+      m_generation(0)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the slot of the body.
+    *
+    * @return The slot.
+    */
+    inline size_t slot() const noexcept
+    {
+      return m_slot;
+    }
+
+    /**
+    * @brief Get the generation of the slot when the handle was issued.
+    *
+    * @return The generation.
+    */
+    inline generation_type generation() const noexcept
+    {
+      return m_generation;
+    }
+
+    /**
+    * @brief Check if this handle is equal to another.
+    *
+    * @param other The other handle.
+    *
+    * @return True if the handles refer to the same body.
+    */
+    inline bool operator==(
+        BodyHandle const & other) const noexcept
+    {
+      return m_slot == other.m_slot && m_generation == other.m_generation;
+    }
+
+    /**
+    * @brief Check if this handle is not equal to another.
+    *
+    * @param other The other handle.
+    *
+    * @return True if the handles refer to different bodies.
+    */
+    inline bool operator!=(
+        BodyHandle const & other) const noexcept
+    {
+      return !this->operator==(other);
+    }
+
+  private:
+    friend class SolarSystem;
+
+    size_t m_slot;
+    generation_type m_generation;
+
+    /**
+    * @brief Create a new handle.
+    *
+    * @param slot The slot of the body.
+    * @param generation The generation of the slot.
+    */
+    BodyHandle(
+        size_t const slot,
+        generation_type const generation) noexcept :
+      m_slot(slot),
+      m_generation(generation)
+    {
+      // do nothing
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,359 @@
+/**
+* @file Catalog.hpp
+* @brief The Catalog class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_CATALOG_HPP
+#define GRAVITREE_CATALOG_HPP
+
+#include "CatalogBody.hpp"
+#include "KeplerOrbit.hpp"
+#include "OrbitFormula.hpp"
+
+#include <cstddef>
+#include <limits>
+
+namespace gravitree
+{
+
+/**
+* @brief The quantities derived from the orbits of a catalog of bodies, as
+* constexpr functions, so that for a constexpr catalog they are found at
+* compile time (e.g., to size time steps, or to check the catalog with
+* static_assert). They are found with the formulas KeplerOrbit uses
+* (OrbitFormula), taking square roots with ConstexprSqrt, and so match those
+* of KeplerOrbit to within the rounding of the square root. All of them at
+* once (see derived() and CatalogOrbits) let SolarSystem::addBodies() create
+* the orbits without computing them again.
+*
+* The functions are limited to C++11 constexpr, where each is a single
+* expression and cannot loop, so finding a body searches the catalog by
+* recursion, splitting it in halves (see find()).
+*/
+class Catalog
+{
+  public:
+    /**
+    * @brief A list of indices, for expanding the entries of a catalog as a
+    * parameter pack (see CatalogOrbits).
+    *
+    * @tparam I The indices.
+    */
+    template<size_t... I>
+    struct index_list
+    {
+    };
+
+    /**
+    * @brief The list of the indices 0 through N-1 (as the member type
+    * 'type'). It is built by halves, so the template recursion is only
+    * logarithmic in N.
+    *
+    * @tparam N The number of indices.
+    */
+    template<size_t N>
+    struct make_index_list;
+
+    /**
+    * @brief Find the index of a body in a catalog. The catalog is searched
+    * by halves, so the recursion is only logarithmic in the size of the
+    * catalog, and catalogs of any practical size are searched well within
+    * the compiler's constexpr depth limit.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param id The id of the body.
+    *
+    * @return The index of its first entry, or N if the body is not in the
+    * catalog.
+    */
+    template<size_t N>
+    static constexpr size_t find(
+        CatalogBody const (&bodies)[N],
+        Body::id_type const id) noexcept
+    {
+      return findIn(bodies, id, 0, N);
+    }
+
+    /**
+    * @brief Get the mass of the body a body orbits.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The mass of the parent (NaN if it is not in the catalog).
+    */
+    template<size_t N>
+    static constexpr kilo_type parentMass(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return massOf(bodies, find(bodies, bodies[index].parent()));
+    }
+
+    /**
+    * @brief Get the standard gravitational parameter of the body a body
+    * orbits.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The gravitational parameter (mu = GM).
+    */
+    template<size_t N>
+    static constexpr double mu(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return OrbitFormula::mu(parentMass(bodies, index));
+    }
+
+    /**
+    * @brief Get the period of the orbit of a body.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The period (NaN for open orbits).
+    */
+    template<size_t N>
+    static constexpr second_type period(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return OrbitFormula::period<ConstexprSqrt>( \
+          bodies[index].semimajorAxis(), mu(bodies, index));
+    }
+
+    /**
+    * @brief Get the mean motion of the orbit of a body.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The mean motion (radians per second).
+    */
+    template<size_t N>
+    static constexpr double meanMotion(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return OrbitFormula::meanMotion<ConstexprSqrt>( \
+          bodies[index].semimajorAxis(), bodies[index].eccentricity(), \
+          mu(bodies, index));
+    }
+
+    /**
+    * @brief Get the semi-latus rectum of the orbit of a body.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The semi-latus rectum.
+    */
+    template<size_t N>
+    static constexpr meter_type semilatusRectum(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return OrbitFormula::semilatusRectum(bodies[index].semimajorAxis(), \
+          bodies[index].eccentricity());
+    }
+
+    /**
+    * @brief Get the specific angular momentum of the orbit of a body.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The specific angular momentum.
+    */
+    template<size_t N>
+    static constexpr double angularMomentum(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return OrbitFormula::angularMomentum<ConstexprSqrt>( \
+          bodies[index].semimajorAxis(), bodies[index].eccentricity(), \
+          mu(bodies, index));
+    }
+
+    /**
+    * @brief Get the closest distance of a body to its parent.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The periapsis.
+    */
+    template<size_t N>
+    static constexpr meter_type periapsis(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return OrbitFormula::periapsis(bodies[index].semimajorAxis(), \
+          bodies[index].eccentricity());
+    }
+
+    /**
+    * @brief Get the farthest distance of a body from its parent.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The apoapsis (infinite for open orbits).
+    */
+    template<size_t N>
+    static constexpr meter_type apoapsis(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return OrbitFormula::apoapsis(bodies[index].semimajorAxis(), \
+          bodies[index].eccentricity());
+    }
+
+    /**
+    * @brief Get all of the quantities derived from the orbit of a body, to
+    * create its KeplerOrbit without computing them again. The perifocal
+    * frame is found with ConstexprTrig.
+    *
+    * @tparam N The size of the catalog.
+    * @param bodies The catalog.
+    * @param index The index of the body.
+    *
+    * @return The derived quantities.
+    */
+    template<size_t N>
+    static constexpr KeplerOrbit::derived_struct derived(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return derivedFrom(bodies[index], mu(bodies, index), \
+          ConstexprTrig::cos(bodies[index].longitudeOfAscendingNode()), \
+          ConstexprTrig::sin(bodies[index].longitudeOfAscendingNode()), \
+          ConstexprTrig::cos(bodies[index].argumentOfPeriapsis()), \
+          ConstexprTrig::sin(bodies[index].argumentOfPeriapsis()), \
+          ConstexprTrig::cos(bodies[index].inclination()), \
+          ConstexprTrig::sin(bodies[index].inclination()));
+    }
+
+  private:
+    template<typename A, typename B>
+    struct join_index_lists;
+
+    // the second list follows the first
+    template<size_t... A, size_t... B>
+    struct join_index_lists<index_list<A...>, index_list<B...>>
+    {
+      typedef index_list<A..., (sizeof...(A) + B)...> type;
+    };
+
+    // the index of the body within [begin, end), or N
+    template<size_t N>
+    static constexpr size_t findIn(
+        CatalogBody const (&bodies)[N],
+        Body::id_type const id,
+        size_t const begin,
+        size_t const end) noexcept
+    {
+      return end - begin == 0 ? N : \
+          end - begin == 1 ? (bodies[begin].id() == id ? begin : N) : \
+          findAfter(bodies, id, findIn(bodies, id, begin, (begin + end) / 2), \
+              (begin + end) / 2, end);
+    }
+
+    // the index found in the first half, or else the one in the second
+    template<size_t N>
+    static constexpr size_t findAfter(
+        CatalogBody const (&bodies)[N],
+        Body::id_type const id,
+        size_t const found,
+        size_t const begin,
+        size_t const end) noexcept
+    {
+      return found != N ? found : findIn(bodies, id, begin, end);
+    }
+
+    static constexpr KeplerOrbit::derived_struct derivedFrom(
+        CatalogBody const & body,
+        double const mu,
+        double const cos_W,
+        double const sin_W,
+        double const cos_w,
+        double const sin_w,
+        double const cos_i,
+        double const sin_i) noexcept
+    {
+      return KeplerOrbit::derived_struct{
+        mu,
+        OrbitFormula::period<ConstexprSqrt>(body.semimajorAxis(), mu),
+        OrbitFormula::meanMotion<ConstexprSqrt>(body.semimajorAxis(), \
+            body.eccentricity(), mu),
+        OrbitFormula::semilatusRectum(body.semimajorAxis(), \
+            body.eccentricity()),
+        OrbitFormula::angularMomentum<ConstexprSqrt>(body.semimajorAxis(), \
+            body.eccentricity(), mu),
+        OrbitFormula::semiminorAxis<ConstexprSqrt>(body.semimajorAxis(), \
+            body.eccentricity()),
+        OrbitFormula::halfAngleRatio<ConstexprSqrt>(body.eccentricity()),
+        {
+          OrbitFormula::frameX(cos_W, sin_W, cos_w, sin_w, cos_i),
+          OrbitFormula::frameY(cos_W, sin_W, cos_w, sin_w, cos_i),
+          OrbitFormula::frameZ(sin_w, sin_i)
+        },
+        {
+          OrbitFormula::frameX(cos_W, sin_W, -sin_w, cos_w, cos_i),
+          OrbitFormula::frameY(cos_W, sin_W, -sin_w, cos_w, cos_i),
+          OrbitFormula::frameZ(cos_w, sin_i)
+        }
+      };
+    }
+
+    template<size_t N>
+    static constexpr kilo_type massOf(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return index < N ? bodies[index].mass() : \
+          std::numeric_limits<double>::quiet_NaN();
+    }
+};
+
+
+template<size_t N>
+struct Catalog::make_index_list
+{
+  typedef typename join_index_lists< \
+      typename make_index_list<N / 2>::type, \
+      typename make_index_list<N - N / 2>::type>::type type;
+};
+
+template<>
+struct Catalog::make_index_list<0>
+{
+  typedef index_list<> type;
+};
+
+template<>
+struct Catalog::make_index_list<1>
+{
+  typedef index_list<0> type;
+};
+
+}
+
+#endif
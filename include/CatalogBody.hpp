@@ -0,0 +1,205 @@
+/**
+* @file CatalogBody.hpp
+* @brief The CatalogBody class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_CATALOGBODY_HPP
+#define GRAVITREE_CATALOGBODY_HPP
+
+#include "Body.hpp"
+#include "Types.hpp"
+
+namespace gravitree
+{
+
+/**
+* @brief An entry of a body catalog: a body, the body it orbits, and the
+* elements of its orbit. It is a literal type, so that catalogs of known
+* bodies can be declared constexpr and baked into the binary, and their
+* derived quantities found at compile time with the Catalog class.
+*/
+class CatalogBody
+{
+  public:
+    /**
+    * @brief Create a catalog entry for the root of a system, which orbits
+    * nothing.
+    *
+    * @param id The id of the body.
+    * @param mass The mass of the body.
+    */
+    constexpr CatalogBody(
+        Body::id_type const id,
+        kilo_type const mass) noexcept :
+      m_id(id),
+      m_parent(id),
+      m_mass(mass),
+      m_semimajorAxis(0.0),
+      m_eccentricity(0.0),
+      m_inclination(0.0),
+      m_longitudeOfAscendingNode(0.0),
+      m_argumentOfPeriapsis(0.0),
+      m_trueAnomally(0.0)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Create a catalog entry for an orbiting body.
+    *
+    * @param id The id of the body.
+    * @param parent The id of the body it orbits.
+    * @param mass The mass of the body.
+    * @param semimajorAxis The semi-major axis (a).
+    * @param eccentricity The eccentricity (e).
+    * @param inclination The inclination (i).
+    * @param longitudeOfAscendingNode The position of the ascending node
+    * (omega).
+    * @param argumentOfPeriapsis The argument of periapsis (w).
+    * @param trueAnomally The true anomally at the epoch of the catalog.
+    */
+    constexpr CatalogBody(
+        Body::id_type const id,
+        Body::id_type const parent,
+        kilo_type const mass,
+        meter_type const semimajorAxis,
+        double const eccentricity,
+        radian_type const inclination,
+        radian_type const longitudeOfAscendingNode,
+        radian_type const argumentOfPeriapsis,
+        radian_type const trueAnomally) noexcept :
+      m_id(id),
+      m_parent(parent),
+      m_mass(mass),
+      m_semimajorAxis(semimajorAxis),
+      m_eccentricity(eccentricity),
+      m_inclination(inclination),
+      m_longitudeOfAscendingNode(longitudeOfAscendingNode),
+      m_argumentOfPeriapsis(argumentOfPeriapsis),
+      m_trueAnomally(trueAnomally)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the id of the body.
+    *
+    * @return The id.
+    */
+    constexpr Body::id_type id() const noexcept
+    {
+      return m_id;
+    }
+
+    /**
+    * @brief Get the id of the body this body orbits (its own id for a
+    * root).
+    *
+    * @return The id of the parent.
+    */
+    constexpr Body::id_type parent() const noexcept
+    {
+      return m_parent;
+    }
+
+    /**
+    * @brief Check if this body is the root of its system.
+    *
+    * @return True if it orbits nothing.
+    */
+    constexpr bool isRoot() const noexcept
+    {
+      return m_parent == m_id;
+    }
+
+    /**
+    * @brief Get the mass of the body.
+    *
+    * @return The mass.
+    */
+    constexpr kilo_type mass() const noexcept
+    {
+      return m_mass;
+    }
+
+    /**
+    * @brief Get the semi-major axis.
+    *
+    * @return The semi-major axis.
+    */
+    constexpr meter_type semimajorAxis() const noexcept
+    {
+      return m_semimajorAxis;
+    }
+
+    /**
+    * @brief Get the eccentricity.
+    *
+    * @return The eccentricity.
+    */
+    constexpr double eccentricity() const noexcept
+    {
+      return m_eccentricity;
+    }
+
+    /**
+    * @brief Get the inclination.
+    *
+    * @return The inclination.
+    */
+    constexpr radian_type inclination() const noexcept
+    {
+      return m_inclination;
+    }
+
+    /**
+    * @brief Get the longitude of the ascending node.
+    *
+    * @return The longitude.
+    */
+    constexpr radian_type longitudeOfAscendingNode() const noexcept
+    {
+      return m_longitudeOfAscendingNode;
+    }
+
+    /**
+    * @brief Get the argument of periapsis.
+    *
+    * @return The argument of periapsis.
+    */
+    constexpr radian_type argumentOfPeriapsis() const noexcept
+    {
+      return m_argumentOfPeriapsis;
+    }
+
+    /**
+    * @brief Get the true anomally at the epoch of the catalog.
+    *
+    * @return The true anomally.
+    */
+    constexpr radian_type trueAnomally() const noexcept
+    {
+      return m_trueAnomally;
+    }
+
+  private:
+    Body::id_type m_id;
+    Body::id_type m_parent;
+    kilo_type m_mass;
+    meter_type m_semimajorAxis;
+    double m_eccentricity;
+    radian_type m_inclination;
+    radian_type m_longitudeOfAscendingNode;
+    radian_type m_argumentOfPeriapsis;
+    radian_type m_trueAnomally;
+};
+
+}
+
+#endif
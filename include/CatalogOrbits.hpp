@@ -0,0 +1,108 @@
+/**
+* @file CatalogOrbits.hpp
+* @brief The CatalogOrbits class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_CATALOGORBITS_HPP
+#define GRAVITREE_CATALOGORBITS_HPP
+
+#include "Catalog.hpp"
+#include "CatalogBody.hpp"
+#include "KeplerOrbit.hpp"
+
+#include <cstddef>
+
+namespace gravitree
+{
+
+/**
+* @brief The quantities derived from the orbit of each body of a catalog
+* (see Catalog::derived()), in the order of the catalog. It is a literal
+* type, so that for a constexpr catalog they are found at compile time and
+* baked into the binary alongside it, and SolarSystem::addBodies() then
+* creates each orbit without any square roots or trigonometry:
+*
+* @code
+* constexpr CatalogBody const BODIES[] = { ... };
+* constexpr CatalogOrbits<NUM_BODIES> const ORBITS(BODIES);
+*
+* system.addBodies(BODIES, ORBITS.data(), NUM_BODIES);
+* @endcode
+*
+* The orbits of entries whose parent is not in the catalog can not be
+* found, and are left NaN, and an entry for the root is left zero.
+*
+* @tparam N The size of the catalog.
+*/
+template<size_t N>
+class CatalogOrbits
+{
+  public:
+    /**
+    * @brief Find the orbits of a catalog.
+    *
+    * @param bodies The catalog.
+    */
+    constexpr explicit CatalogOrbits(
+        CatalogBody const (&bodies)[N]) noexcept :
+      CatalogOrbits(bodies, typename Catalog::make_index_list<N>::type())
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the derived quantities of each orbit.
+    *
+    * @return The N derived quantities.
+    */
+    constexpr KeplerOrbit::derived_struct const * data() const noexcept
+    {
+      return m_orbits;
+    }
+
+    /**
+    * @brief Get the derived quantities of the orbit of a body.
+    *
+    * @param index The index of the body in the catalog.
+    *
+    * @return The derived quantities.
+    */
+    constexpr KeplerOrbit::derived_struct const & operator[](
+        size_t const index) const noexcept
+    {
+      return m_orbits[index];
+    }
+
+  private:
+    KeplerOrbit::derived_struct m_orbits[N];
+
+    template<size_t... I>
+    constexpr CatalogOrbits(
+        CatalogBody const (&bodies)[N],
+        Catalog::index_list<I...>) noexcept :
+      m_orbits{orbitOf(bodies, I)...}
+    {
+      // do nothing
+    }
+
+    // the root orbits nothing, so has nothing derived
+    static constexpr KeplerOrbit::derived_struct orbitOf(
+        CatalogBody const (&bodies)[N],
+        size_t const index) noexcept
+    {
+      return bodies[index].isRoot() ? \
+          KeplerOrbit::derived_struct{0, 0, 0, 0, 0, 0, 0, {0, 0, 0}, \
+              {0, 0, 0}} : \
+          Catalog::derived(bodies, index);
+    }
+};
+
+}
+
+#endif
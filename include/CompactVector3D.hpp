@@ -0,0 +1,346 @@
+/**
+* @file CompactVector3D.hpp
+* @brief The CompactVector3D class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_COMPACTVECTOR3D_HPP
+#define GRAVITREE_COMPACTVECTOR3D_HPP
+
+#include "Vector3D.hpp"
+
+#include <cmath>
+
+namespace gravitree
+{
+
+/**
+* @brief A double precision three dimensional vector which, unlike Vector3D,
+* does not cache its length. It occupies 24 bytes rather than 32, and
+* creating one costs no multiplies, which suits buffers of many vectors whose
+* lengths are rarely needed.
+*/
+class CompactVector3D
+{
+  public:
+    /**
+    * @brief A new three dimensional vector.
+    *
+    * @param x The x dimension.
+    * @param y The y dimension.
+    * @param z The z dimension.
+    */
+    CompactVector3D(
+        double const x=0.0,
+        double const y=0.0,
+        double const z=0.0) noexcept :
+      m_x(x),
+      m_y(y),
+      m_z(z)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Create a new vector from a Vector3D.
+    *
+    * @param vec The vector.
+    */
+    explicit CompactVector3D(
+        Vector3D const & vec) noexcept :
+      m_x(vec.x()),
+      m_y(vec.y()),
+      m_z(vec.z())
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_x;
+    }
+
+    /**
+    * @brief Get the y component.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_y;
+    }
+
+    /**
+    * @brief Get the z component.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_z;
+    }
+
+    /**
+    * @brief Get this vector as a Vector3D.
+    *
+    * @return The vector.
+    */
+    inline Vector3D toVector3D() const noexcept
+    {
+      return Vector3D(m_x, m_y, m_z);
+    }
+
+    /**
+    * @brief Get the square of the distance between this and another vector.
+    *
+    * @param other The other vector.
+    *
+    * @return The square of the distance.
+    */
+    inline double distance2(
+        CompactVector3D const & other) const noexcept
+    {
+      return (*this - other).magnitude2();
+    }
+
+    /**
+    * @brief Get the distance between this and another vector.
+    *
+    * @param other The other vector.
+    *
+    * @return The distance.
+    */
+    inline double distance(
+        CompactVector3D const & other) const noexcept
+    {
+      return (*this - other).magnitude();
+    }
+
+    /**
+    * @brief Perform the dot product between this vector and another.
+    *
+    * @param other The other vector.
+    *
+    * @return The result.
+    */
+    inline double operator*(
+        CompactVector3D const & other) const noexcept
+    {
+      return m_x*other.m_x + m_y*other.m_y + m_z*other.m_z;
+    }
+
+    /**
+    * @brief Perform the cross product between two vector.
+    *
+    * @param other The other vector.
+    *
+    * @return The cross product.
+    */
+    inline CompactVector3D cross(
+        CompactVector3D const & other) const noexcept
+    {
+      return CompactVector3D(
+          m_y*other.m_z - m_z*other.m_y,
+          m_z*other.m_x - m_x*other.m_z,
+          m_x*other.m_y - m_y*other.m_x);
+    }
+
+    /**
+    * @brief Scale this vector (v) and get the result: a*v.
+    *
+    * @param scalar The scalar (a).
+    *
+    * @return The result (av).
+    */
+    inline CompactVector3D operator*(
+        double const scalar) const noexcept
+    {
+      return CompactVector3D(m_x*scalar, m_y*scalar, m_z*scalar);
+    }
+
+    /**
+    * @brief Scale this vector (v) and get the result: v/a.
+    *
+    * @param scalar The scalar (a).
+    *
+    * @return The result (v/a).
+    */
+    inline CompactVector3D operator/(
+        double const scalar) const noexcept
+    {
+      return CompactVector3D(m_x/scalar, m_y/scalar, m_z/scalar);
+    }
+
+    /**
+    * @brief Add two vector together and return the result.
+    *
+    * @param other The other vector to add.
+    *
+    * @return The addition of the two vectors.
+    */
+    inline CompactVector3D operator+(
+        CompactVector3D const & other) const noexcept
+    {
+      return CompactVector3D(m_x+other.m_x, m_y+other.m_y, m_z+other.m_z);
+    }
+
+    /**
+    * @brief Subtract a vector from this one.
+    *
+    * @param other The other vector to subtract.
+    *
+    * @return The difference of the two vectors.
+    */
+    inline CompactVector3D operator-(
+        CompactVector3D const & other) const noexcept
+    {
+      return CompactVector3D(m_x-other.m_x, m_y-other.m_y, m_z-other.m_z);
+    }
+
+    /**
+    * @brief Get the negation of this vector.
+    *
+    * @return The negated vector.
+    */
+    inline CompactVector3D operator-() const noexcept
+    {
+      return CompactVector3D(-m_x, -m_y, -m_z);
+    }
+
+    /**
+    * @brief Get the square of the magnitude of this vector.
+    *
+    * @return The square of the magnitude.
+    */
+    inline double magnitude2() const noexcept
+    {
+      return m_x*m_x + m_y*m_y + m_z*m_z;
+    }
+
+    /**
+    * @brief Return the magnitude of this vector.
+    *
+    * @return The magnitude.
+    */
+    inline double magnitude() const noexcept
+    {
+      return std::sqrt(magnitude2());
+    }
+
+    /**
+    * @brief Scale this vector.
+    *
+    * @param scalar The value to scale by.
+    *
+    * @return This vector.
+    */
+    inline CompactVector3D & operator*=(
+        double const scalar) noexcept
+    {
+      m_x *= scalar;
+      m_y *= scalar;
+      m_z *= scalar;
+
+      return *this;
+    }
+
+    /**
+    * @brief Add a vector to this one.
+    *
+    * @param other The vector to add.
+    *
+    * @return This vector.
+    */
+    inline CompactVector3D & operator+=(
+        CompactVector3D const & other) noexcept
+    {
+      m_x += other.m_x;
+      m_y += other.m_y;
+      m_z += other.m_z;
+
+      return *this;
+    }
+
+    /**
+    * @brief Subtract a vector from this one.
+    *
+    * @param other The vector to subtract.
+    *
+    * @return This vector.
+    */
+    inline CompactVector3D & operator-=(
+        CompactVector3D const & other) noexcept
+    {
+      m_x -= other.m_x;
+      m_y -= other.m_y;
+      m_z -= other.m_z;
+
+      return *this;
+    }
+
+    /**
+    * @brief Check if this vector is equal to another.
+    *
+    * @param other The vector to test for equality.
+    *
+    * @return True if the vectors are equal.
+    */
+    inline bool operator==(
+        CompactVector3D const & other) const noexcept
+    {
+      return m_x == other.m_x && m_y == other.m_y && m_z == other.m_z;
+    }
+
+    /**
+    * @brief Check if this vector is not equal to another.
+    *
+    * @param other The vector to test against.
+    *
+    * @return True if the vectors are not equal.
+    */
+    inline bool operator!=(
+        CompactVector3D const & other) const noexcept
+    {
+      return !this->operator==(other);
+    }
+
+    /**
+    * @brief Get the unit vector in the direction of this one.
+    *
+    * @return The unit vector.
+    */
+    inline CompactVector3D normalized() const noexcept
+    {
+      return *this / magnitude();
+    }
+
+    /**
+    * @brief Check if all values in this vector are valid (i.e., neither NaN or
+    * Inf).
+    *
+    * @return True if all the values are valid.
+    */
+    inline bool isValid() const noexcept
+    {
+      return std::isfinite(m_x) && std::isfinite(m_y) && std::isfinite(m_z);
+    }
+
+  private:
+    double m_x;
+    double m_y;
+    double m_z;
+};
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+/**
+* @file Ephemeris.hpp
+* @brief The Ephemeris class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_EPHEMERIS_HPP
+#define GRAVITREE_EPHEMERIS_HPP
+
+#include "OrbitalState.hpp"
+#include "Types.hpp"
+#include "Vector3D.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace gravitree
+{
+
+/**
+* @brief A cache of the position and velocity along a closed orbit, for
+* bodies whose orbits rarely change and are queried often. One period of the
+* orbit is split into equal segments of time, and each component of the
+* position and velocity is fit with a Chebyshev polynomial over each
+* segment. A query is then an index and a few multiply-adds, with no
+* trigonometry and no solving of Kepler's equation.
+*
+* The fit is built at construction, doubling the number of segments until
+* both the position and the velocity are within their tolerances everywhere
+* checked. The queries then only read, and may be made concurrently.
+*/
+class Ephemeris
+{
+  public:
+    /**
+    * @brief Create a new ephemeris, where the largest error allowed in
+    * velocity is that which would move the body by the tolerance in position
+    * over one radian of its orbit (the tolerance times the mean motion).
+    * Throws std::invalid_argument if the orbit is not closed or the tolerance
+    * is not positive.
+    *
+    * @param state The orbital state. The fit covers one period of its orbit
+    * in absolute time, from time 0 as passed to OrbitalState::setTime(), and
+    * queries at other times are folded into it by whole periods, so the time
+    * of the state itself does not matter.
+    * @param tolerance The largest error allowed in position, in meters.
+    */
+    Ephemeris(
+        OrbitalState const & state,
+        meter_type tolerance);
+
+    /**
+    * @brief Create a new ephemeris. Throws std::invalid_argument if the orbit
+    * is not closed or either tolerance is not positive.
+    *
+    * @param state The orbital state (see above).
+    * @param tolerance The largest error allowed in position, in meters.
+    * @param velocityTolerance The largest error allowed in velocity, in
+    * meters per second.
+    */
+    Ephemeris(
+        OrbitalState const & state,
+        meter_type tolerance,
+        double velocityTolerance);
+
+    /**
+    * @brief Get the position relative to the parent body.
+    *
+    * @param time The time, as passed to OrbitalState::setTime().
+    *
+    * @return The position.
+    */
+    Vector3D position(
+        second_type time) const;
+
+    /**
+    * @brief Get the velocity relative to the parent body.
+    *
+    * @param time The time, as passed to OrbitalState::setTime().
+    *
+    * @return The velocity.
+    */
+    Vector3D velocity(
+        second_type time) const;
+
+    /**
+    * @brief Get both the position and velocity relative to the parent body.
+    *
+    * @param time The time, as passed to OrbitalState::setTime().
+    * @param position The position (output).
+    * @param velocity The velocity (output).
+    */
+    void state(
+        second_type time,
+        Vector3D * position,
+        Vector3D * velocity) const;
+
+    /**
+    * @brief Get the number of segments the period is split into.
+    *
+    * @return The number of segments.
+    */
+    size_t numSegments() const;
+
+    /**
+    * @brief Get the orbital state the ephemeris was created from.
+    *
+    * @return The orbital state.
+    */
+    OrbitalState const & orbitalState() const noexcept;
+
+  private:
+    OrbitalState m_state;
+    meter_type m_tolerance;
+    double m_velocityTolerance;
+    second_type m_period;
+
+    second_type m_segmentLength;
+    std::vector<double> m_coefficients;
+
+    /**
+    * @brief Build the fit, with the fewest segments within the tolerance.
+    */
+    void build();
+
+    /**
+    * @brief Fit the given number of segments.
+    *
+    * @param numSegments The number of segments.
+    *
+    * @return True if the errors found in position and velocity are within
+    * the tolerances.
+    */
+    bool fit(
+        size_t numSegments);
+
+    /**
+    * @brief Evaluate the fit of a segment.
+    *
+    * @param segment The segment.
+    * @param x The position within the segment in [-1, 1].
+    * @param position The position (output).
+    * @param velocity The velocity (output, may be null).
+    */
+    void evaluate(
+        size_t segment,
+        double x,
+        Vector3D * position,
+        Vector3D * velocity) const noexcept;
+
+    /**
+    * @brief Find the segment and position within it of a time.
+    *
+    * @param time The time.
+    * @param x The position within the segment in [-1, 1] (output).
+    *
+    * @return The segment.
+    */
+    size_t locate(
+        second_type time,
+        double * x) const noexcept;
+};
+
+}
+
+#endif
@@ -14,6 +14,9 @@
 
 
 #include "Body.hpp"
+#include "Vector3DArray.hpp"
+
+#include <cmath>
 
 
 namespace gravitree
@@ -59,6 +62,40 @@ class Gravity
       return force(1.0, mass, offset);
     }
 
+    /**
+    * @brief Calculate the acceleration of many negligable masses towards a
+    * large mass, as with acceleration(mass, offset) for each offset.
+    *
+    * @param mass The large mass.
+    * @param offsets The offset of each small mass, as given to
+    * acceleration(mass, offset).
+    * @param accelerations The acceleration of each small mass (output). It
+    * is resized to the number of offsets, and may be the offsets.
+    */
+    inline static void acceleration(
+        kilo_type const mass,
+        Vector3DArray const & offsets,
+        Vector3DArray * const accelerations)
+    {
+      size_t const num = offsets.size();
+      accelerations->resize(num);
+
+      double const gm = G*mass;
+      double const * const ox = offsets.x();
+      double const * const oy = offsets.y();
+      double const * const oz = offsets.z();
+      double * const ax = accelerations->x();
+      double * const ay = accelerations->y();
+      double * const az = accelerations->z();
+      for (size_t i = 0; i < num; ++i) {
+        double const distance2 = ox[i]*ox[i] + oy[i]*oy[i] + oz[i]*oz[i];
+        double const scale = -gm / (distance2*std::sqrt(distance2));
+        ax[i] = ox[i]*scale;
+        ay[i] = oy[i]*scale;
+        az[i] = oz[i]*scale;
+      }
+    }
+
     /**
     * @brief Get the force between two bodies.
     *
@@ -13,14 +13,57 @@
 #define GRAVITREE_KEPLERORBIT_HPP
 
 #include "Types.hpp"
+#include "Vector3D.hpp"
+
+#include <cstddef>
 
 
 namespace gravitree
 {
 
+/**
+* @brief The elements of a keplerian orbit. The quantities derived from them
+* which evaluating a position along the orbit requires (the perifocal frame,
+* mean motion, angular momentum, etc.) are computed once at construction,
+* so that evaluation needs only the trigonometry of the anomally.
+*/
 class KeplerOrbit
 {
   public:
+    /**
+    * @brief The policies for propagating an orbit (see Propagator.hpp).
+    */
+    enum class propagator_type
+    {
+      CIRCULAR,
+      ELLIPTIC,
+      HYPERBOLIC
+    };
+
+    /**
+    * @brief The number of propagator policies.
+    */
+    static constexpr size_t const NUM_PROPAGATORS = 3;
+
+    /**
+    * @brief The quantities derived from the elements of an orbit, which the
+    * constructor otherwise computes with square roots and trigonometry. This
+    * is a literal type, so that for orbits known in advance they can be
+    * found at compile time (see Catalog::derived()).
+    */
+    struct derived_struct
+    {
+      double mu;
+      second_type period;
+      double meanMotion;
+      meter_type semilatusRectum;
+      double angularMomentum;
+      meter_type semiminorAxis;
+      double halfAngleRatio;
+      double perifocalP[3];
+      double perifocalQ[3];
+    };
+
     /**
     * @brief Create a new keplerian orbit.
     *
@@ -40,6 +83,30 @@ class KeplerOrbit
         radian_type argumentOfPeriapsis,
         kilo_type parentMass);
 
+    /**
+    * @brief Create a new keplerian orbit from its elements and the
+    * quantities already derived from them (e.g., at compile time by
+    * Catalog::derived()), which are taken as they are rather than computed.
+    *
+    * @param semimajorAxis The semi-major axis (a).
+    * @param eccentricity The eccentricity (e).
+    * @param inclination The inclination (i).
+    * @param longitudeOfAscendingNode The position of the ascending node
+    * (omega).
+    * @param argumentOfPeriapsis The argument of periapsis (w).
+    * @param parentMass The mass of the parent body.
+    * @param derived The quantities derived from the elements and the mass of
+    * the parent.
+    */
+    KeplerOrbit(
+        meter_type semimajorAxis,
+        double eccentricity,
+        radian_type inclination,
+        radian_type longitudeOfAscendingNode,
+        radian_type argumentOfPeriapsis,
+        kilo_type parentMass,
+        derived_struct const & derived);
+
     /**
     * @brief Get the length of the semimajor axis.
     *
@@ -90,6 +157,21 @@ class KeplerOrbit
     */
     second_type period() const;
 
+    /**
+    * @brief Get the mean motion of the orbit, the rate at which the mean
+    * anomally advances.
+    *
+    * \f[
+    *    n = \sqrt{\frac{\mu}{|a|^3}}
+    * \f]
+    *
+    * This is defined for both closed and open orbits, where the period is
+    * only defined for closed orbits.
+    *
+    * @return The mean motion in radians per second.
+    */
+    double meanMotion() const;
+
     /**
     * @brief Get the gravitational parameter.
     *
@@ -164,6 +246,60 @@ class KeplerOrbit
     */
     bool isClosed() const;
 
+    /**
+    * @brief Get the length of the semiminor axis, or for open orbits, the
+    * impact parameter (the distance between the focus and the asymptotes).
+    *
+    * \f[
+    *    b = |a| \sqrt{|1 - e^2|}
+    * \f]
+    *
+    * @return The length in meters (b).
+    */
+    meter_type semiminorAxis() const;
+
+    /**
+    * @brief Get the ratio between the tangents of half of the true anomally
+    * and half of the eccentric (or hyperbolic) anomally.
+    *
+    * \f[
+    *    \tan \frac{\nu}{2} = \sqrt{\frac{1 + e}{|1 - e|}} \tan \frac{E}{2}
+    * \f]
+    *
+    * with \f$\tanh \frac{H}{2}\f$ in place of \f$\tan \frac{E}{2}\f$ for
+    * open orbits.
+    *
+    * @return The ratio.
+    */
+    double halfAngleRatio() const;
+
+    /**
+    * @brief Get the unit vector pointing from the focus towards the periapsis,
+    * in the reference frame.
+    *
+    * @return The unit vector (P).
+    */
+    Vector3D const & perifocalP() const;
+
+    /**
+    * @brief Get the unit vector in the plane of the orbit, perpendicular to
+    * the direction of periapsis and in the direction of motion, in the
+    * reference frame.
+    *
+    * @return The unit vector (Q).
+    */
+    Vector3D const & perifocalQ() const;
+
+    /**
+    * @brief Get the policy this orbit is propagated with: CircularPropagator
+    * for closed orbits with an eccentricity of at most
+    * CircularPropagator::MAX_ECCENTRICITY, EllipticPropagator for the other
+    * closed orbits, and HyperbolicPropagator for open orbits.
+    *
+    * @return The policy.
+    */
+    propagator_type propagator() const;
+
   private:
     meter_type m_semimajorAxis;
     double m_eccentricity;
@@ -175,6 +311,14 @@ class KeplerOrbit
     // derived parameters
     second_type m_period;
     double m_mu;
+    double m_meanMotion;
+    double m_semilatusRectum;
+    double m_angularMomentum;
+    meter_type m_semiminorAxis;
+    double m_halfAngleRatio;
+    Vector3D m_perifocalP;
+    Vector3D m_perifocalQ;
+    propagator_type m_propagator;
 };
 
 }
@@ -0,0 +1,208 @@
+/**
+* @file Matrix3D.hpp
+* @brief The Matrix3D class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_MATRIX3D_HPP
+#define GRAVITREE_MATRIX3D_HPP
+
+#include "Quaternion.hpp"
+#include "Vector3D.hpp"
+
+#include <cassert>
+#include <cstddef>
+
+namespace gravitree
+{
+
+/**
+* @brief A 3x3 matrix, stored by rows, used as a rotation matrix. Rotating
+* many vectors by the same orientation is cheaper with its matrix (nine
+* multiplies per vector) than with its quaternion.
+*/
+class Matrix3D
+{
+  public:
+    /**
+    * @brief Create the identity matrix.
+    */
+    Matrix3D() noexcept :
+      m_values{1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0}
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Create a matrix from its rows.
+    *
+    * @param row0 The first row.
+    * @param row1 The second row.
+    * @param row2 The third row.
+    */
+    Matrix3D(
+        Vector3D const row0,
+        Vector3D const row1,
+        Vector3D const row2) noexcept :
+      m_values{row0.x(), row0.y(), row0.z(), row1.x(), row1.y(), row1.z(), \
+          row2.x(), row2.y(), row2.z()}
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Create the rotation matrix of a unit quaternion.
+    *
+    * @param quat The quaternion.
+    */
+    explicit Matrix3D(
+        Quaternion const & quat) noexcept :
+      m_values{
+          1.0 - 2.0*(quat.y()*quat.y() + quat.z()*quat.z()),
+          2.0*(quat.x()*quat.y() - quat.z()*quat.w()),
+          2.0*(quat.x()*quat.z() + quat.y()*quat.w()),
+          2.0*(quat.x()*quat.y() + quat.z()*quat.w()),
+          1.0 - 2.0*(quat.x()*quat.x() + quat.z()*quat.z()),
+          2.0*(quat.y()*quat.z() - quat.x()*quat.w()),
+          2.0*(quat.x()*quat.z() - quat.y()*quat.w()),
+          2.0*(quat.y()*quat.z() + quat.x()*quat.w()),
+          1.0 - 2.0*(quat.x()*quat.x() + quat.y()*quat.y())}
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get an entry of the matrix.
+    *
+    * @param row The row.
+    * @param column The column.
+    *
+    * @return The entry.
+    */
+    inline double get(
+        size_t const row,
+        size_t const column) const noexcept
+    {
+      assert(row < 3 && column < 3);
+
+      return m_values[row*3 + column];
+    }
+
+    /**
+    * @brief Get a row of the matrix.
+    *
+    * @param row The row.
+    *
+    * @return The row.
+    */
+    inline Vector3D row(
+        size_t const row) const noexcept
+    {
+      assert(row < 3);
+
+      return Vector3D(m_values[row*3], m_values[row*3+1], m_values[row*3+2]);
+    }
+
+    /**
+    * @brief Multiply a vector by this matrix.
+    *
+    * @param vec The vector.
+    *
+    * @return The product.
+    */
+    inline Vector3D operator*(
+        Vector3D const vec) const noexcept
+    {
+      return Vector3D(
+          m_values[0]*vec.x() + m_values[1]*vec.y() + m_values[2]*vec.z(),
+          m_values[3]*vec.x() + m_values[4]*vec.y() + m_values[5]*vec.z(),
+          m_values[6]*vec.x() + m_values[7]*vec.y() + m_values[8]*vec.z());
+    }
+
+    /**
+    * @brief Multiply this matrix (A) by another (B).
+    *
+    * @param other The other matrix (B).
+    *
+    * @return The product (AB).
+    */
+    inline Matrix3D operator*(
+        Matrix3D const & other) const noexcept
+    {
+      Matrix3D const transpose = other.transposed();
+      return Matrix3D(
+          Vector3D(row(0)*transpose.row(0), row(0)*transpose.row(1), \
+              row(0)*transpose.row(2)),
+          Vector3D(row(1)*transpose.row(0), row(1)*transpose.row(1), \
+              row(1)*transpose.row(2)),
+          Vector3D(row(2)*transpose.row(0), row(2)*transpose.row(1), \
+              row(2)*transpose.row(2)));
+    }
+
+    /**
+    * @brief Get the transpose of this matrix, which for a rotation matrix is
+    * the inverse rotation.
+    *
+    * @return The transpose.
+    */
+    inline Matrix3D transposed() const noexcept
+    {
+      return Matrix3D(
+          Vector3D(m_values[0], m_values[3], m_values[6]),
+          Vector3D(m_values[1], m_values[4], m_values[7]),
+          Vector3D(m_values[2], m_values[5], m_values[8]));
+    }
+
+    /**
+    * @brief Get the determinant of this matrix.
+    *
+    * @return The determinant.
+    */
+    inline double determinant() const noexcept
+    {
+      return row(0) * row(1).cross(row(2));
+    }
+
+    /**
+    * @brief Check if this matrix is equal to another.
+    *
+    * @param other The matrix to test for equality.
+    *
+    * @return True if every entry is equal.
+    */
+    inline bool operator==(
+        Matrix3D const & other) const noexcept
+    {
+      for (size_t i = 0; i < 9; ++i) {
+        if (m_values[i] != other.m_values[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+    * @brief Check if this matrix is not equal to another.
+    *
+    * @param other The matrix to test against.
+    *
+    * @return True if any entry differs.
+    */
+    inline bool operator!=(
+        Matrix3D const & other) const noexcept
+    {
+      return !this->operator==(other);
+    }
+
+  private:
+    double m_values[9];
+};
+
+}
+
+#endif
@@ -0,0 +1,437 @@
+/**
+* @file OrbitFormula.hpp
+* @brief The OrbitFormula class, the square root policies, and the
+* ConstexprTrig class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_ORBITFORMULA_HPP
+#define GRAVITREE_ORBITFORMULA_HPP
+
+#include "Constants.hpp"
+#include "Gravity.hpp"
+#include "Types.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace gravitree
+{
+
+/**
+* @brief The policy for taking square roots at runtime, with std::sqrt().
+*
+* Each policy provides the square root for the formulas of OrbitFormula,
+* which are used as a template parameter so that the same formulas serve
+* both KeplerOrbit at runtime and Catalog at compile time.
+*/
+class RuntimeSqrt
+{
+  public:
+    /**
+    * @brief Get the square root of a number.
+    *
+    * @param x The number.
+    *
+    * @return The square root (NaN for negative numbers).
+    */
+    static inline double sqrt(
+        double const x) noexcept
+    {
+      return std::sqrt(x);
+    }
+};
+
+
+/**
+* @brief The policy for taking square roots at compile time. The functions
+* are limited to C++11 constexpr, so this uses Newton's method by recursion
+* rather than std::sqrt(), and is much slower than RuntimeSqrt when not
+* evaluated by the compiler.
+*/
+class ConstexprSqrt
+{
+  public:
+    /**
+    * @brief Get the square root of a number.
+    *
+    * @param x The number.
+    *
+    * @return The square root (NaN for negative numbers).
+    */
+    static constexpr double sqrt(
+        double const x) noexcept
+    {
+      return !(x >= 0.0) ? std::numeric_limits<double>::quiet_NaN() : \
+          (x == 0.0 || x == std::numeric_limits<double>::infinity()) ? x : \
+          x > SCALE2 ? SCALE * sqrt(x / SCALE2) : \
+          x < 1.0 / SCALE2 ? sqrt(x * SCALE2) / SCALE : \
+          newton(x, x > 1.0 ? x : 1.0, ITERATIONS);
+    }
+
+  private:
+    // the argument is scaled by powers of two into [2^-32, 2^32], where
+    // Newton's method from above converges within ITERATIONS steps
+    static constexpr double const SCALE = 65536.0;
+    static constexpr double const SCALE2 = 4294967296.0;
+    static constexpr int const ITERATIONS = 64;
+
+    // the iterates decrease towards the root, so stop once they do not
+    static constexpr double newton(
+        double const x,
+        double const guess,
+        int const steps) noexcept
+    {
+      return steps == 0 || 0.5*(guess + x/guess) >= guess ? guess : \
+          newton(x, 0.5*(guess + x/guess), steps - 1);
+    }
+};
+
+
+/**
+* @brief The sine and cosine at compile time, for finding the perifocal frame
+* of an orbit in a constexpr catalog (see Catalog::derived()). As with
+* ConstexprSqrt, these are limited to C++11 constexpr and are much slower
+* than std::sin() and std::cos() when not evaluated by the compiler. The
+* angle is reduced to within pi/2 of zero and a Taylor series summed until
+* its terms no longer change the sum, which agrees with std::sin() and
+* std::cos() to within a few units in the last place for angles of a few
+* turns.
+*/
+class ConstexprTrig
+{
+  public:
+    /**
+    * @brief Get the sine of an angle.
+    *
+    * @param x The angle in radians.
+    *
+    * @return The sine.
+    */
+    static constexpr double sin(
+        radian_type const x) noexcept
+    {
+      return sinReduced(reduce(x));
+    }
+
+    /**
+    * @brief Get the cosine of an angle.
+    *
+    * @param x The angle in radians.
+    *
+    * @return The cosine.
+    */
+    static constexpr double cos(
+        radian_type const x) noexcept
+    {
+      return cosReduced(reduce(x));
+    }
+
+  private:
+    // 2*pi split in two, so that whole turns are removed without rounding
+    static constexpr double const TWO_PI_HIGH = 6.283185307179586;
+    static constexpr double const TWO_PI_LOW = 2.4492935982947064e-16;
+    static constexpr double const HALF_PI = 1.5707963267948966;
+    static constexpr int const MAX_TERMS = 32;
+
+    // the angle less the nearest whole number of turns, within [-pi, pi]
+    static constexpr double reduce(
+        radian_type const x) noexcept
+    {
+      return removeTurns(x, static_cast<double>(static_cast<long long>( \
+          x / TWO_PI_HIGH + (x < 0.0 ? -0.5 : 0.5))));
+    }
+
+    static constexpr double removeTurns(
+        radian_type const x,
+        double const turns) noexcept
+    {
+      return (x - turns*TWO_PI_HIGH) - turns*TWO_PI_LOW;
+    }
+
+    // sin(x) = sin(pi - x) and cos(x) = -cos(pi - x) bring x within pi/2
+    static constexpr double sinReduced(
+        radian_type const x) noexcept
+    {
+      return x > HALF_PI ? series(Constants::PI - x, 1) : \
+          x < -HALF_PI ? series(-Constants::PI - x, 1) : series(x, 1);
+    }
+
+    static constexpr double cosReduced(
+        radian_type const x) noexcept
+    {
+      return x > HALF_PI ? -series(Constants::PI - x, 0) : \
+          x < -HALF_PI ? -series(Constants::PI + x, 0) : series(x, 0);
+    }
+
+    // the taylor series of the sine (first = 1) or cosine (first = 0)
+    static constexpr double series(
+        double const x,
+        int const first) noexcept
+    {
+      return sum(x*x, first == 1 ? x : 1.0, 0.0, first, MAX_TERMS);
+    }
+
+    static constexpr double sum(
+        double const x2,
+        double const term,
+        double const total,
+        int const power,
+        int const steps) noexcept
+    {
+      return steps == 0 || total + term == total ? total + term : \
+          sum(x2, -term * x2 / ((power + 1) * (power + 2)), total + term, \
+              power + 2, steps - 1);
+    }
+};
+
+
+/**
+* @brief The quantities derived from the elements of a keplerian orbit, as
+* constexpr functions of the elements. KeplerOrbit computes its derived
+* quantities with these and RuntimeSqrt, and Catalog with these and
+* ConstexprSqrt, so that the two agree to within the rounding of the square
+* root (and of the trigonometry of the perifocal frame).
+*/
+class OrbitFormula
+{
+  public:
+    /**
+    * @brief Get the gravitational parameter of a body.
+    *
+    * @param mass The mass of the body.
+    *
+    * @return The parameter (mu = GM).
+    */
+    static constexpr double mu(
+        kilo_type const mass) noexcept
+    {
+      return mass * Gravity::G;
+    }
+
+    /**
+    * @brief Get the period of an orbit.
+    *
+    * @tparam S The square root policy (e.g., RuntimeSqrt).
+    * @param semimajorAxis The semi-major axis.
+    * @param mu The gravitational parameter of the parent.
+    *
+    * @return The period (NaN for open orbits).
+    */
+    template<typename S>
+    static constexpr second_type period(
+        meter_type const semimajorAxis,
+        double const mu) noexcept
+    {
+      return 2.0 * Constants::PI * S::sqrt(cube(semimajorAxis) / mu);
+    }
+
+    /**
+    * @brief Get the mean motion of an orbit.
+    *
+    * @tparam S The square root policy (e.g., RuntimeSqrt).
+    * @param semimajorAxis The semi-major axis.
+    * @param eccentricity The eccentricity.
+    * @param mu The gravitational parameter of the parent.
+    *
+    * @return The mean motion (radians per second).
+    */
+    template<typename S>
+    static constexpr double meanMotion(
+        meter_type const semimajorAxis,
+        double const eccentricity,
+        double const mu) noexcept
+    {
+      return eccentricity < 1.0 ? \
+          2.0 * Constants::PI / period<S>(semimajorAxis, mu) : \
+          S::sqrt(mu / cube(abs(semimajorAxis)));
+    }
+
+    /**
+    * @brief Get the semi-latus rectum of an orbit.
+    *
+    * @param semimajorAxis The semi-major axis.
+    * @param eccentricity The eccentricity.
+    *
+    * @return The semi-latus rectum.
+    */
+    static constexpr meter_type semilatusRectum(
+        meter_type const semimajorAxis,
+        double const eccentricity) noexcept
+    {
+      return semimajorAxis * (1.0 - eccentricity*eccentricity);
+    }
+
+    /**
+    * @brief Get the specific angular momentum of an orbit.
+    *
+    * @tparam S The square root policy (e.g., RuntimeSqrt).
+    * @param semimajorAxis The semi-major axis.
+    * @param eccentricity The eccentricity.
+    * @param mu The gravitational parameter of the parent.
+    *
+    * @return The specific angular momentum.
+    */
+    template<typename S>
+    static constexpr double angularMomentum(
+        meter_type const semimajorAxis,
+        double const eccentricity,
+        double const mu) noexcept
+    {
+      return S::sqrt(mu * semilatusRectum(semimajorAxis, eccentricity));
+    }
+
+    /**
+    * @brief Get the semi-minor axis of an orbit, or the impact parameter of
+    * an open orbit.
+    *
+    * @tparam S The square root policy (e.g., RuntimeSqrt).
+    * @param semimajorAxis The semi-major axis.
+    * @param eccentricity The eccentricity.
+    *
+    * @return The semi-minor axis.
+    */
+    template<typename S>
+    static constexpr meter_type semiminorAxis(
+        meter_type const semimajorAxis,
+        double const eccentricity) noexcept
+    {
+      return abs(semimajorAxis) * \
+          S::sqrt(abs(1.0 - eccentricity*eccentricity));
+    }
+
+    /**
+    * @brief Get the ratio between the tangents of half of the true anomally
+    * and half of the eccentric (or hyperbolic) anomally of an orbit.
+    *
+    * @tparam S The square root policy (e.g., RuntimeSqrt).
+    * @param eccentricity The eccentricity.
+    *
+    * @return The ratio.
+    */
+    template<typename S>
+    static constexpr double halfAngleRatio(
+        double const eccentricity) noexcept
+    {
+      return S::sqrt((1.0 + eccentricity) / abs(1.0 - eccentricity));
+    }
+
+    /**
+    * @brief Get the closest distance along an orbit to its focus.
+    *
+    * @param semimajorAxis The semi-major axis.
+    * @param eccentricity The eccentricity.
+    *
+    * @return The periapsis.
+    */
+    static constexpr meter_type periapsis(
+        meter_type const semimajorAxis,
+        double const eccentricity) noexcept
+    {
+      return semilatusRectum(semimajorAxis, eccentricity) / \
+          (1.0 + eccentricity);
+    }
+
+    /**
+    * @brief Get the farthest distance along an orbit from its focus.
+    *
+    * @param semimajorAxis The semi-major axis.
+    * @param eccentricity The eccentricity.
+    *
+    * @return The apoapsis (infinite for open orbits).
+    */
+    static constexpr meter_type apoapsis(
+        meter_type const semimajorAxis,
+        double const eccentricity) noexcept
+    {
+      return eccentricity < 1.0 ? \
+          semilatusRectum(semimajorAxis, eccentricity) / \
+              (1.0 - eccentricity) : \
+          std::numeric_limits<double>::infinity();
+    }
+
+    /**
+    * @brief Get the component along the reference direction (x) of a unit
+    * vector in the plane of an orbit, at an angle from the ascending node.
+    * The perifocal direction of periapsis (P) is at the argument of
+    * periapsis w, and the direction of the semi-latus rectum (Q) at
+    * w + pi/2, for which cos(w + pi/2) = -sin(w) and sin(w + pi/2) = cos(w).
+    *
+    * @param cos_W The cosine of the longitude of the ascending node.
+    * @param sin_W The sine of the longitude of the ascending node.
+    * @param cos_w The cosine of the angle from the ascending node.
+    * @param sin_w The sine of the angle from the ascending node.
+    * @param cos_i The cosine of the inclination.
+    *
+    * @return The x component.
+    */
+    static constexpr double frameX(
+        double const cos_W,
+        double const sin_W,
+        double const cos_w,
+        double const sin_w,
+        double const cos_i) noexcept
+    {
+      return cos_W * cos_w - sin_W * sin_w * cos_i;
+    }
+
+    /**
+    * @brief Get the y component of a unit vector in the plane of an orbit
+    * (see frameX()).
+    *
+    * @param cos_W The cosine of the longitude of the ascending node.
+    * @param sin_W The sine of the longitude of the ascending node.
+    * @param cos_w The cosine of the angle from the ascending node.
+    * @param sin_w The sine of the angle from the ascending node.
+    * @param cos_i The cosine of the inclination.
+    *
+    * @return The y component.
+    */
+    static constexpr double frameY(
+        double const cos_W,
+        double const sin_W,
+        double const cos_w,
+        double const sin_w,
+        double const cos_i) noexcept
+    {
+      return sin_W * cos_w + cos_W * sin_w * cos_i;
+    }
+
+    /**
+    * @brief Get the z component of a unit vector in the plane of an orbit
+    * (see frameX()).
+    *
+    * @param sin_w The sine of the angle from the ascending node.
+    * @param sin_i The sine of the inclination.
+    *
+    * @return The z component.
+    */
+    static constexpr double frameZ(
+        double const sin_w,
+        double const sin_i) noexcept
+    {
+      return sin_i * sin_w;
+    }
+
+  private:
+    static constexpr double cube(
+        double const x) noexcept
+    {
+      return x*x*x;
+    }
+
+    static constexpr double abs(
+        double const x) noexcept
+    {
+      return x < 0.0 ? -x : x;
+    }
+};
+
+}
+
+#endif
@@ -15,6 +15,9 @@
 #include "KeplerOrbit.hpp"
 #include "Vector3D.hpp"
 
+#include <cstddef>
+#include <vector>
+
 namespace gravitree
 {
 
@@ -34,6 +37,27 @@ class OrbitalState
         Vector3D position,
         Vector3D velocity,
         kilo_type mass);
+
+    /**
+    * @brief Create orbital states from many sets of vectors at once. Each
+    * state is identical to that of the single version. The elements are
+    * found in blocks without branching on the shape of each orbit, so that
+    * equatorial, circular and inclined orbits mixed together are handled at
+    * the same cost.
+    *
+    * @param positions The position vectors.
+    * @param velocities The velocity vectors.
+    * @param masses The mass of the parent body of each.
+    * @param num The number of sets of vectors.
+    * @param states The list to fill with the orbital states. The list is
+    * cleared first, but its capacity is kept.
+    */
+    static void fromVectors(
+        Vector3D const * positions,
+        Vector3D const * velocities,
+        kilo_type const * masses,
+        size_t num,
+        std::vector<OrbitalState> * states);
         
     /**
     * @brief Create a new orbital state.
@@ -46,13 +70,25 @@ class OrbitalState
         radian_type trueAnomally);
 
     /**
-    * @brief Set the time passed since the epoch.
+    * @brief Set the time passed since the epoch. Open (hyperbolic) orbits
+    * pass periapsis only once, so for them the epoch is the time of
+    * periapsis.
     *
     * @param time The time in seconds.
     */
     void setTime(
         second_type time) noexcept;
 
+    /**
+    * @brief Advance the time by a number of seconds. The new anomally is
+    * found starting from the current one, so small steps (e.g., a single
+    * frame) are cheaper than calling setTime().
+    *
+    * @param seconds The number of seconds (may be negative).
+    */
+    void advance(
+        second_type seconds) noexcept;
+
     /**
     * @brief Get the components of the velocity of this object relative to the
     * body it orbits.
@@ -68,6 +104,31 @@ class OrbitalState
     */
     Vector3D position() const noexcept;
 
+    /**
+    * @brief Get both the position and velocity of this object relative to the
+    * body it orbits. This costs about the same as either alone.
+    *
+    * @param position The position (output).
+    * @param velocity The velocity (output).
+    */
+    void state(
+        Vector3D * position,
+        Vector3D * velocity) const noexcept;
+
+    /**
+    * @brief Get the position and velocity of many objects at once.
+    *
+    * @param states The orbital states.
+    * @param num The number of orbital states.
+    * @param positions The array to fill with the position of each state.
+    * @param velocities The array to fill with the velocity of each state.
+    */
+    static void state(
+        OrbitalState const * states,
+        size_t num,
+        Vector3D * positions,
+        Vector3D * velocities) noexcept;
+
     /**
     * @brief The distance of the this object from the body it orbits.
     *
@@ -90,7 +151,8 @@ class OrbitalState
     radian_type meanAnomally() const noexcept;
 
     /**
-    * @brief The current eccentric anomally.
+    * @brief The current eccentric anomally, or for open orbits, the current
+    * hyperbolic anomally.
     *
     * @return The current eccentric anomally.
     */
@@ -111,11 +173,77 @@ class OrbitalState
     KeplerOrbit orbit() const noexcept;
 
   private:
+    friend class OrbitalStateArray;
+
     KeplerOrbit m_orbit;
     radian_type m_trueAnomally;
     radian_type m_eccentricAnomally;
     radian_type m_meanAnomally;
     second_type m_time;
+
+    /**
+    * @brief Create a new orbital state from an already consistent set of
+    * anomallies.
+    *
+    * @param orbit The current orbit.
+    * @param trueAnomally The current true anomally.
+    * @param eccentricAnomally The current eccentric anomally.
+    * @param meanAnomally The current mean anomally.
+    * @param time The time since the epoch.
+    */
+    OrbitalState(
+        KeplerOrbit orbit,
+        radian_type trueAnomally,
+        radian_type eccentricAnomally,
+        radian_type meanAnomally,
+        second_type time) noexcept;
+
+    /**
+    * @brief Evaluate the position along an orbit from its perifocal frame.
+    * Only the trigonometry of the anomally is computed.
+    *
+    * @param p The unit vector towards periapsis.
+    * @param q The unit vector perpendicular to p in the plane of the orbit.
+    * @param semimajorAxis The semimajor axis (a).
+    * @param semiminorAxis The semiminor axis (b).
+    * @param eccentricity The eccentricity (e).
+    * @param eccentricAnomally The eccentric (or hyperbolic) anomally.
+    *
+    * @return The position relative to the focus.
+    */
+    static Vector3D evaluatePosition(
+        Vector3D const & p,
+        Vector3D const & q,
+        meter_type semimajorAxis,
+        meter_type semiminorAxis,
+        double eccentricity,
+        radian_type eccentricAnomally) noexcept;
+
+    /**
+    * @brief Evaluate the position and velocity along an orbit from its
+    * perifocal frame, sharing the trigonometry of the anomally between them.
+    * The position is identical to that of evaluatePosition().
+    *
+    * @param p The unit vector towards periapsis.
+    * @param q The unit vector perpendicular to p in the plane of the orbit.
+    * @param semimajorAxis The semimajor axis (a).
+    * @param semiminorAxis The semiminor axis (b).
+    * @param eccentricity The eccentricity (e).
+    * @param meanMotion The mean motion (n).
+    * @param eccentricAnomally The eccentric (or hyperbolic) anomally.
+    * @param position The position relative to the focus (output).
+    * @param velocity The velocity relative to the focus (output).
+    */
+    static void evaluateState(
+        Vector3D const & p,
+        Vector3D const & q,
+        meter_type semimajorAxis,
+        meter_type semiminorAxis,
+        double eccentricity,
+        double meanMotion,
+        radian_type eccentricAnomally,
+        Vector3D * position,
+        Vector3D * velocity) noexcept;
 };
 
 }
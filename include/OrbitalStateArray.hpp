@@ -0,0 +1,431 @@
+/**
+* @file OrbitalStateArray.hpp
+* @brief The OrbitalStateArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-14
+*/
+
+
+
+#ifndef GRAVITREE_ORBITALSTATEARRAY_HPP
+#define GRAVITREE_ORBITALSTATEARRAY_HPP
+
+#include "OrbitalState.hpp"
+#include "Vector3D.hpp"
+#include "Vector3F.hpp"
+
+#include <vector>
+#include <cstddef>
+
+namespace gravitree
+{
+
+/**
+* @brief A structure-of-arrays store of orbital states. Each state occupies a
+* slot, which does not change while the state is in the array, and each
+* orbital element is kept in its own dense array. The arrays are ordered by
+* propagation policy rather than by slot: the states of each policy occupy
+* one contiguous range of rows, followed by the rows of free slots, and a
+* state changing policy is moved to its new range by swapping it with the
+* rows at the boundaries between them. Propagating a group thus streams
+* through contiguous memory with the kernel of its policy, while access by
+* slot goes through one lookup of the row. Slots of removed states are
+* reused by later additions, and while free they hold a stationary state.
+*/
+class OrbitalStateArray
+{
+  public:
+    /**
+    * @brief The parent index of a state which has no parent.
+    */
+    static constexpr size_t const NO_PARENT = static_cast<size_t>(-1);
+
+    /**
+    * @brief Create a new empty array.
+    */
+    OrbitalStateArray();
+
+    /**
+    * @brief Get the number of slots (both used and free).
+    *
+    * @return The number of slots.
+    */
+    size_t size() const noexcept;
+
+    /**
+    * @brief Add a state to a free slot.
+    *
+    * @param state The state.
+    * @param parent The slot of the parent state (or NO_PARENT).
+    *
+    * @return The slot of the state.
+    */
+    size_t add(
+        OrbitalState const & state,
+        size_t parent);
+
+    /**
+    * @brief Free the given slot.
+    *
+    * @param slot The slot.
+    */
+    void remove(
+        size_t slot);
+
+    /**
+    * @brief Replace the state in the given slot.
+    *
+    * @param slot The slot.
+    * @param state The new state.
+    */
+    void set(
+        size_t slot,
+        OrbitalState const & state);
+
+    /**
+    * @brief Get the state in the given slot.
+    *
+    * @param slot The slot.
+    *
+    * @return The state.
+    */
+    OrbitalState get(
+        size_t slot) const;
+
+    /**
+    * @brief Get the slot of the parent of a state.
+    *
+    * @param slot The slot.
+    *
+    * @return The parent slot (or NO_PARENT).
+    */
+    size_t parent(
+        size_t slot) const noexcept;
+
+    /**
+    * @brief Set the slot of the parent of a state.
+    *
+    * @param slot The slot.
+    * @param parent The parent slot (or NO_PARENT).
+    */
+    void setParent(
+        size_t slot,
+        size_t parent) noexcept;
+
+    /**
+    * @brief Advance every state in the slots [begin, end) by the given
+    * number of seconds, each with the kernel of its policy. The rows of a
+    * range of slots are not contiguous, so propagateGroup() should be
+    * preferred for propagating every state. Ranges which do not overlap may
+    * be propagated concurrently.
+    *
+    * @param begin The first slot.
+    * @param end One past the last slot.
+    * @param seconds The number of seconds.
+    */
+    void propagate(
+        size_t begin,
+        size_t end,
+        second_type seconds) noexcept;
+
+    /**
+    * @brief Get the number of states propagated with a policy.
+    *
+    * @param propagator The policy.
+    *
+    * @return The number of states.
+    */
+    size_t groupSize(
+        KeplerOrbit::propagator_type propagator) const noexcept;
+
+    /**
+    * @brief Advance the states propagated with a policy by the given number
+    * of seconds. The states are those from begin to end of the contiguous
+    * rows of the policy (in no particular order of slot), and each group is
+    * advanced by a kernel specialized for its policy. Ranges of groups which
+    * do not overlap may be propagated concurrently.
+    *
+    * @param propagator The policy.
+    * @param begin The first state of the group.
+    * @param end One past the last state of the group.
+    * @param seconds The number of seconds.
+    */
+    void propagateGroup(
+        KeplerOrbit::propagator_type propagator,
+        size_t begin,
+        size_t end,
+        second_type seconds) noexcept;
+
+    /**
+    * @brief Get the state in the given slot as it will be after the given
+    * number of seconds, without changing it. This matches the state
+    * propagate() would produce.
+    *
+    * @param slot The slot.
+    * @param seconds The number of seconds.
+    *
+    * @return The future state.
+    */
+    OrbitalState predict(
+        size_t slot,
+        second_type seconds) const;
+
+    /**
+    * @brief Get the position and velocity of the state in the given slot as
+    * they will be after the given number of seconds, without changing it.
+    * Only the anomally is solved for the new time; the orbit is evaluated
+    * from its stored frame, so this is much cheaper than predict() when the
+    * rest of the state is not needed.
+    *
+    * @param slot The slot.
+    * @param seconds The number of seconds.
+    * @param position The future position relative to the parent (output).
+    * @param velocity The future velocity relative to the parent (output).
+    */
+    void predictState(
+        size_t slot,
+        second_type seconds,
+        Vector3D * position,
+        Vector3D * velocity) const noexcept;
+
+    /**
+    * @brief Get the period of a state.
+    *
+    * @param slot The slot.
+    *
+    * @return The period in seconds, or 0 if the state is stationary. For open
+    * orbits, this is the time over which the mean anomally advances by 2 pi.
+    */
+    second_type period(
+        size_t slot) const noexcept;
+
+    /**
+    * @brief Get the position of a state relative to its parent.
+    *
+    * @param slot The slot.
+    *
+    * @return The position.
+    */
+    Vector3D position(
+        size_t slot) const;
+
+    /**
+    * @brief Get the velocity of a state relative to its parent.
+    *
+    * @param slot The slot.
+    *
+    * @return The velocity.
+    */
+    Vector3D velocity(
+        size_t slot) const;
+
+    /**
+    * @brief Get the positions of every state in the slots [begin, end)
+    * relative to their parents in single precision, at a relative error of
+    * about 1e-7 of the distance from the parent. This reads half as much
+    * memory as position(). Each state is evaluated with the formula for the
+    * shape of its policy's orbits (closed or open).
+    *
+    * @param begin The first slot.
+    * @param end One past the last slot.
+    * @param positions The array to fill with the position of each state.
+    */
+    void localPositions(
+        size_t begin,
+        size_t end,
+        Vector3F * positions) const noexcept;
+
+    /**
+    * @brief Get both the position and velocity of a state relative to its
+    * parent. This costs about the same as either alone.
+    *
+    * @param slot The slot.
+    * @param position The position (output).
+    * @param velocity The velocity (output).
+    */
+    void state(
+        size_t slot,
+        Vector3D * position,
+        Vector3D * velocity) const noexcept;
+
+    /**
+    * @brief Get the position and velocity of every state in the slots
+    * [begin, end) relative to their parents.
+    *
+    * @param begin The first slot.
+    * @param end One past the last slot.
+    * @param positions The array to fill with the position of each state.
+    * @param velocities The array to fill with the velocity of each state.
+    */
+    void state(
+        size_t begin,
+        size_t end,
+        Vector3D * positions,
+        Vector3D * velocities) const noexcept;
+
+    /**
+    * @brief Get the closest distance a state comes to its parent.
+    *
+    * @param slot The slot.
+    *
+    * @return The periapsis.
+    */
+    meter_type periapsis(
+        size_t slot) const noexcept;
+
+    /**
+    * @brief Get the farthest distance a state goes from its parent (infinite
+    * for open orbits).
+    *
+    * @param slot The slot.
+    *
+    * @return The apoapsis.
+    */
+    meter_type apoapsis(
+        size_t slot) const noexcept;
+
+    /**
+    * @brief Get the fastest speed of a state relative to its parent, which
+    * it reaches at periapsis:
+    *
+    * \f[
+    *   v_p = \sqrt{\mu \left(\frac{2}{r_p} - \frac{1}{a}\right)}
+    * \f]
+    *
+    * @param slot The slot.
+    *
+    * @return The speed, or 0 if the state is stationary.
+    */
+    double maxSpeed(
+        size_t slot) const noexcept;
+
+    /**
+    * @brief Get the radius of the sphere of influence of a body following the
+    * state, using the Laplace approximation:
+    *
+    * \f[
+    *   r_{SOI} = a \left(\frac{m}{M}\right)^{2/5}
+    * \f]
+    *
+    * For open orbits the periapsis is used in place of the semimajor axis.
+    *
+    * @param slot The slot.
+    * @param mass The mass of the body.
+    *
+    * @return The radius.
+    */
+    meter_type sphereOfInfluence(
+        size_t slot,
+        kilo_type mass) const noexcept;
+
+  private:
+    // the policies, followed by the free slots, in the order of their rows
+    static constexpr size_t const FREE_PARTITION = \
+        KeplerOrbit::NUM_PROPAGATORS;
+    static constexpr size_t const NUM_PARTITIONS = FREE_PARTITION + 1;
+
+    // orbital elements, indexed by row
+    std::vector<meter_type> m_semimajorAxis;
+    std::vector<double> m_eccentricity;
+    std::vector<radian_type> m_inclination;
+    std::vector<radian_type> m_longitudeOfAscendingNode;
+    std::vector<radian_type> m_argumentOfPeriapsis;
+    std::vector<kilo_type> m_parentMass;
+    std::vector<double> m_meanMotion;
+
+    // the perifocal frame and shape of each orbit
+    std::vector<Vector3D> m_perifocalP;
+    std::vector<Vector3D> m_perifocalQ;
+    std::vector<meter_type> m_semiminorAxis;
+    std::vector<double> m_halfAngleRatio;
+    std::vector<KeplerOrbit::propagator_type> m_propagator;
+
+    // single precision copies of the frame scaled by the axes, and of the
+    // eccentricity, for localPositions()
+    std::vector<Vector3F> m_singleP;
+    std::vector<Vector3F> m_singleQ;
+    std::vector<float> m_singleEccentricity;
+
+    // position along the orbit
+    std::vector<second_type> m_time;
+    std::vector<radian_type> m_meanAnomally;
+    std::vector<radian_type> m_eccentricAnomally;
+    std::vector<radian_type> m_trueAnomally;
+
+    // the row of each slot, and the slot of each row
+    std::vector<size_t> m_rows;
+    std::vector<size_t> m_slots;
+
+    // the parent of each slot, and the free slots
+    std::vector<size_t> m_parent;
+    std::vector<size_t> m_free;
+
+    // the first row of each partition, and the number of rows
+    size_t m_bounds[NUM_PARTITIONS + 1];
+
+    /**
+    * @brief Get the partition holding a row.
+    *
+    * @param row The row.
+    *
+    * @return The partition (the policy, or FREE_PARTITION).
+    */
+    size_t partition(
+        size_t row) const noexcept;
+
+    /**
+    * @brief Move the row of a slot into a partition, by swapping it with the
+    * rows at the boundaries of the partitions between.
+    *
+    * @param slot The slot.
+    * @param target The partition.
+    */
+    void relocate(
+        size_t slot,
+        size_t target) noexcept;
+
+    /**
+    * @brief Swap two rows, keeping their slots.
+    *
+    * @param a The first row.
+    * @param b The second row.
+    */
+    void swapRows(
+        size_t a,
+        size_t b) noexcept;
+
+    /**
+    * @brief Solve for the anomallies of a row at a time, with the policy of
+    * the row.
+    *
+    * @param row The row.
+    * @param mean The mean anomally at the time.
+    * @param anomally The eccentric (or hyperbolic) anomally (output).
+    * @param trueAnomally The true anomally (output).
+    */
+    void solveRow(
+        size_t row,
+        radian_type mean,
+        radian_type * anomally,
+        radian_type * trueAnomally) const noexcept;
+
+    /**
+    * @brief Advance the states in the rows [begin, end) with a policy.
+    *
+    * @tparam P The policy (e.g., EllipticPropagator).
+    * @param begin The first row.
+    * @param end One past the last row.
+    * @param seconds The number of seconds.
+    */
+    template<typename P>
+    void propagateRows(
+        size_t begin,
+        size_t end,
+        second_type seconds) noexcept;
+};
+
+}
+
+#endif
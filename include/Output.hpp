@@ -8,7 +8,12 @@
 */
 
 #include "Vector3D.hpp"
+#include "Vector3F.hpp"
+#include "CompactVector3D.hpp"
 #include "Rotation.hpp"
+#include "Quaternion.hpp"
+#include "Matrix3D.hpp"
+#include "BodyHandle.hpp"
 #include <ostream>
 
 namespace gravitree
@@ -26,6 +31,30 @@ std::ostream& operator<<(
     std::ostream& os,
     Vector3D const vec);
 
+/**
+* @brief Output stream operator.
+*
+* @param os The output stream
+* @param vec The vector.
+*
+* @return The stream.
+*/
+std::ostream& operator<<(
+    std::ostream& os,
+    Vector3F const vec);
+
+/**
+* @brief Output stream operator.
+*
+* @param os The output stream
+* @param vec The vector.
+*
+* @return The stream.
+*/
+std::ostream& operator<<(
+    std::ostream& os,
+    CompactVector3D const vec);
+
 /**
 * @brief Output stream operator.
 *
@@ -38,5 +67,40 @@ std::ostream& operator<<(
     std::ostream& os,
     Rotation const rot);
 
-}
+/**
+* @brief Output stream operator.
+*
+* @param os The output stream
+* @param quat The quaternion.
+*
+* @return The stream.
+*/
+std::ostream& operator<<(
+    std::ostream& os,
+    Quaternion const quat);
+
+/**
+* @brief Output stream operator.
+*
+* @param os The output stream
+* @param mat The matrix.
+*
+* @return The stream.
+*/
+std::ostream& operator<<(
+    std::ostream& os,
+    Matrix3D const & mat);
 
+/**
+* @brief Output stream operator.
+*
+* @param os The output stream
+* @param handle The body handle.
+*
+* @return The stream.
+*/
+std::ostream& operator<<(
+    std::ostream& os,
+    BodyHandle const handle);
+
+}
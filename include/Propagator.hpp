@@ -0,0 +1,219 @@
+/**
+* @file Propagator.hpp
+* @brief The propagator policies.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_PROPAGATOR_HPP
+#define GRAVITREE_PROPAGATOR_HPP
+
+#include "Anomally.hpp"
+#include "Constants.hpp"
+#include "Types.hpp"
+
+#include <cmath>
+
+namespace gravitree
+{
+
+/**
+* @brief The policy for propagating elliptic orbits, which solves Kepler's
+* equation for the eccentric anomally.
+*
+* Each policy finds the anomally (eccentric, or hyperbolic for open orbits)
+* and the true anomally from the mean anomally, and is used as a template
+* parameter so that loops over many orbits of the same shape compile to a
+* kernel without branches. The policy of an orbit is given by
+* KeplerOrbit::propagator().
+*/
+class EllipticPropagator
+{
+  public:
+    /**
+    * @brief Find the eccentric and true anomallies from the mean anomally.
+    *
+    * @param mean The mean anomally.
+    * @param eccentricity The eccentricity.
+    * @param ratio The half angle ratio of the orbit
+    * (KeplerOrbit::halfAngleRatio()).
+    * @param anomally The eccentric anomally (output).
+    * @param trueAnomally The true anomally (output).
+    */
+    static inline void solve(
+        radian_type const mean,
+        double const eccentricity,
+        double const ratio,
+        radian_type * const anomally,
+        radian_type * const trueAnomally) noexcept
+    {
+      *anomally = Anomally::eccentricFromMean(mean, eccentricity);
+      *trueAnomally = trueFrom(*anomally, ratio);
+    }
+
+    /**
+    * @brief Find the eccentric and true anomallies from the mean anomally,
+    * starting from the previous eccentric anomally.
+    *
+    * @param mean The mean anomally.
+    * @param eccentricity The eccentricity.
+    * @param ratio The half angle ratio of the orbit.
+    * @param anomally The previous eccentric anomally (input), and the new
+    * one (output).
+    * @param trueAnomally The true anomally (output).
+    */
+    static inline void advance(
+        radian_type const mean,
+        double const eccentricity,
+        double const ratio,
+        radian_type * const anomally,
+        radian_type * const trueAnomally) noexcept
+    {
+      *anomally = Anomally::eccentricFromMean(mean, eccentricity, *anomally);
+      *trueAnomally = trueFrom(*anomally, ratio);
+    }
+
+  private:
+    static inline radian_type trueFrom(
+        radian_type const anomally,
+        double const ratio) noexcept
+    {
+      double const half = anomally*0.5;
+      return 2.0 * std::atan2(ratio*std::sin(half), std::cos(half));
+    }
+};
+
+
+/**
+* @brief The policy for propagating nearly circular orbits (e.g., of
+* station keeping satellites and tidally circularized moons). A single
+* Newton step from the mean anomally finds the eccentric anomally to within
+* about e^3, and the true anomally follows from a series in e, so that each
+* update takes one sine and cosine and no solving.
+*/
+class CircularPropagator
+{
+  public:
+    /**
+    * @brief The largest eccentricity this policy is used for, below which
+    * the error of its series is less than the rounding error of the
+    * anomallies.
+    */
+    static constexpr double const MAX_ECCENTRICITY = 1.0e-5;
+
+    /**
+    * @brief Find the eccentric and true anomallies from the mean anomally.
+    * The true anomally is reduced to [-pi, pi).
+    *
+    * @param mean The mean anomally.
+    * @param eccentricity The eccentricity (e <= MAX_ECCENTRICITY).
+    * @param ratio The half angle ratio of the orbit (unused).
+    * @param anomally The eccentric anomally (output).
+    * @param trueAnomally The true anomally (output).
+    */
+    static inline void solve(
+        radian_type const mean,
+        double const eccentricity,
+        double const ratio,
+        radian_type * const anomally,
+        radian_type * const trueAnomally) noexcept
+    {
+      (void)ratio;
+
+      double const tau = 2.0 * Constants::PI;
+      double const e = eccentricity;
+
+      double const sin_M = std::sin(mean);
+      double const cos_M = std::cos(mean);
+      double const step = e*sin_M / (1.0 - e*cos_M);
+      *anomally = mean + step;
+
+      // the rotation by the step is only needed to first order, and
+      // tan(v/2) = r tan(E/2) is expanded about E with beta = (r-1)/(r+1)
+      double const sin_E = sin_M + step*cos_M;
+      double const cos_E = cos_M - step*sin_M;
+      double const beta = e*(0.5 + 0.125*e*e);
+      double const nu = *anomally + \
+          2.0*beta*sin_E / (1.0 - beta*cos_E);
+      *trueAnomally = nu - tau * std::floor(nu / tau + 0.5);
+    }
+
+    /**
+    * @brief Find the eccentric and true anomallies from the mean anomally.
+    * No previous anomally is needed, so this is the same as solve().
+    *
+    * @param mean The mean anomally.
+    * @param eccentricity The eccentricity (e <= MAX_ECCENTRICITY).
+    * @param ratio The half angle ratio of the orbit (unused).
+    * @param anomally The eccentric anomally (output).
+    * @param trueAnomally The true anomally (output).
+    */
+    static inline void advance(
+        radian_type const mean,
+        double const eccentricity,
+        double const ratio,
+        radian_type * const anomally,
+        radian_type * const trueAnomally) noexcept
+    {
+      solve(mean, eccentricity, ratio, anomally, trueAnomally);
+    }
+};
+
+
+/**
+* @brief The policy for propagating open orbits, which solves the hyperbolic
+* Kepler equation for the hyperbolic anomally.
+*/
+class HyperbolicPropagator
+{
+  public:
+    /**
+    * @brief Find the hyperbolic and true anomallies from the mean anomally.
+    *
+    * @param mean The mean anomally.
+    * @param eccentricity The eccentricity.
+    * @param ratio The half angle ratio of the orbit.
+    * @param anomally The hyperbolic anomally (output).
+    * @param trueAnomally The true anomally (output).
+    */
+    static inline void solve(
+        radian_type const mean,
+        double const eccentricity,
+        double const ratio,
+        radian_type * const anomally,
+        radian_type * const trueAnomally) noexcept
+    {
+      *anomally = Anomally::hyperbolicFromMean(mean, eccentricity);
+      *trueAnomally = 2.0 * std::atan(ratio * std::tanh(*anomally*0.5));
+    }
+
+    /**
+    * @brief Find the hyperbolic and true anomallies from the mean anomally,
+    * starting from the previous hyperbolic anomally.
+    *
+    * @param mean The mean anomally.
+    * @param eccentricity The eccentricity.
+    * @param ratio The half angle ratio of the orbit.
+    * @param anomally The previous hyperbolic anomally (input), and the new
+    * one (output).
+    * @param trueAnomally The true anomally (output).
+    */
+    static inline void advance(
+        radian_type const mean,
+        double const eccentricity,
+        double const ratio,
+        radian_type * const anomally,
+        radian_type * const trueAnomally) noexcept
+    {
+      *anomally = Anomally::hyperbolicFromMean(mean, eccentricity, *anomally);
+      *trueAnomally = 2.0 * std::atan(ratio * std::tanh(*anomally*0.5));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+/**
+* @file Quaternion.hpp
+* @brief The Quaternion class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_QUATERNION_HPP
+#define GRAVITREE_QUATERNION_HPP
+
+#include "Rotation.hpp"
+#include "Vector3D.hpp"
+#include "Types.hpp"
+
+#include <cmath>
+
+namespace gravitree
+{
+
+/**
+* @brief A quaternion, used as a unit quaternion to represent orientations.
+* Unlike Rotation, quaternions compose by multiplication, and rotate vectors
+* without any trigonometry.
+*/
+class Quaternion
+{
+  public:
+    /**
+    * @brief Create a new quaternion (the identity by default).
+    *
+    * @param w The scalar part.
+    * @param x The x component of the vector part.
+    * @param y The y component of the vector part.
+    * @param z The z component of the vector part.
+    */
+    Quaternion(
+        double const w=1.0,
+        double const x=0.0,
+        double const y=0.0,
+        double const z=0.0) noexcept :
+      m_w(w),
+      m_x(x),
+      m_y(y),
+      m_z(z)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Create the unit quaternion of an axis and angle. A rotation
+    * around a zero axis gives the identity.
+    *
+    * @param rot The rotation.
+    *
+    * @return The quaternion.
+    */
+    static inline Quaternion fromRotation(
+        Rotation const & rot) noexcept
+    {
+      Vector3D const axis = rot.axis();
+      double const length = axis.magnitude();
+      if (length == 0.0) {
+        return Quaternion();
+      }
+
+      double const half = 0.5*rot.angle();
+      double const scale = std::sin(half) / length;
+      return Quaternion(std::cos(half), axis.x()*scale, axis.y()*scale, \
+          axis.z()*scale);
+    }
+
+    /**
+    * @brief Get the axis and angle of this unit quaternion. The angle is in
+    * [0, 2pi], and the identity gives an angle of zero around the x axis.
+    *
+    * @return The rotation.
+    */
+    inline Rotation toRotation() const noexcept
+    {
+      Vector3D const vec = vector();
+      double const length = vec.magnitude();
+      if (length == 0.0) {
+        return Rotation();
+      }
+
+      return Rotation(vec / length, 2.0*std::atan2(length, m_w));
+    }
+
+    /**
+    * @brief Get the scalar part.
+    *
+    * @return The scalar part.
+    */
+    inline double w() const noexcept
+    {
+      return m_w;
+    }
+
+    /**
+    * @brief Get the x component of the vector part.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_x;
+    }
+
+    /**
+    * @brief Get the y component of the vector part.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_y;
+    }
+
+    /**
+    * @brief Get the z component of the vector part.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_z;
+    }
+
+    /**
+    * @brief Get the vector part.
+    *
+    * @return The vector part.
+    */
+    inline Vector3D vector() const noexcept
+    {
+      return Vector3D(m_x, m_y, m_z);
+    }
+
+    /**
+    * @brief Multiply this quaternion (p) by another (q), giving the rotation
+    * by q followed by the rotation by p.
+    *
+    * @param other The other quaternion (q).
+    *
+    * @return The product (pq).
+    */
+    inline Quaternion operator*(
+        Quaternion const & other) const noexcept
+    {
+      return Quaternion(
+          m_w*other.m_w - m_x*other.m_x - m_y*other.m_y - m_z*other.m_z,
+          m_w*other.m_x + m_x*other.m_w + m_y*other.m_z - m_z*other.m_y,
+          m_w*other.m_y - m_x*other.m_z + m_y*other.m_w + m_z*other.m_x,
+          m_w*other.m_z + m_x*other.m_y - m_y*other.m_x + m_z*other.m_w);
+    }
+
+    /**
+    * @brief Get the conjugate of this quaternion, which for a unit quaternion
+    * is the inverse rotation.
+    *
+    * @return The conjugate.
+    */
+    inline Quaternion conjugate() const noexcept
+    {
+      return Quaternion(m_w, -m_x, -m_y, -m_z);
+    }
+
+    /**
+    * @brief Get the magnitude of this quaternion.
+    *
+    * @return The magnitude.
+    */
+    inline double magnitude() const noexcept
+    {
+      return std::sqrt(m_w*m_w + m_x*m_x + m_y*m_y + m_z*m_z);
+    }
+
+    /**
+    * @brief Get the unit quaternion in the direction of this one.
+    *
+    * @return The unit quaternion.
+    */
+    inline Quaternion normalized() const noexcept
+    {
+      double const inverse = 1.0 / magnitude();
+      return Quaternion(m_w*inverse, m_x*inverse, m_y*inverse, m_z*inverse);
+    }
+
+    /**
+    * @brief Rotate a vector by this unit quaternion.
+    *
+    * @param vec The vector.
+    *
+    * @return The rotated vector.
+    */
+    inline Vector3D rotate(
+        Vector3D const vec) const noexcept
+    {
+      // v + w t + u x t, where t = 2 u x v
+      Vector3D const u = vector();
+      Vector3D const t = u.cross(vec) * 2.0;
+      return vec + t*m_w + u.cross(t);
+    }
+
+    /**
+    * @brief Check if this quaternion is equal to another.
+    *
+    * @param other The quaternion to test for equality.
+    *
+    * @return True if the quaternions are equal.
+    */
+    inline bool operator==(
+        Quaternion const & other) const noexcept
+    {
+      return m_w == other.m_w && m_x == other.m_x && m_y == other.m_y && \
+          m_z == other.m_z;
+    }
+
+    /**
+    * @brief Check if this quaternion is not equal to another.
+    *
+    * @param other The quaternion to test against.
+    *
+    * @return True if the quaternions are not equal.
+    */
+    inline bool operator!=(
+        Quaternion const & other) const noexcept
+    {
+      return !this->operator==(other);
+    }
+
+  private:
+    double m_w;
+    double m_x;
+    double m_y;
+    double m_z;
+};
+
+}
+
+#endif
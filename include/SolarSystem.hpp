@@ -11,14 +11,26 @@
 #ifndef GRAVITREE_SRC_SOLARSYSTEM_HPP
 #define GRAVITREE_SRC_SOLARSYSTEM_HPP
 
+#include "AncestorIndex.hpp"
+#include "Approach.hpp"
+#include "AttitudeArray.hpp"
 #include "Body.hpp"
+#include "BodyHandle.hpp"
+#include "CatalogBody.hpp"
+#include "Matrix3D.hpp"
 #include "OrbitalState.hpp"
+#include "OrbitalStateArray.hpp"
+#include "Quaternion.hpp"
+#include "SpatialIndex.hpp"
+#include "ThreadPool.hpp"
 #include "Vector3D.hpp"
+#include "Vector3F.hpp"
 
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
+#include <mutex>
+#include <unordered_map>
 
 namespace gravitree
 {
@@ -35,16 +47,39 @@ class InvalidOperationException : public std::runtime_error
 
 
 
+/**
+* @brief A tree of bodies, each following a Keplerian orbit about its parent.
+* The position of every body relative to its parent and to the root is
+* computed once per tick, and again when its orbit changes, by the methods
+* which modify the system. The queries (the const methods) only read these,
+* so they may be made from several threads at once, but not concurrently
+* with any method which modifies the system.
+*/
 class SolarSystem
 {
   public:
+  /**
+  * @brief The frames relative positions can be given in.
+  */
+  enum class frame_type
+  {
+    // the axes of the system, which do not rotate
+    INERTIAL,
+    // the axes of the origin body, which turn with its orientation (see
+    // getOrientation())
+    BODY_FIXED
+  };
+
   /**
   * @brief Create a new solar system.
   *
   * @param root The body which serves as the root of the solar system.
+  * @param numThreads The number of threads to use when propagating the
+  * bodies of the system.
   */
   SolarSystem(
-      Body root);
+      Body root,
+      size_t numThreads = 1);
 
   /**
   * @brief Deleted copy constructor.
@@ -65,7 +100,16 @@ class SolarSystem
       SolarSystem const& rhs) = delete;
 
   /**
-  * @brief Advance the solar system by the given number of seconds.
+  * @brief Advance the solar system by the given number of seconds. The
+  * orbital state of every body is advanced, with the work split across the
+  * threads of the system. The result does not depend on the number of
+  * threads. The orientation of every body is turned by its angular velocity
+  * in the same way.
+  *
+  * Afterwards, bodies which have left the sphere of influence of their
+  * parent become children of their grandparent, and bodies which have
+  * entered the sphere of influence of a more massive sibling become its
+  * children. The orbits of all such bodies are recomputed in one batch.
   *
   * @param seconds The seconds passing.
   */
@@ -73,19 +117,77 @@ class SolarSystem
       second_type seconds);
 
   /**
-  * @brief Add a body with the specified position and velocity. It will be
-  * added as a child of whichever body its sphere of influence it occupies.
+  * @brief Set the number of threads used to propagate the bodies of the
+  * system.
+  *
+  * @param numThreads The number of threads (0 is treated as 1).
+  */
+  void setNumThreads(
+      size_t numThreads);
+
+  /**
+  * @brief Get the number of threads used to propagate the bodies of the
+  * system.
+  *
+  * @return The number of threads.
+  */
+  size_t numThreads() const noexcept;
+
+  /**
+  * @brief Enable or disable the single precision positions given by the
+  * Vector3F overloads of getRelativeTo(). While enabled, every orbit is also
+  * evaluated in single precision relative to its parent whenever its double
+  * precision position is, from single precision copies of its frame (half
+  * the memory read), and these are summed down the tree in double
+  * precision. While disabled, the Vector3F overloads round the double
+  * precision positions instead. It is disabled by default.
+  *
+  * @param enabled Whether to keep the single precision positions.
+  */
+  void setSinglePrecision(
+      bool enabled);
+
+  /**
+  * @brief Check if the single precision positions are kept (see
+  * setSinglePrecision()).
+  *
+  * @return True if they are kept.
+  */
+  bool singlePrecision() const noexcept;
+
+  /**
+  * @brief Add a body with the specified position and velocity. It is added
+  * as a child of the given parent, and on each tick is moved to whichever
+  * body's sphere of influence it occupies.
   *
   * @param body The body.
   * @param position The position relative to the parent body.
   * @param velocity The velocity relative to the parent body.
   * @param parent The body being orbited.
+  *
+  * @return The handle of the new body.
   */
-  void addBody(
+  BodyHandle addBody(
       Body body,
       Vector3D position,
       Vector3D velocity,
       Body::id_type parent);
+
+  /**
+  * @brief Add a body with the specified position and velocity.
+  *
+  * @param body The body.
+  * @param position The position relative to the parent body.
+  * @param velocity The velocity relative to the parent body.
+  * @param parent The handle of the body being orbited.
+  *
+  * @return The handle of the new body.
+  */
+  BodyHandle addBody(
+      Body body,
+      Vector3D position,
+      Vector3D velocity,
+      BodyHandle parent);
   
   /**
   * @brief Add a body with the specified orbit.
@@ -93,12 +195,77 @@ class SolarSystem
   * @param body The body.
   * @param state The orbit.
   * @param parent The body being orbited.
+  *
+  * @return The handle of the new body.
   */
-  void addBody(
+  BodyHandle addBody(
       Body body,
       OrbitalState state,
       Body::id_type parent);
+
+  /**
+  * @brief Add a body with the specified orbit.
+  *
+  * @param body The body.
+  * @param state The orbit.
+  * @param parent The handle of the body being orbited.
+  *
+  * @return The handle of the new body.
+  */
+  BodyHandle addBody(
+      Body body,
+      OrbitalState state,
+      BodyHandle parent);
  
+  /**
+  * @brief Add the bodies of a catalog (e.g., a constexpr catalog of known
+  * bodies). Each body's orbit is built from its elements directly (the
+  * overload taking a CatalogOrbits' data skips deriving them), and each
+  * body must come after the body it orbits, either in the catalog or already
+  * in the system. An entry for the root of the system is skipped. The whole
+  * catalog is checked before any body is added, so if it is rejected the
+  * system is unchanged.
+  *
+  * @param bodies The catalog.
+  * @param num The number of bodies in the catalog.
+  *
+  * @throws std::invalid_argument If the catalog has a root other than the
+  * root of the system.
+  * @throws InvalidOperationException If a body's id is already in the system
+  * or the catalog.
+  * @throws std::out_of_range If a body orbits a body in neither the system
+  * nor the preceding entries of the catalog.
+  */
+  void addBodies(
+      CatalogBody const * bodies,
+      size_t num);
+
+  /**
+  * @brief Add the bodies of a catalog along with the quantities derived from
+  * their orbits (e.g., by a constexpr CatalogOrbits), so that the orbits are
+  * created without computing them again. The catalog is otherwise added as
+  * by addBodies(bodies, num), and it is checked the same way. An orbit
+  * whose derived quantities were found for a parent of a different mass
+  * (e.g., a parent that was not in the catalog) is instead built from its
+  * elements.
+  *
+  * @param bodies The catalog.
+  * @param orbits The quantities derived from the orbit of each body, in the
+  * same order.
+  * @param num The number of bodies in the catalog.
+  *
+  * @throws std::invalid_argument If the catalog has a root other than the
+  * root of the system.
+  * @throws InvalidOperationException If a body's id is already in the system
+  * or the catalog.
+  * @throws std::out_of_range If a body orbits a body in neither the system
+  * nor the preceding entries of the catalog.
+  */
+  void addBodies(
+      CatalogBody const * bodies,
+      KeplerOrbit::derived_struct const * orbits,
+      size_t num);
+
   /**
   * @brief Remove a body from the system.
   *
@@ -108,7 +275,37 @@ class SolarSystem
       Body::id_type id);
 
   /**
-  * @brief Get the body with the given name.
+  * @brief Remove a body from the system. All handles to it become stale.
+  *
+  * @param handle The handle of the body.
+  */
+  void removeBody(
+      BodyHandle handle);
+
+  /**
+  * @brief Get the handle of the body with the given id.
+  *
+  * @param id The body's id.
+  *
+  * @return The handle.
+  */
+  BodyHandle getHandle(
+      Body::id_type id) const;
+
+  /**
+  * @brief Check if a handle refers to a body still in the system.
+  *
+  * @param handle The handle.
+  *
+  * @return True if the body has not been removed.
+  */
+  bool isValid(
+      BodyHandle handle) const noexcept;
+
+  /**
+  * @brief Get the body with the given name. The body cannot be modified
+  * through this, as the system caches values derived from its mass (see
+  * setMass() and setAngularVelocity()).
   *
   * @param id The body's id.
   *
@@ -116,9 +313,15 @@ class SolarSystem
   */
   Body const * getBody(
       Body::id_type id) const;
-  
+
   /**
-  * @brief Get the body with the given name.
+  * @brief Get the body with the given name, to modify.
+  *
+  * @deprecated Changing a body through this bypasses what the system caches
+  * from it: the order of siblings by mass, the sphere of influence, and the
+  * orbits of the children about the mass are left as they were, and the
+  * attitude does not follow Body::setAngularVelocity(). Use setMass() and
+  * setAngularVelocity() instead. It is kept for existing callers.
   *
   * @param id The body's id.
   *
@@ -127,10 +330,153 @@ class SolarSystem
   Body * getBody(
       Body::id_type id);
 
+  /**
+  * @brief Get the body with the given handle. This takes O(1) time.
+  *
+  * @param handle The body's handle.
+  *
+  * @return The body.
+  */
+  Body const * getBody(
+      BodyHandle handle) const;
+
+  /**
+  * @brief Get the body with the given handle, to modify. This takes O(1)
+  * time.
+  *
+  * @deprecated As with getBody(Body::id_type), changes made through this
+  * bypass what the system caches from the body. Use setMass() and
+  * setAngularVelocity() instead.
+  *
+  * @param handle The body's handle.
+  *
+  * @return The body.
+  */
+  Body * getBody(
+      BodyHandle handle);
+
+  /**
+  * @brief Set the mass of a body. Its place among its siblings (which are
+  * sorted by mass) and its sphere of influence are updated, and the orbits
+  * of its children are recomputed about the new mass from their current
+  * positions and velocities.
+  *
+  * @param id The body's id.
+  * @param mass The new mass.
+  */
+  void setMass(
+      Body::id_type id,
+      kilo_type mass);
+
+  /**
+  * @brief Set the mass of a body.
+  *
+  * @param handle The body's handle.
+  * @param mass The new mass.
+  */
+  void setMass(
+      BodyHandle handle,
+      kilo_type mass);
+
+  /**
+  * @brief Get the body which a body currently orbits.
+  *
+  * @param id The body's id.
+  *
+  * @return The parent body, or nullptr for the root.
+  */
+  Body const * getParent(
+      Body::id_type id) const;
+
+  /**
+  * @brief Get the body which a body currently orbits.
+  *
+  * @param handle The body's handle.
+  *
+  * @return The parent body, or nullptr for the root.
+  */
+  Body const * getParent(
+      BodyHandle handle) const;
+
+  /**
+  * @brief Get the orientation of a body, which takes vectors from the
+  * body's frame to the frame of the system. Each body starts with the
+  * identity, and is turned on each tick by its angular velocity.
+  *
+  * @param id The body's id.
+  *
+  * @return The orientation.
+  */
+  Quaternion getOrientation(
+      Body::id_type id) const;
+
+  /**
+  * @brief Get the orientation of a body.
+  *
+  * @param handle The body's handle.
+  *
+  * @return The orientation.
+  */
+  Quaternion getOrientation(
+      BodyHandle handle) const;
+
+  /**
+  * @brief Get the orientation of every body in the system, in the order of
+  * their slots. The list is cleared first, but its capacity is kept.
+  *
+  * @param list The list to fill with pairs of bodies and orientations.
+  */
+  void getOrientations(
+      std::vector<std::pair<Body const *, Quaternion>> * list) const;
+
+  /**
+  * @brief Set the orientation of a body.
+  *
+  * @param id The body's id.
+  * @param orientation The orientation (a unit quaternion).
+  */
+  void setOrientation(
+      Body::id_type id,
+      Quaternion orientation);
+
+  /**
+  * @brief Set the orientation of a body.
+  *
+  * @param handle The body's handle.
+  * @param orientation The orientation (a unit quaternion).
+  */
+  void setOrientation(
+      BodyHandle handle,
+      Quaternion orientation);
+
+  /**
+  * @brief Set the angular velocity of a body, both of the body itself and
+  * of the attitude turned on each tick.
+  *
+  * @param id The body's id.
+  * @param velocity The angular velocity, about an axis in the frame of the
+  * system.
+  */
+  void setAngularVelocity(
+      Body::id_type id,
+      Rotation velocity);
+
+  /**
+  * @brief Set the angular velocity of a body.
+  *
+  * @param handle The body's handle.
+  * @param velocity The angular velocity, about an axis in the frame of the
+  * system.
+  */
+  void setAngularVelocity(
+      BodyHandle handle,
+      Rotation velocity);
+
   /**
   * @brief Get the position of the specified body relative to the other body.
-  * This takes O(d + log n) time, where d is the maximum depth of the tree, and
-  * n is the number of bodies in the tree.
+  * The cached positions of the bodies relative to their parents are summed
+  * only along the paths from both bodies to their lowest common ancestor,
+  * which is found in O(log d) time, where d is the maximum depth of the tree.
   *
   * @param queryBody The body to get the relative position of.
   * @param relativeRoot The body to use as the "root".
@@ -141,11 +487,55 @@ class SolarSystem
       Body::id_type queryBody,
       Body::id_type relativeRoot) const;
 
+  /**
+  * @brief Get the position of the specified body relative to the other body.
+  *
+  * @param queryBody The handle of the body to get the relative position of.
+  * @param relativeRoot The handle of the body to use as the "root".
+  *
+  * @return The relative position.
+  */
+  Vector3D getBodyPositionRelativeTo(
+      BodyHandle queryBody,
+      BodyHandle relativeRoot) const;
+
+  /**
+  * @brief Get the position of the specified body relative to the other body,
+  * in the given frame of the other body.
+  *
+  * @param queryBody The body to get the relative position of.
+  * @param relativeRoot The body to use as the "root".
+  * @param frame The frame of the root to give the position in.
+  *
+  * @return The relative position.
+  */
+  Vector3D getBodyPositionRelativeTo(
+      Body::id_type queryBody,
+      Body::id_type relativeRoot,
+      frame_type frame) const;
+
+  /**
+  * @brief Get the position of the specified body relative to the other body,
+  * in the given frame of the other body.
+  *
+  * @param queryBody The handle of the body to get the relative position of.
+  * @param relativeRoot The handle of the body to use as the "root".
+  * @param frame The frame of the root to give the position in.
+  *
+  * @return The relative position.
+  */
+  Vector3D getBodyPositionRelativeTo(
+      BodyHandle queryBody,
+      BodyHandle relativeRoot,
+      frame_type frame) const;
+
 
   /**
   * @brief Get the location of every body in the system relative to another. No
-  * rotations are applied. This takes O(n) time where n is the number of bodies
-  * in the tree.
+  * rotations are applied (see the overloads taking a frame_type for positions
+  * in the body-fixed frame of the origin). This takes O(n) time where n is
+  * the number of bodies in the tree, subtracting the cached position of the
+  * origin relative to the root from that of each body.
   *
   * @param body The body of the body to use as the origin.
   *
@@ -154,23 +544,675 @@ class SolarSystem
   std::vector<std::pair<Body const *, Vector3D>> getRelativeTo(
       Body::id_type body) const;
 
+  /**
+  * @brief Get the location of every body in the system relative to another.
+  *
+  * @param body The handle of the body to use as the origin.
+  *
+  * @return The pairs of bodies and relative positions.
+  */
+  std::vector<std::pair<Body const *, Vector3D>> getRelativeTo(
+      BodyHandle body) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another,
+  * writing them into a caller owned list. The list is cleared first, but its
+  * capacity is kept, so reusing the same list every tick avoids allocation.
+  *
+  * @param body The body of the body to use as the origin.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      Body::id_type body,
+      std::vector<std::pair<Body const *, Vector3D>> * list) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another,
+  * writing them into a caller owned list.
+  *
+  * @param body The handle of the body to use as the origin.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      BodyHandle body,
+      std::vector<std::pair<Body const *, Vector3D>> * list) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another
+  * in single precision, for clients such as renderers which consume many
+  * positions but only need them to about seven significant digits. With
+  * setSinglePrecision() enabled, each orbit is evaluated in single precision
+  * relative to its parent, and the positions are summed down the tree in
+  * double precision, so the error of each position is about 1e-7 of the
+  * distances from each body on the path to the origin to its parent (e.g.,
+  * about 1 m for bodies within 1e7 m of their parent). Otherwise each
+  * position is rounded from double precision, with an error of about 1e-7
+  * of its distance from the origin.
+  *
+  * @param body The body of the body to use as the origin.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      Body::id_type body,
+      std::vector<std::pair<Body const *, Vector3F>> * list) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another
+  * in single precision.
+  *
+  * @param body The handle of the body to use as the origin.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      BodyHandle body,
+      std::vector<std::pair<Body const *, Vector3F>> * list) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another,
+  * in the given frame of the other body. Positions in the body-fixed frame
+  * are rotated as they are written to the list, by the rotation matrix of
+  * the origin's orientation, rather than in a separate pass.
+  *
+  * @param body The body of the body to use as the origin.
+  * @param frame The frame of the origin to give the positions in.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      Body::id_type body,
+      frame_type frame,
+      std::vector<std::pair<Body const *, Vector3D>> * list) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another,
+  * in the given frame of the other body.
+  *
+  * @param body The handle of the body to use as the origin.
+  * @param frame The frame of the origin to give the positions in.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      BodyHandle body,
+      frame_type frame,
+      std::vector<std::pair<Body const *, Vector3D>> * list) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another
+  * in single precision, in the given frame of the other body. The rotation
+  * is applied in double precision before rounding.
+  *
+  * @param body The body of the body to use as the origin.
+  * @param frame The frame of the origin to give the positions in.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      Body::id_type body,
+      frame_type frame,
+      std::vector<std::pair<Body const *, Vector3F>> * list) const;
+
+  /**
+  * @brief Get the location of every body in the system relative to another
+  * in single precision, in the given frame of the other body.
+  *
+  * @param body The handle of the body to use as the origin.
+  * @param frame The frame of the origin to give the positions in.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void getRelativeTo(
+      BodyHandle body,
+      frame_type frame,
+      std::vector<std::pair<Body const *, Vector3F>> * list) const;
+
+  /**
+  * @brief Get the positions of many bodies relative to other bodies at once.
+  * Each result is identical to that of getBodyPositionRelativeTo(), and large
+  * batches are split across the threads of the system.
+  *
+  * @param queries The (queryBody, relativeRoot) pairs.
+  * @param numQueries The number of pairs.
+  * @param positions The array to fill with the relative positions (must be
+  * of length numQueries).
+  */
+  void getBodyPositionsRelativeTo(
+      std::pair<Body::id_type, Body::id_type> const * queries,
+      size_t numQueries,
+      Vector3D * positions) const;
+
+  /**
+  * @brief Get the positions of many bodies relative to other bodies at once.
+  *
+  * @param queries The (queryBody, relativeRoot) pairs of handles.
+  * @param numQueries The number of pairs.
+  * @param positions The array to fill with the relative positions (must be
+  * of length numQueries).
+  */
+  void getBodyPositionsRelativeTo(
+      std::pair<BodyHandle, BodyHandle> const * queries,
+      size_t numQueries,
+      Vector3D * positions) const;
+
+  /**
+  * @brief Get every body within a distance of another body (including the
+  * body itself). The bodies are found using a spatial index over their
+  * positions, which is refit or rebuilt on the first query after they move
+  * (by one query at a time, as the index is shared), so each query takes
+  * time proportional to the number of bodies found rather than the number in
+  * the system.
+  *
+  * @param body The id of the body at the center.
+  * @param radius The distance.
+  * @param list The list to fill with the bodies found (in no particular
+  * order).
+  */
+  void getBodiesWithin(
+      Body::id_type body,
+      meter_type radius,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Get every body within a distance of another body (including the
+  * body itself).
+  *
+  * @param body The handle of the body at the center.
+  * @param radius The distance.
+  * @param list The list to fill with the bodies found.
+  */
+  void getBodiesWithin(
+      BodyHandle body,
+      meter_type radius,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Get every body within a distance of a point.
+  *
+  * @param point The point, relative to the given body.
+  * @param relativeRoot The id of the body the point is relative to.
+  * @param radius The distance.
+  * @param list The list to fill with the bodies found.
+  */
+  void getBodiesWithin(
+      Vector3D point,
+      Body::id_type relativeRoot,
+      meter_type radius,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Get every body within a distance of a point.
+  *
+  * @param point The point, relative to the given body.
+  * @param relativeRoot The handle of the body the point is relative to.
+  * @param radius The distance.
+  * @param list The list to fill with the bodies found.
+  */
+  void getBodiesWithin(
+      Vector3D point,
+      BodyHandle relativeRoot,
+      meter_type radius,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Get every body inside an axis aligned box. No rotations are
+  * applied.
+  *
+  * @param min The corner of the box with the smallest coordinates, relative
+  * to the given body.
+  * @param max The corner of the box with the largest coordinates, relative
+  * to the given body.
+  * @param relativeRoot The id of the body the box is relative to.
+  * @param list The list to fill with the bodies found.
+  */
+  void getBodiesInside(
+      Vector3D min,
+      Vector3D max,
+      Body::id_type relativeRoot,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Get every body inside an axis aligned box.
+  *
+  * @param min The corner of the box with the smallest coordinates, relative
+  * to the given body.
+  * @param max The corner of the box with the largest coordinates, relative
+  * to the given body.
+  * @param relativeRoot The handle of the body the box is relative to.
+  * @param list The list to fill with the bodies found.
+  */
+  void getBodiesInside(
+      Vector3D min,
+      Vector3D max,
+      BodyHandle relativeRoot,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Find when two bodies come closest to each other over an interval
+  * of time, following their orbits (and those of their ancestors) as they
+  * will be propagated. The distance between the bodies is sampled several
+  * times per period of the fastest orbit involved, to bracket each time at
+  * which the bodies stop approaching one another, which is then found by
+  * root finding on the rate of change of the distance. Closest approaches
+  * which begin and end between two samples may be missed.
+  *
+  * @param body The id of the first body.
+  * @param other The id of the second body.
+  * @param start The start of the interval, in seconds from now.
+  * @param end The end of the interval, in seconds from now.
+  *
+  * @return The closest approach (to the second body).
+  */
+  Approach findClosestApproach(
+      Body::id_type body,
+      Body::id_type other,
+      second_type start,
+      second_type end) const;
+
+  /**
+  * @brief Find when two bodies come closest to each other over an interval
+  * of time.
+  *
+  * @param body The handle of the first body.
+  * @param other The handle of the second body.
+  * @param start The start of the interval, in seconds from now.
+  * @param end The end of the interval, in seconds from now.
+  *
+  * @return The closest approach (to the second body).
+  */
+  Approach findClosestApproach(
+      BodyHandle body,
+      BodyHandle other,
+      second_type start,
+      second_type end) const;
+
+  /**
+  * @brief Find every body which comes within a distance of a body over an
+  * interval of time, and when it comes closest. Bodies whose apsides keep
+  * them too far apart are ruled out without searching their orbits, and the
+  * rest are searched in parallel.
+  *
+  * @param body The id of the body.
+  * @param start The start of the interval, in seconds from now.
+  * @param end The end of the interval, in seconds from now.
+  * @param threshold The distance.
+  * @param list The list to fill with the closest approach of each body
+  * found, in the order of their slots.
+  */
+  void findClosestApproaches(
+      Body::id_type body,
+      second_type start,
+      second_type end,
+      meter_type threshold,
+      std::vector<Approach> * list) const;
+
+  /**
+  * @brief Find every body which comes within a distance of a body over an
+  * interval of time, and when it comes closest.
+  *
+  * @param body The handle of the body.
+  * @param start The start of the interval, in seconds from now.
+  * @param end The end of the interval, in seconds from now.
+  * @param threshold The distance.
+  * @param list The list to fill with the closest approach of each body
+  * found.
+  */
+  void findClosestApproaches(
+      BodyHandle body,
+      second_type start,
+      second_type end,
+      meter_type threshold,
+      std::vector<Approach> * list) const;
+
   private:
   struct node_struct
   {
     Body body;
-    OrbitalState state;
+    size_t slot;
     node_struct * parent;
+    // sorted by decreasing mass
     std::vector<node_struct*> children;
+    // cached from the orbit of the node for the sphere of influence checks
+    meter_type sphereOfInfluence;
+    meter_type periapsis;
+    meter_type apoapsis;
+  };
+
+  // the scratch space of reparentBodies(), kept to reuse its capacity
+  struct reparent_struct
+  {
+    // the nodes which may have changed sphere, and the new parent of each
+    std::vector<node_struct*> candidates;
+    std::vector<node_struct*> captures;
+    // the slots whose positions the checks read, and whether each slot is
+    // among them
+    std::vector<size_t> needed;
+    std::vector<char> isNeeded;
+    // the positions, velocities and new parent masses of the nodes moving,
+    // and their new orbits
+    std::vector<Vector3D> positions;
+    std::vector<Vector3D> velocities;
+    std::vector<kilo_type> masses;
+    std::vector<OrbitalState> states;
   };
 
   second_type m_time;
-  std::map<Body::id_type, std::unique_ptr<node_struct>> m_bodies;
+  std::unordered_map<Body::id_type, std::unique_ptr<node_struct>> m_bodies;
   node_struct * m_root;
+  // the orbital state of each node, indexed by the node's slot
+  OrbitalStateArray m_states;
+  // the attitude of each node, indexed by the node's slot
+  AttitudeArray m_attitudes;
+  // the node in each slot (nullptr for free slots), and the number of times
+  // each slot has been freed
+  std::vector<node_struct*> m_slots;
+  std::vector<BodyHandle::generation_type> m_generations;
+  std::unique_ptr<ThreadPool> m_pool;
+
+  // positions relative to the parent and to the root, indexed by slot, which
+  // are kept up to date by every method modifying the system
+  std::vector<Vector3D> m_localPositions;
+  std::vector<Vector3D> m_rootPositions;
+  // the same in single precision relative to the parent, summed to the root
+  // in double precision, indexed by slot and only kept while m_single is set
+  bool m_single;
+  std::vector<Vector3F> m_singleLocals;
+  std::vector<Vector3D> m_singleRoots;
+  AncestorIndex m_ancestors;
+  // the stack used to walk the tree, kept to reuse its capacity
+  std::vector<node_struct const *> m_traversal;
+  reparent_struct m_reparent;
+
+  // an index over the root positions of the bodies, which must be rebuilt
+  // when bodies are added or removed, and refit when they move. It is only
+  // used by range queries, so it is brought up to date by the first of them
+  // after a change, holding the mutex.
+  mutable std::mutex m_spatialMutex;
+  mutable SpatialIndex m_spatial;
+  mutable bool m_spatialRebuild;
+  mutable bool m_spatialStale;
+  mutable size_t m_spatialRefits;
+
+  /**
+  * @brief Find the node of a body.
+  *
+  * @param id The id of the body.
+  *
+  * @return The node.
+  */
+  node_struct * findNode(
+      Body::id_type id) const;
+
+  /**
+  * @brief Find the node of a body, throwing std::out_of_range if the handle
+  * is stale.
+  *
+  * @param handle The handle of the body.
+  *
+  * @return The node.
+  */
+  node_struct * findNode(
+      BodyHandle handle) const;
 
-  void getTreeRelativeTo(
-      Vector3D origin,
+  /**
+  * @brief Add a new node for a body.
+  *
+  * @param body The body.
+  * @param state The orbital state of the body.
+  * @param parent The parent node.
+  *
+  * @return The handle of the body.
+  */
+  BodyHandle addNode(
+      Body const & body,
+      OrbitalState const & state,
+      node_struct * parent);
+
+  /**
+  * @brief Remove a node, making its children children of its parent.
+  *
+  * @param node The node.
+  */
+  void removeNode(
+      node_struct * node);
+
+  /**
+  * @brief Change the mass of a node, updating everything derived from it.
+  *
+  * @param node The node.
+  * @param mass The new mass.
+  */
+  void setNodeMass(
+      node_struct * node,
+      kilo_type mass);
+
+  /**
+  * @brief Make a node the child of a new parent. The node must already be
+  * detached from its old parent.
+  *
+  * @param node The node.
+  * @param parent The new parent node.
+  * @param state The orbital state of the node about the new parent.
+  */
+  void moveNode(
+      node_struct * node,
+      node_struct * parent,
+      OrbitalState const & state);
+
+  /**
+  * @brief Add a node to the children of another, keeping the children sorted
+  * by decreasing mass.
+  *
+  * @param parent The parent node.
+  * @param child The child node.
+  */
+  void attachChild(
+      node_struct * parent,
+      node_struct * child);
+
+  /**
+  * @brief Recompute the cached sphere of influence and apsides of a node
+  * from its orbit.
+  *
+  * @param node The node.
+  */
+  void updateSphere(
+      node_struct * node) const;
+
+  /**
+  * @brief Move every body which has left the sphere of influence of its
+  * parent, or entered that of a sibling, to its new parent. The apsides of
+  * each node bound where it can be, so that most nodes are ruled out before
+  * any positions are computed, and only the positions of the rest (and of
+  * the siblings they may enter) are. This leaves the cached positions
+  * relative to the parents of other nodes stale.
+  */
+  void reparentBodies();
+
+  /**
+  * @brief Check if the orbit of a node can come within the sphere of
+  * influence of a sibling, from their apsides.
+  *
+  * @param node The node.
+  * @param sibling The sibling.
+  *
+  * @return True if the sphere may be entered.
+  */
+  static bool mayEnterSphere(
       node_struct const * node,
+      node_struct const * sibling) noexcept;
+
+  /**
+  * @brief Find the body whose sphere of influence a node has moved into,
+  * from the cached positions of it and of the siblings it may enter.
+  *
+  * @param node The node (must not be the root).
+  *
+  * @return The new parent, or nullptr if the node stays with its parent.
+  */
+  node_struct * findSphere(
+      node_struct const * node) const;
+
+  /**
+  * @brief Get the position of one slot relative to another, from the cached
+  * positions.
+  *
+  * @param queryBody The slot of the body to get the position of.
+  * @param relativeRoot The slot of the body to use as the origin.
+  *
+  * @return The relative position.
+  */
+  Vector3D pathOffset(
+      size_t queryBody,
+      size_t relativeRoot) const;
+
+  /**
+  * @brief Answer a batch of relative position queries.
+  *
+  * @tparam T The type identifying the bodies (id or handle).
+  * @param queries The (queryBody, relativeRoot) pairs.
+  * @param numQueries The number of pairs.
+  * @param positions The array to fill with the relative positions.
+  */
+  template<typename T>
+  void batchPositions(
+      std::pair<T, T> const * queries,
+      size_t numQueries,
+      Vector3D * positions) const;
+
+  /**
+  * @brief Get the rotation matrix taking vectors from the frame of the
+  * system to a frame of the body in a slot.
+  *
+  * @param slot The slot of the body.
+  * @param frame The frame.
+  *
+  * @return The rotation matrix.
+  */
+  Matrix3D frameOf(
+      size_t slot,
+      frame_type frame) const noexcept;
+
+  /**
+  * @brief Get the location of every body relative to the body in a slot.
+  *
+  * @param origin The slot of the body to use as the origin.
+  * @param frame The frame of the origin to give the positions in.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void relativeTo(
+      size_t origin,
+      frame_type frame,
       std::vector<std::pair<Body const *, Vector3D>> * list) const;
+
+  /**
+  * @brief Get the location of every body relative to the body in a slot in
+  * single precision.
+  *
+  * @param origin The slot of the body to use as the origin.
+  * @param frame The frame of the origin to give the positions in.
+  * @param list The list to fill with pairs of bodies and relative positions.
+  */
+  void relativeTo(
+      size_t origin,
+      frame_type frame,
+      std::vector<std::pair<Body const *, Vector3F>> * list) const;
+
+  /**
+  * @brief Get every body within a distance of a point.
+  *
+  * @param center The point, relative to the root.
+  * @param radius The distance.
+  * @param list The list to fill with the bodies found.
+  */
+  void bodiesWithin(
+      Vector3D center,
+      meter_type radius,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Get every body inside an axis aligned box.
+  *
+  * @param min The corner with the smallest coordinates, relative to the
+  * root.
+  * @param max The corner with the largest coordinates, relative to the root.
+  * @param list The list to fill with the bodies found.
+  */
+  void bodiesInside(
+      Vector3D min,
+      Vector3D max,
+      std::vector<Body const *> * list) const;
+
+  /**
+  * @brief Bring the spatial index up to date with the root positions of the
+  * bodies. Only one thread does so at a time.
+  */
+  void updateSpatialIndex() const;
+
+  /**
+  * @brief Get the slots whose positions sum to the offset of one body from
+  * another, with the sign of each.
+  *
+  * @param body The slot of the body.
+  * @param other The slot of the other body.
+  * @param path The list to fill with the (slot, sign) pairs.
+  */
+  void approachPath(
+      size_t body,
+      size_t other,
+      std::vector<std::pair<size_t, double>> * path) const;
+
+  /**
+  * @brief Get a lower bound on the distance between two bodies at any time,
+  * from the apsides of the orbits between them and their common ancestor.
+  *
+  * @param body The slot of the body.
+  * @param other The slot of the other body.
+  *
+  * @return The lower bound.
+  */
+  meter_type minimumDistance(
+      size_t body,
+      size_t other) const;
+
+  /**
+  * @brief Find the closest approach along a path between two bodies. The
+  * interval is sampled in steps short enough that, by the fastest the
+  * bodies can move relative to each other, no time between two samples
+  * comes closer than the closest distance found by more than a small
+  * fraction. Closed orbits further limit the steps to a fraction of their
+  * period. Each approach bracketed by the samples is then refined.
+  *
+  * @param path The (slot, sign) pairs from approachPath().
+  * @param start The start of the interval, in seconds from now.
+  * @param end The end of the interval, in seconds from now.
+  *
+  * @return The time and distance of the closest approach.
+  */
+  std::pair<second_type, meter_type> closestApproach(
+      std::vector<std::pair<size_t, double>> const & path,
+      second_type start,
+      second_type end) const;
+
+  /**
+  * @brief Recompute the position of a body relative to its parent, after
+  * its orbit has changed.
+  *
+  * @param slot The slot of the body.
+  */
+  void updateLocalPosition(
+      size_t slot);
+
+  /**
+  * @brief Recompute the positions of every body relative to its parent,
+  * after time has passed.
+  */
+  void updateLocalPositions();
+
+  /**
+  * @brief Recompute the root positions of a node and its descendants from
+  * their positions relative to their parents, walking the tree with an
+  * explicit stack.
+  *
+  * @param node The node.
+  */
+  void updateRootPositions(
+      node_struct const * node);
 };
 
 }
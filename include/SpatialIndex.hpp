@@ -0,0 +1,139 @@
+/**
+* @file SpatialIndex.hpp
+* @brief The SpatialIndex class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-22
+*/
+
+
+
+#ifndef GRAVITREE_SPATIALINDEX_HPP
+#define GRAVITREE_SPATIALINDEX_HPP
+
+#include "Vector3D.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace gravitree
+{
+
+/**
+* @brief A bounding volume hierarchy over a set of points, for finding the
+* points within a sphere or box without testing each of them. Building it
+* takes O(n log n) time. When the points move, refitting the bounds of the
+* existing hierarchy takes O(n) time, though the hierarchy becomes less
+* effective the further the points move from where they were when it was
+* built.
+*/
+class SpatialIndex
+{
+  public:
+    /**
+    * @brief A function called with each item found by a query.
+    */
+    using visit_function = std::function<void(size_t item)>;
+
+    /**
+    * @brief Create a new empty index.
+    */
+    SpatialIndex();
+
+    /**
+    * @brief Build the index over the given items.
+    *
+    * @param positions The position of each item, indexed by item.
+    * @param items The items to index.
+    * @param numItems The number of items.
+    */
+    void build(
+        Vector3D const * positions,
+        size_t const * items,
+        size_t numItems);
+
+    /**
+    * @brief Update the bounds of the index after the items have moved.
+    *
+    * @param positions The new position of each item, indexed by item.
+    */
+    void refit(
+        Vector3D const * positions);
+
+    /**
+    * @brief Get the number of items in the index.
+    *
+    * @return The number of items.
+    */
+    size_t size() const noexcept;
+
+    /**
+    * @brief Find every item within a distance of a point (inclusive).
+    *
+    * @param center The point.
+    * @param radius The distance.
+    * @param visit The function to call with each item found.
+    */
+    void within(
+        Vector3D const & center,
+        double radius,
+        visit_function const & visit) const;
+
+    /**
+    * @brief Find every item inside an axis aligned box (inclusive).
+    *
+    * @param min The corner of the box with the smallest coordinates.
+    * @param max The corner of the box with the largest coordinates.
+    * @param visit The function to call with each item found.
+    */
+    void inside(
+        Vector3D const & min,
+        Vector3D const & max,
+        visit_function const & visit) const;
+
+  private:
+    struct node_struct
+    {
+      double min[3];
+      double max[3];
+      // the range of m_items covered by the node
+      size_t begin;
+      size_t end;
+      // the index of the second child (the first always follows its parent),
+      // or 0 for leaves
+      size_t right;
+    };
+
+    std::vector<node_struct> m_nodes;
+    // the items, ordered so that each node covers a contiguous range
+    std::vector<size_t> m_items;
+    // the position of each item in m_items
+    std::vector<Vector3D> m_points;
+
+    /**
+    * @brief Build the subtree over a range of items, splitting at the median
+    * of its longest axis.
+    *
+    * @param positions The position of each item, indexed by item.
+    * @param begin The start of the range.
+    * @param end The end of the range.
+    */
+    void buildNode(
+        Vector3D const * positions,
+        size_t begin,
+        size_t end);
+
+    /**
+    * @brief Set the bounds of a leaf from its points.
+    *
+    * @param node The leaf.
+    */
+    void fitLeaf(
+        node_struct * node) const noexcept;
+};
+
+}
+
+#endif
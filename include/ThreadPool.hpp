@@ -0,0 +1,122 @@
+/**
+* @file ThreadPool.hpp
+* @brief The ThreadPool class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-12
+*/
+
+
+
+#ifndef GRAVITREE_THREADPOOL_HPP
+#define GRAVITREE_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gravitree
+{
+
+class ThreadPool
+{
+  public:
+    /**
+    * @brief A function operating on the half open range [begin, end).
+    */
+    using range_function = std::function<void(size_t begin, size_t end)>;
+
+    /**
+    * @brief Create a new thread pool. The calling thread counts as one of the
+    * workers, so a pool of one thread never spawns any threads.
+    *
+    * @param numThreads The number of threads to use (0 is treated as 1).
+    */
+    explicit ThreadPool(
+        size_t numThreads);
+
+    /**
+    * @brief Deleted copy constructor.
+    *
+    * @param rhs The pool to copy.
+    */
+    ThreadPool(
+        ThreadPool const & rhs) = delete;
+
+    /**
+    * @brief Deleted assignment operator.
+    *
+    * @param rhs The pool to copy.
+    *
+    * @return This pool.
+    */
+    ThreadPool& operator=(
+        ThreadPool const & rhs) = delete;
+
+    /**
+    * @brief Stop and join all of the worker threads.
+    */
+    ~ThreadPool();
+
+    /**
+    * @brief Get the number of threads used by this pool (including the
+    * calling thread).
+    *
+    * @return The number of threads.
+    */
+    size_t numThreads() const noexcept;
+
+    /**
+    * @brief Split the range [0, num) into one contiguous chunk per thread and
+    * call the function on each chunk, returning once all chunks are complete.
+    * The chunk boundaries depend only on the range and the number of threads.
+    * If the function throws, the first exception is re-thrown in the calling
+    * thread. Calls made from several threads at once are run one after
+    * another. This must not be called from within the function itself.
+    *
+    * @param num The size of the range.
+    * @param func The function to call on each chunk.
+    */
+    void parallelFor(
+        size_t num,
+        range_function const & func);
+
+  private:
+    std::vector<std::thread> m_threads;
+    // held for the whole of each parallelFor(), as the workers share the
+    // state of a single range
+    std::mutex m_call;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_finish;
+    range_function const * m_func;
+    size_t m_num;
+    size_t m_round;
+    size_t m_remaining;
+    std::exception_ptr m_error;
+    bool m_shutdown;
+
+    /**
+    * @brief The loop run by each worker thread.
+    *
+    * @param threadId The id of the thread (1 to numThreads-1).
+    */
+    void work(
+        size_t threadId);
+
+    /**
+    * @brief Run the chunk of the current range belonging to the given thread.
+    *
+    * @param threadId The id of the thread.
+    */
+    void runChunk(
+        size_t threadId);
+};
+
+}
+
+#endif
@@ -0,0 +1,298 @@
+/**
+* @file Vector3DArray.hpp
+* @brief The Vector3DArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_VECTOR3DARRAY_HPP
+#define GRAVITREE_VECTOR3DARRAY_HPP
+
+#include "Vector3D.hpp"
+#include "CompactVector3D.hpp"
+
+#include <vector>
+#include <cstddef>
+
+namespace gravitree
+{
+
+/**
+* @brief A structure-of-arrays store of three dimensional vectors. Each
+* component is kept in its own dense array, so that the element-wise
+* operations below are simple loops over contiguous doubles which the
+* compiler can vectorize, and which move 24 bytes per vector rather than
+* the 32 of an array of Vector3D.
+*
+* The element-wise operations with another array require both to be of the
+* same size, and throw std::invalid_argument otherwise.
+*/
+class Vector3DArray
+{
+  public:
+    /**
+    * @brief Create a new array of zero vectors.
+    *
+    * @param size The number of vectors.
+    */
+    Vector3DArray(
+        size_t size = 0);
+
+    /**
+    * @brief Get the number of vectors.
+    *
+    * @return The number of vectors.
+    */
+    size_t size() const noexcept;
+
+    /**
+    * @brief Change the number of vectors. New vectors are zero.
+    *
+    * @param size The new number of vectors.
+    */
+    void resize(
+        size_t size);
+
+    /**
+    * @brief Remove all vectors, keeping the allocated capacity.
+    */
+    void clear() noexcept;
+
+    /**
+    * @brief Add a vector to the end of the array.
+    *
+    * @param vec The vector.
+    */
+    void add(
+        Vector3D const & vec);
+
+    /**
+    * @brief Add a vector to the end of the array.
+    *
+    * @param vec The vector.
+    */
+    void add(
+        CompactVector3D const & vec);
+
+    /**
+    * @brief Get a vector.
+    *
+    * @param index The index of the vector.
+    *
+    * @return The vector.
+    */
+    Vector3D get(
+        size_t index) const noexcept;
+
+    /**
+    * @brief Set a vector.
+    *
+    * @param index The index of the vector.
+    * @param vec The new value.
+    */
+    void set(
+        size_t index,
+        Vector3D const & vec) noexcept;
+
+    /**
+    * @brief Get the x components.
+    *
+    * @return The x components.
+    */
+    double const * x() const noexcept;
+
+    /**
+    * @brief Get the y components.
+    *
+    * @return The y components.
+    */
+    double const * y() const noexcept;
+
+    /**
+    * @brief Get the z components.
+    *
+    * @return The z components.
+    */
+    double const * z() const noexcept;
+
+    /**
+    * @brief Get the x components for modification.
+    *
+    * @return The x components.
+    */
+    double * x() noexcept;
+
+    /**
+    * @brief Get the y components for modification.
+    *
+    * @return The y components.
+    */
+    double * y() noexcept;
+
+    /**
+    * @brief Get the z components for modification.
+    *
+    * @return The z components.
+    */
+    double * z() noexcept;
+
+    /**
+    * @brief Add each vector of another array to the vector at the same index.
+    *
+    * @param other The other array.
+    *
+    * @return This array.
+    */
+    Vector3DArray & operator+=(
+        Vector3DArray const & other);
+
+    /**
+    * @brief Subtract each vector of another array from the vector at the
+    * same index.
+    *
+    * @param other The other array.
+    *
+    * @return This array.
+    */
+    Vector3DArray & operator-=(
+        Vector3DArray const & other);
+
+    /**
+    * @brief Add a vector to every vector of this array.
+    *
+    * @param vec The vector to add.
+    *
+    * @return This array.
+    */
+    Vector3DArray & operator+=(
+        Vector3D const & vec) noexcept;
+
+    /**
+    * @brief Subtract a vector from every vector of this array.
+    *
+    * @param vec The vector to subtract.
+    *
+    * @return This array.
+    */
+    Vector3DArray & operator-=(
+        Vector3D const & vec) noexcept;
+
+    /**
+    * @brief Scale every vector of this array.
+    *
+    * @param scalar The value to scale by.
+    *
+    * @return This array.
+    */
+    Vector3DArray & operator*=(
+        double scalar) noexcept;
+
+    /**
+    * @brief Scale each vector by the value at the same index (e.g., to turn
+    * unit directions into accelerations).
+    *
+    * @param scalars The value for each vector (of length size()).
+    */
+    void scale(
+        double const * scalars) noexcept;
+
+    /**
+    * @brief Add a scaled array to this one: v[i] += a*u[i] (e.g., to step
+    * positions by velocities).
+    *
+    * @param scalar The value to scale the other array by (a).
+    * @param other The other array (u).
+    */
+    void addScaled(
+        double scalar,
+        Vector3DArray const & other);
+
+    /**
+    * @brief Get the dot product of each vector with the vector at the same
+    * index of another array.
+    *
+    * @param other The other array.
+    * @param products The dot products (output, of length size()).
+    */
+    void dot(
+        Vector3DArray const & other,
+        double * products) const;
+
+    /**
+    * @brief Get the cross product of each vector with the vector at the same
+    * index of another array.
+    *
+    * @param other The other array.
+    * @param products The cross products (output). It is resized to size().
+    */
+    void cross(
+        Vector3DArray const & other,
+        Vector3DArray * products) const;
+
+    /**
+    * @brief Get the square of the magnitude of each vector.
+    *
+    * @param magnitudes The squares of the magnitudes (output, of length
+    * size()).
+    */
+    void magnitude2(
+        double * magnitudes) const noexcept;
+
+    /**
+    * @brief Get the magnitude of each vector.
+    *
+    * @param magnitudes The magnitudes (output, of length size()).
+    */
+    void magnitude(
+        double * magnitudes) const noexcept;
+
+    /**
+    * @brief Get the distance between each vector and the vector at the same
+    * index of another array.
+    *
+    * @param other The other array.
+    * @param distances The distances (output, of length size()).
+    */
+    void distance(
+        Vector3DArray const & other,
+        double * distances) const;
+
+    /**
+    * @brief Get the distance between each vector and a single point.
+    *
+    * @param point The point.
+    * @param distances The distances (output, of length size()).
+    */
+    void distance(
+        Vector3D const & point,
+        double * distances) const noexcept;
+
+    /**
+    * @brief Scale each vector to unit length. Zero vectors become invalid,
+    * as with Vector3D::normalized().
+    */
+    void normalize() noexcept;
+
+  private:
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+
+    /**
+    * @brief Check that another array is of the same size as this one.
+    *
+    * @param other The other array.
+    *
+    * @throws std::invalid_argument If the sizes differ.
+    */
+    void checkSize(
+        Vector3DArray const & other) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,222 @@
+/**
+* @file Vector3F.hpp
+* @brief The Vector3F class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_VECTOR3F_HPP
+#define GRAVITREE_VECTOR3F_HPP
+
+#include "Vector3D.hpp"
+
+#include <cmath>
+
+namespace gravitree
+{
+
+/**
+* @brief A single precision three dimensional vector, for positions which are
+* only needed to about seven significant digits (e.g., for rendering). Unlike
+* Vector3D it does not cache its length, so that it occupies only 12 bytes
+* and arrays of it can be processed at twice the width.
+*/
+class Vector3F
+{
+  public:
+    /**
+    * @brief A new three dimensional vector.
+    *
+    * @param x The x dimension.
+    * @param y The y dimension.
+    * @param z The z dimension.
+    */
+    Vector3F(
+        float const x=0.0f,
+        float const y=0.0f,
+        float const z=0.0f) noexcept :
+      m_x(x),
+      m_y(y),
+      m_z(z)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Create a new vector by rounding a double precision vector.
+    *
+    * @param vec The double precision vector.
+    */
+    explicit Vector3F(
+        Vector3D const & vec) noexcept :
+      m_x(static_cast<float>(vec.x())),
+      m_y(static_cast<float>(vec.y())),
+      m_z(static_cast<float>(vec.z()))
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component.
+    *
+    * @return The x component.
+    */
+    inline float x() const noexcept
+    {
+      return m_x;
+    }
+
+    /**
+    * @brief Get the y component.
+    *
+    * @return The y component.
+    */
+    inline float y() const noexcept
+    {
+      return m_y;
+    }
+
+    /**
+    * @brief Get the z component.
+    *
+    * @return The z component.
+    */
+    inline float z() const noexcept
+    {
+      return m_z;
+    }
+
+    /**
+    * @brief Get this vector in double precision.
+    *
+    * @return The double precision vector.
+    */
+    inline Vector3D toVector3D() const noexcept
+    {
+      return Vector3D(m_x, m_y, m_z);
+    }
+
+    /**
+    * @brief Get the distance between this and another vector.
+    *
+    * @param other The other vector.
+    *
+    * @return The distance.
+    */
+    inline float distance(
+        Vector3F const & other) const noexcept
+    {
+      return (*this - other).magnitude();
+    }
+
+    /**
+    * @brief Perform the dot product between this vector and another.
+    *
+    * @param other The other vector.
+    *
+    * @return The result.
+    */
+    inline float operator*(
+        Vector3F const & other) const noexcept
+    {
+      return m_x*other.m_x + m_y*other.m_y + m_z*other.m_z;
+    }
+
+    /**
+    * @brief Scale this vector (v) and get the result: a*v.
+    *
+    * @param scalar The scalar (a).
+    *
+    * @return The result (av).
+    */
+    inline Vector3F operator*(
+        float const scalar) const noexcept
+    {
+      return Vector3F(m_x*scalar, m_y*scalar, m_z*scalar);
+    }
+
+    /**
+    * @brief Add two vector together and return the result.
+    *
+    * @param other The other vector to add.
+    *
+    * @return The addition of the two vectors.
+    */
+    inline Vector3F operator+(
+        Vector3F const & other) const noexcept
+    {
+      return Vector3F(m_x+other.m_x, m_y+other.m_y, m_z+other.m_z);
+    }
+
+    /**
+    * @brief Subtract a vector from this one.
+    *
+    * @param other The other vector to subtract.
+    *
+    * @return The difference of the two vectors.
+    */
+    inline Vector3F operator-(
+        Vector3F const & other) const noexcept
+    {
+      return Vector3F(m_x-other.m_x, m_y-other.m_y, m_z-other.m_z);
+    }
+
+    /**
+    * @brief Get the square of the magnitude of this vector.
+    *
+    * @return The square of the magnitude.
+    */
+    inline float magnitude2() const noexcept
+    {
+      return m_x*m_x + m_y*m_y + m_z*m_z;
+    }
+
+    /**
+    * @brief Return the magnitude of this vector.
+    *
+    * @return The magnitude.
+    */
+    inline float magnitude() const noexcept
+    {
+      return std::sqrt(magnitude2());
+    }
+
+    /**
+    * @brief Check if this vector is equal to another.
+    *
+    * @param other The vector to test for equality.
+    *
+    * @return True if the vectors are equal.
+    */
+    inline bool operator==(
+        Vector3F const & other) const noexcept
+    {
+      return m_x == other.m_x && m_y == other.m_y && m_z == other.m_z;
+    }
+
+    /**
+    * @brief Check if this vector is not equal to another.
+    *
+    * @param other The vector to test against.
+    *
+    * @return True if the vectors are not equal.
+    */
+    inline bool operator!=(
+        Vector3F const & other) const noexcept
+    {
+      return !this->operator==(other);
+    }
+
+  private:
+    float m_x;
+    float m_y;
+    float m_z;
+};
+
+}
+
+#endif
@@ -0,0 +1,721 @@
+/**
+* @file VectorExpression.hpp
+* @brief Expression templates for Vector3D arithmetic.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+
+#ifndef GRAVITREE_VECTOREXPRESSION_HPP
+#define GRAVITREE_VECTOREXPRESSION_HPP
+
+#include "Vector3D.hpp"
+
+namespace gravitree
+{
+
+/**
+* @brief The base of a lazily evaluated vector expression. Each arithmetic
+* operation on Vector3D creates a complete vector, including the square of
+* its length, so a compound expression such as (p*x + q*y) computes lengths
+* which are only thrown away. Wrapping the operands with lazy() instead
+* builds the expression as a tree of these types, which evaluate() turns
+* into a single Vector3D, computing each component in one pass and the
+* length only once.
+*
+* The leaves of an expression refer to their vectors rather than copying
+* them, so an expression must be evaluated before the vectors it refers to
+* go out of scope (i.e., it should not be stored).
+*
+* @tparam E The type of expression.
+*/
+template<typename E>
+class VectorExpression
+{
+  public:
+    /**
+    * @brief Get the x component of the expression.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return static_cast<E const &>(*this).x();
+    }
+
+    /**
+    * @brief Get the y component of the expression.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return static_cast<E const &>(*this).y();
+    }
+
+    /**
+    * @brief Get the z component of the expression.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return static_cast<E const &>(*this).z();
+    }
+};
+
+
+/**
+* @brief A vector in an expression.
+*/
+class VectorLeaf : public VectorExpression<VectorLeaf>
+{
+  public:
+    /**
+    * @brief Refer to a vector.
+    *
+    * @param vec The vector.
+    */
+    explicit VectorLeaf(
+        Vector3D const & vec) noexcept :
+      m_vec(vec)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component of the vector.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_vec.x();
+    }
+
+    /**
+    * @brief Get the y component of the vector.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_vec.y();
+    }
+
+    /**
+    * @brief Get the z component of the vector.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_vec.z();
+    }
+
+  private:
+    Vector3D const & m_vec;
+};
+
+
+/**
+* @brief The sum of two expressions.
+*
+* @tparam L The type of the left expression.
+* @tparam R The type of the right expression.
+*/
+template<typename L, typename R>
+class VectorSum : public VectorExpression<VectorSum<L, R>>
+{
+  public:
+    /**
+    * @brief Combine two expressions.
+    *
+    * @param left The left expression.
+    * @param right The right expression.
+    */
+    VectorSum(
+        L const & left,
+        R const & right) noexcept :
+      m_left(left),
+      m_right(right)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component of the sum.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_left.x() + m_right.x();
+    }
+
+    /**
+    * @brief Get the y component of the sum.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_left.y() + m_right.y();
+    }
+
+    /**
+    * @brief Get the z component of the sum.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_left.z() + m_right.z();
+    }
+
+  private:
+    L m_left;
+    R m_right;
+};
+
+
+/**
+* @brief The difference of two expressions.
+*
+* @tparam L The type of the left expression.
+* @tparam R The type of the right expression.
+*/
+template<typename L, typename R>
+class VectorDifference : public VectorExpression<VectorDifference<L, R>>
+{
+  public:
+    /**
+    * @brief Combine two expressions.
+    *
+    * @param left The left expression.
+    * @param right The right expression.
+    */
+    VectorDifference(
+        L const & left,
+        R const & right) noexcept :
+      m_left(left),
+      m_right(right)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component of the difference.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_left.x() - m_right.x();
+    }
+
+    /**
+    * @brief Get the y component of the difference.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_left.y() - m_right.y();
+    }
+
+    /**
+    * @brief Get the z component of the difference.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_left.z() - m_right.z();
+    }
+
+  private:
+    L m_left;
+    R m_right;
+};
+
+
+/**
+* @brief An expression multiplied by a scalar.
+*
+* @tparam E The type of the expression.
+*/
+template<typename E>
+class VectorProduct : public VectorExpression<VectorProduct<E>>
+{
+  public:
+    /**
+    * @brief Scale an expression.
+    *
+    * @param expr The expression.
+    * @param scalar The scalar.
+    */
+    VectorProduct(
+        E const & expr,
+        double const scalar) noexcept :
+      m_expr(expr),
+      m_scalar(scalar)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component of the product.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_expr.x() * m_scalar;
+    }
+
+    /**
+    * @brief Get the y component of the product.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_expr.y() * m_scalar;
+    }
+
+    /**
+    * @brief Get the z component of the product.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_expr.z() * m_scalar;
+    }
+
+  private:
+    E m_expr;
+    double m_scalar;
+};
+
+
+/**
+* @brief An expression divided by a scalar. Each component is divided, as
+* with Vector3D::operator/(), so that the results are the same.
+*
+* @tparam E The type of the expression.
+*/
+template<typename E>
+class VectorQuotient : public VectorExpression<VectorQuotient<E>>
+{
+  public:
+    /**
+    * @brief Divide an expression.
+    *
+    * @param expr The expression.
+    * @param scalar The divisor.
+    */
+    VectorQuotient(
+        E const & expr,
+        double const scalar) noexcept :
+      m_expr(expr),
+      m_scalar(scalar)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component of the quotient.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_expr.x() / m_scalar;
+    }
+
+    /**
+    * @brief Get the y component of the quotient.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_expr.y() / m_scalar;
+    }
+
+    /**
+    * @brief Get the z component of the quotient.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_expr.z() / m_scalar;
+    }
+
+  private:
+    E m_expr;
+    double m_scalar;
+};
+
+
+/**
+* @brief The negation of an expression.
+*
+* @tparam E The type of the expression.
+*/
+template<typename E>
+class VectorNegation : public VectorExpression<VectorNegation<E>>
+{
+  public:
+    /**
+    * @brief Negate an expression.
+    *
+    * @param expr The expression.
+    */
+    explicit VectorNegation(
+        E const & expr) noexcept :
+      m_expr(expr)
+    {
+      // do nothing
+    }
+
+    /**
+    * @brief Get the x component of the negation.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return -m_expr.x();
+    }
+
+    /**
+    * @brief Get the y component of the negation.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return -m_expr.y();
+    }
+
+    /**
+    * @brief Get the z component of the negation.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return -m_expr.z();
+    }
+
+  private:
+    E m_expr;
+};
+
+
+/**
+* @brief The cross product of two expressions. Each component of a cross
+* product needs two components of each operand, so the operands are
+* evaluated (without their lengths) when the product is created rather than
+* once per use.
+*/
+class VectorCross : public VectorExpression<VectorCross>
+{
+  public:
+    /**
+    * @brief Evaluate the cross product of two expressions.
+    *
+    * @tparam L The type of the left expression.
+    * @tparam R The type of the right expression.
+    * @param left The left expression.
+    * @param right The right expression.
+    */
+    template<typename L, typename R>
+    VectorCross(
+        VectorExpression<L> const & left,
+        VectorExpression<R> const & right) noexcept :
+      m_x(0.0),
+      m_y(0.0),
+      m_z(0.0)
+    {
+      double const lx = left.x();
+      double const ly = left.y();
+      double const lz = left.z();
+      double const rx = right.x();
+      double const ry = right.y();
+      double const rz = right.z();
+      m_x = ly*rz - lz*ry;
+      m_y = lz*rx - lx*rz;
+      m_z = lx*ry - ly*rx;
+    }
+
+    /**
+    * @brief Get the x component of the cross product.
+    *
+    * @return The x component.
+    */
+    inline double x() const noexcept
+    {
+      return m_x;
+    }
+
+    /**
+    * @brief Get the y component of the cross product.
+    *
+    * @return The y component.
+    */
+    inline double y() const noexcept
+    {
+      return m_y;
+    }
+
+    /**
+    * @brief Get the z component of the cross product.
+    *
+    * @return The z component.
+    */
+    inline double z() const noexcept
+    {
+      return m_z;
+    }
+
+  private:
+    double m_x;
+    double m_y;
+    double m_z;
+};
+
+
+/**
+* @brief Start a lazily evaluated expression from a vector.
+*
+* @param vec The vector.
+*
+* @return The expression.
+*/
+inline VectorLeaf lazy(
+    Vector3D const & vec) noexcept
+{
+  return VectorLeaf(vec);
+}
+
+/**
+* @brief Evaluate an expression into a vector, computing its length once.
+*
+* @tparam E The type of the expression.
+* @param expr The expression.
+*
+* @return The vector.
+*/
+template<typename E>
+inline Vector3D evaluate(
+    VectorExpression<E> const & expr) noexcept
+{
+  return Vector3D(expr.x(), expr.y(), expr.z());
+}
+
+/**
+* @brief Add two expressions.
+*
+* @tparam L The type of the left expression.
+* @tparam R The type of the right expression.
+* @param left The left expression.
+* @param right The right expression.
+*
+* @return The sum.
+*/
+template<typename L, typename R>
+inline VectorSum<L, R> operator+(
+    VectorExpression<L> const & left,
+    VectorExpression<R> const & right) noexcept
+{
+  return VectorSum<L, R>(static_cast<L const &>(left), \
+      static_cast<R const &>(right));
+}
+
+/**
+* @brief Add a vector to an expression.
+*
+* @tparam L The type of the expression.
+* @param left The expression.
+* @param right The vector.
+*
+* @return The sum.
+*/
+template<typename L>
+inline VectorSum<L, VectorLeaf> operator+(
+    VectorExpression<L> const & left,
+    Vector3D const & right) noexcept
+{
+  return VectorSum<L, VectorLeaf>(static_cast<L const &>(left), \
+      VectorLeaf(right));
+}
+
+/**
+* @brief Add an expression to a vector.
+*
+* @tparam R The type of the expression.
+* @param left The vector.
+* @param right The expression.
+*
+* @return The sum.
+*/
+template<typename R>
+inline VectorSum<VectorLeaf, R> operator+(
+    Vector3D const & left,
+    VectorExpression<R> const & right) noexcept
+{
+  return VectorSum<VectorLeaf, R>(VectorLeaf(left), \
+      static_cast<R const &>(right));
+}
+
+/**
+* @brief Subtract one expression from another.
+*
+* @tparam L The type of the left expression.
+* @tparam R The type of the right expression.
+* @param left The left expression.
+* @param right The right expression.
+*
+* @return The difference.
+*/
+template<typename L, typename R>
+inline VectorDifference<L, R> operator-(
+    VectorExpression<L> const & left,
+    VectorExpression<R> const & right) noexcept
+{
+  return VectorDifference<L, R>(static_cast<L const &>(left), \
+      static_cast<R const &>(right));
+}
+
+/**
+* @brief Subtract a vector from an expression.
+*
+* @tparam L The type of the expression.
+* @param left The expression.
+* @param right The vector.
+*
+* @return The difference.
+*/
+template<typename L>
+inline VectorDifference<L, VectorLeaf> operator-(
+    VectorExpression<L> const & left,
+    Vector3D const & right) noexcept
+{
+  return VectorDifference<L, VectorLeaf>(static_cast<L const &>(left), \
+      VectorLeaf(right));
+}
+
+/**
+* @brief Subtract an expression from a vector.
+*
+* @tparam R The type of the expression.
+* @param left The vector.
+* @param right The expression.
+*
+* @return The difference.
+*/
+template<typename R>
+inline VectorDifference<VectorLeaf, R> operator-(
+    Vector3D const & left,
+    VectorExpression<R> const & right) noexcept
+{
+  return VectorDifference<VectorLeaf, R>(VectorLeaf(left), \
+      static_cast<R const &>(right));
+}
+
+/**
+* @brief Multiply an expression by a scalar.
+*
+* @tparam E The type of the expression.
+* @param expr The expression.
+* @param scalar The scalar.
+*
+* @return The product.
+*/
+template<typename E>
+inline VectorProduct<E> operator*(
+    VectorExpression<E> const & expr,
+    double const scalar) noexcept
+{
+  return VectorProduct<E>(static_cast<E const &>(expr), scalar);
+}
+
+/**
+* @brief Divide an expression by a scalar.
+*
+* @tparam E The type of the expression.
+* @param expr The expression.
+* @param scalar The divisor.
+*
+* @return The quotient.
+*/
+template<typename E>
+inline VectorQuotient<E> operator/(
+    VectorExpression<E> const & expr,
+    double const scalar) noexcept
+{
+  return VectorQuotient<E>(static_cast<E const &>(expr), scalar);
+}
+
+/**
+* @brief Negate an expression.
+*
+* @tparam E The type of the expression.
+* @param expr The expression.
+*
+* @return The negation.
+*/
+template<typename E>
+inline VectorNegation<E> operator-(
+    VectorExpression<E> const & expr) noexcept
+{
+  return VectorNegation<E>(static_cast<E const &>(expr));
+}
+
+/**
+* @brief Get the cross product of two expressions.
+*
+* @tparam L The type of the left expression.
+* @tparam R The type of the right expression.
+* @param left The left expression.
+* @param right The right expression.
+*
+* @return The cross product.
+*/
+template<typename L, typename R>
+inline VectorCross cross(
+    VectorExpression<L> const & left,
+    VectorExpression<R> const & right) noexcept
+{
+  return VectorCross(left, right);
+}
+
+/**
+* @brief Get the dot product of two expressions.
+*
+* @tparam L The type of the left expression.
+* @tparam R The type of the right expression.
+* @param left The left expression.
+* @param right The right expression.
+*
+* @return The dot product.
+*/
+template<typename L, typename R>
+inline double dot(
+    VectorExpression<L> const & left,
+    VectorExpression<R> const & right) noexcept
+{
+  return left.x()*right.x() + left.y()*right.y() + left.z()*right.z();
+}
+
+}
+
+#endif
@@ -11,9 +11,16 @@
 #define GRAVITREE_HPP
 
 #include "SolarSystem.hpp"
+#include "BodyHandle.hpp"
 #include "Body.hpp"
+#include "Catalog.hpp"
+#include "CatalogBody.hpp"
+#include "CatalogOrbits.hpp"
+#include "Ephemeris.hpp"
 #include "OrbitalState.hpp"
 #include "KeplerOrbit.hpp"
+#include "Quaternion.hpp"
+#include "Matrix3D.hpp"
 
 // make the names space of usable size
 namespace gt = gravitree;
@@ -0,0 +1,213 @@
+/**
+* @file AncestorIndex.cpp
+* @brief Implementation of the AncestorIndex class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-20
+*/
+
+#include "AncestorIndex.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace gravitree
+{
+
+constexpr size_t const AncestorIndex::NO_PARENT;
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+AncestorIndex::AncestorIndex() :
+  m_jumps(1),
+  m_depths(),
+  m_parents(),
+  m_stale(false)
+{
+  // do nothing
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+void AncestorIndex::add(
+    size_t const slot,
+    size_t const parent)
+{
+  assert(parent == NO_PARENT || parent < m_parents.size());
+
+  if (slot >= m_parents.size()) {
+    m_parents.resize(slot+1, NO_PARENT);
+    m_depths.resize(slot+1, 0);
+    for (std::vector<size_t> & jumps : m_jumps) {
+      jumps.resize(slot+1, NO_PARENT);
+    }
+  }
+
+  m_parents[slot] = parent;
+
+  if (!m_stale) {
+    size_t const depth = parent == NO_PARENT ? 0 : m_depths[parent] + 1;
+    if ((depth >> m_jumps.size()) > 0) {
+      // need another level of jumps
+      m_stale = true;
+    } else {
+      link(slot);
+    }
+  }
+}
+
+void AncestorIndex::remove(
+    size_t const slot) noexcept
+{
+  m_parents[slot] = NO_PARENT;
+  if (!m_stale) {
+    link(slot);
+  }
+}
+
+void AncestorIndex::setParent(
+    size_t const slot,
+    size_t const parent) noexcept
+{
+  // the depths of the whole subtree change
+  m_parents[slot] = parent;
+  m_stale = true;
+}
+
+size_t AncestorIndex::parent(
+    size_t const slot) const noexcept
+{
+  return m_parents[slot];
+}
+
+size_t AncestorIndex::depth(
+    size_t const slot) const
+{
+  update();
+
+  return m_depths[slot];
+}
+
+size_t AncestorIndex::lowestCommonAncestor(
+    size_t a,
+    size_t b) const
+{
+  update();
+
+  if (m_depths[a] < m_depths[b]) {
+    std::swap(a, b);
+  }
+
+  // lift a to the depth of b
+  size_t diff = m_depths[a] - m_depths[b];
+  for (size_t k = 0; diff > 0; ++k, diff >>= 1) {
+    if (diff & 1) {
+      a = m_jumps[k][a];
+    }
+  }
+
+  if (a == b) {
+    return a;
+  }
+
+  // lift both to just below their common ancestor
+  for (size_t k = m_jumps.size(); k > 0; --k) {
+    std::vector<size_t> const & jumps = m_jumps[k-1];
+    if (jumps[a] != jumps[b]) {
+      a = jumps[a];
+      b = jumps[b];
+    }
+  }
+
+  a = m_jumps[0][a];
+  b = m_jumps[0][b];
+
+  return a == b ? a : NO_PARENT;
+}
+
+void AncestorIndex::update() const
+{
+  if (!m_stale) {
+    return;
+  }
+
+  size_t const numSlots = m_parents.size();
+  size_t const unknown = NO_PARENT;
+
+  // find the depth of every slot, walking up only until a slot of known depth
+  std::fill(m_depths.begin(), m_depths.end(), unknown);
+  size_t maxDepth = 0;
+  for (size_t slot = 0; slot < numSlots; ++slot) {
+    size_t steps = 0;
+    size_t top = slot;
+    while (top != NO_PARENT && m_depths[top] == unknown) {
+      top = m_parents[top];
+      ++steps;
+    }
+
+    if (steps == 0) {
+      continue;
+    }
+
+    size_t depth = top == NO_PARENT ? steps - 1 : m_depths[top] + steps;
+    maxDepth = std::max(maxDepth, depth);
+    for (size_t node = slot; node != top; node = m_parents[node]) {
+      m_depths[node] = depth--;
+    }
+  }
+
+  // enough levels that any depth difference can be lifted
+  size_t numLevels = 1;
+  while ((maxDepth >> numLevels) > 0) {
+    ++numLevels;
+  }
+  m_jumps.resize(numLevels);
+
+  std::vector<size_t> & parents = m_jumps[0];
+  parents.resize(numSlots);
+  for (size_t slot = 0; slot < numSlots; ++slot) {
+    parents[slot] = m_parents[slot] == NO_PARENT ? slot : m_parents[slot];
+  }
+  for (size_t k = 1; k < numLevels; ++k) {
+    std::vector<size_t> const & prev = m_jumps[k-1];
+    std::vector<size_t> & jumps = m_jumps[k];
+    jumps.resize(numSlots);
+    for (size_t slot = 0; slot < numSlots; ++slot) {
+      jumps[slot] = prev[prev[slot]];
+    }
+  }
+
+  m_stale = false;
+}
+
+
+/******************************************************************************
+* PRIVATE METHODS *************************************************************
+******************************************************************************/
+
+void AncestorIndex::link(
+    size_t const slot) const noexcept
+{
+  size_t const parent = m_parents[slot];
+  if (parent == NO_PARENT) {
+    m_depths[slot] = 0;
+    for (std::vector<size_t> & jumps : m_jumps) {
+      jumps[slot] = slot;
+    }
+  } else {
+    m_depths[slot] = m_depths[parent] + 1;
+    m_jumps[0][slot] = parent;
+    for (size_t k = 1; k < m_jumps.size(); ++k) {
+      m_jumps[k][slot] = m_jumps[k-1][m_jumps[k-1][slot]];
+    }
+  }
+}
+
+}
@@ -0,0 +1,465 @@
+/**
+* @file Anomally.cpp
+* @brief Implementation of the Anomally class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-14
+*/
+
+#include "Anomally.hpp"
+#include "Constants.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+namespace gravitree
+{
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+namespace
+{
+
+// the largest first step from a guess which is taken without falling back to
+// solving from scratch, within which the series below are exact to double
+// precision
+constexpr double const WARM_LIMIT = 0.1;
+
+// the most Halley steps taken from a guess, before falling back to solving
+// from scratch
+constexpr int const WARM_ITERATIONS = 3;
+
+// a step small enough that the next step would be below rounding error
+constexpr double const WARM_CONVERGED = 1.0e-6;
+
+}
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+namespace
+{
+
+/**
+* @brief Solve Kepler's equation for a mean anomally in [-pi, pi] with
+* Markley's method: a cubic starter accurate to about 1e-4 radians, followed
+* by a single fifth order Householder correction, giving a solution accurate
+* to a few ulp for all 0 <= e < 1. There are no loops or branches, so it
+* costs the same for every orbit.
+*
+* A. Markley, "Kepler Equation Solver", Celestial Mechanics and Dynamical
+* Astronomy, 63 (1995), 101-111.
+*
+* @param mean The mean anomally in [-pi, pi].
+* @param e The eccentricity.
+*
+* @return The eccentric anomally.
+*/
+inline double markley(
+    double const mean,
+    double const e) noexcept
+{
+  double const pi = Constants::PI;
+  double const pi2 = pi * pi;
+
+  // starter
+  double const alpha = (3.0*pi2 + 1.6*pi*(pi - std::abs(mean))/(1.0 + e)) / \
+      (pi2 - 6.0);
+  double const d = 3.0*(1.0 - e) + alpha*e;
+  double const q = 2.0*alpha*d*(1.0 - e) - mean*mean;
+  double const r = 3.0*alpha*d*(d - 1.0 + e)*mean + mean*mean*mean;
+  double const w = std::cbrt(std::abs(r) + std::sqrt(q*q*q + r*r));
+  double const w2 = w * w;
+  double const start = (2.0*r*w2/(w2*w2 + w2*q + q*q) + mean) / d;
+
+  // correction
+  double const f2 = e * std::sin(start);
+  double const f3 = e * std::cos(start);
+  double const f0 = start - f2 - mean;
+  double const f1 = 1.0 - f3;
+  double const d3 = -f0 / (f1 - 0.5*f0*f2/f1);
+  double const d4 = -f0 / (f1 + 0.5*d3*f2 + d3*d3*f3/6.0);
+  double const d5 = -f0 / (f1 + 0.5*d4*f2 + d4*d4*f3/6.0 - \
+      d4*d4*d4*f2/24.0);
+
+  return start + d5;
+}
+
+/**
+* @brief Solve Kepler's equation for any mean anomally, keeping the number
+* of whole orbits it contains.
+*
+* @param mean The mean anomally.
+* @param e The eccentricity.
+*
+* @return The eccentric anomally.
+*/
+inline double solveKepler(
+    double const mean,
+    double const e) noexcept
+{
+  double const tau = 2.0 * Constants::PI;
+  double const turns = std::floor((mean + Constants::PI) / tau);
+  return markley(mean - turns*tau, e) + turns*tau;
+}
+
+/**
+* @brief Evaluate sinh(H) - H without the cancellation suffered near zero, by
+* using the series of the Stumpff function for small H:
+*
+* \f[
+*    \sinh H - H = H^3 S(-H^2) = \frac{H^3}{3!} + \frac{H^5}{5!} + \ldots
+* \f]
+*
+* Both forms are evaluated and one selected, so that it does not branch.
+*
+* @param H The hyperbolic anomally.
+*
+* @return The value of sinh(H) - H.
+*/
+inline double sinhMinus(
+    double const H) noexcept
+{
+  double const h2 = H * H;
+  double const series = H*h2/6.0*(1.0 + h2/20.0*(1.0 + h2/42.0*(1.0 + \
+      h2/72.0*(1.0 + h2/110.0*(1.0 + h2/156.0*(1.0 + h2/210.0))))));
+  double const direct = std::sinh(H) - H;
+
+  return std::abs(H) < 0.5 ? series : direct;
+}
+
+/**
+* @brief Solve the hyperbolic form of Kepler's equation, written as
+*
+* \f[
+*    e (\sinh H - H) + (e - 1) H = M
+* \f]
+*
+* so that it stays well conditioned as e approaches one. The better of two
+* starters is refined with a fixed three Halley steps: the root of the cubic
+* from the leading terms of the series (accurate for small H and near
+* parabolic orbits), and a lower bound from the logarithmic growth of sinh
+* (accurate for large H). This gives a relative residual of a few ulp for
+* 1 < e <= 1e4 and |M| up to 1e8.
+*
+* @param mean The mean anomally.
+* @param e The eccentricity.
+*
+* @return The hyperbolic anomally.
+*/
+inline double solveHyperbolic(
+    double const mean,
+    double const e) noexcept
+{
+  double const m = std::abs(mean);
+
+  // H^3 + pH - q = 0
+  double const p = 6.0*(e - 1.0)/e;
+  double const q = 6.0*m/e;
+  double const disc = std::sqrt(0.25*q*q + p*p*p/27.0);
+  double const cubic = std::cbrt(0.5*q + disc) - std::cbrt(disc - 0.5*q);
+  double const bound = std::asinh((m + std::asinh(m/e))/e);
+
+  double const cubicError = e*sinhMinus(cubic) + (e - 1.0)*cubic - m;
+  double const boundError = e*sinhMinus(bound) + (e - 1.0)*bound - m;
+  double H = std::abs(cubicError) < std::abs(boundError) ? cubic : bound;
+
+  for (int i = 0; i < 3; ++i) {
+    double const f0 = e*sinhMinus(H) + (e - 1.0)*H - m;
+    double const f1 = e*std::cosh(H) - 1.0;
+    double const f2 = e*std::sinh(H);
+    H -= f0 / (f1 - 0.5*f0*f2/f1);
+  }
+
+  return std::copysign(H, mean);
+}
+
+/**
+* @brief Solve Kepler's equation near a known solution. With E = guess + d,
+* the sine and cosine of d are evaluated by their series and combined with
+* those of the guess, so the Halley steps need no trigonometric functions.
+*
+* @param mean The mean anomally.
+* @param e The eccentricity.
+* @param guess The eccentric anomally of a nearby mean anomally.
+*
+* @return The eccentric anomally.
+*/
+inline double warmKepler(
+    double const mean,
+    double const e,
+    double const guess) noexcept
+{
+  double const sin_g = std::sin(guess);
+  double const cos_g = std::cos(guess);
+
+  // the change in mean anomally since the guess
+  double const target = mean - (guess - e*sin_g);
+  double delta = target / (1.0 - e*cos_g);
+  if (!(std::abs(delta) <= WARM_LIMIT)) {
+    return solveKepler(mean, e);
+  }
+
+  for (int i = 0; i < WARM_ITERATIONS; ++i) {
+    double const d2 = delta * delta;
+    double const sin_d = delta*(1.0 - d2/6.0*(1.0 - d2/20.0*(1.0 - \
+        d2/42.0*(1.0 - d2/72.0))));
+    double const cosm1_d = -0.5*d2*(1.0 - d2/12.0*(1.0 - d2/30.0*(1.0 - \
+        d2/56.0*(1.0 - d2/90.0))));
+
+    double const f0 = delta - e*(sin_g*cosm1_d + cos_g*sin_d) - target;
+    double const f1 = 1.0 - e*(cos_g*(1.0 + cosm1_d) - sin_g*sin_d);
+    double const f2 = e*(sin_g*(1.0 + cosm1_d) + cos_g*sin_d);
+    double const step = f0 / (f1 - 0.5*f0*f2/f1);
+    delta -= step;
+    if (std::abs(step) < WARM_CONVERGED) {
+      return guess + delta;
+    }
+  }
+
+  // the guess was not close enough
+  return solveKepler(mean, e);
+}
+
+/**
+* @brief Solve the hyperbolic form of Kepler's equation near a known
+* solution, as warmKepler() above, written so that it stays well conditioned
+* as e approaches one.
+*
+* @param mean The mean anomally.
+* @param e The eccentricity.
+* @param guess The hyperbolic anomally of a nearby mean anomally.
+*
+* @return The hyperbolic anomally.
+*/
+inline double warmHyperbolic(
+    double const mean,
+    double const e,
+    double const guess) noexcept
+{
+  double const sinh_g = std::sinh(guess);
+  double const cosh_g = std::cosh(guess);
+
+  // e cosh(H) - 1, without cancellation
+  double const slope = (e - 1.0) + e*sinh_g*sinh_g/(cosh_g + 1.0);
+  double const target = mean - \
+      (e*sinhMinus(guess) + (e - 1.0)*guess);
+  double delta = target / slope;
+  if (!(std::abs(delta) <= WARM_LIMIT)) {
+    return solveHyperbolic(mean, e);
+  }
+
+  for (int i = 0; i < WARM_ITERATIONS; ++i) {
+    double const d2 = delta * delta;
+    // sinh(d) - d and cosh(d) - 1
+    double const sinhm_d = delta*d2/6.0*(1.0 + d2/20.0*(1.0 + \
+        d2/42.0*(1.0 + d2/72.0)));
+    double const coshm1_d = 0.5*d2*(1.0 + d2/12.0*(1.0 + d2/30.0*(1.0 + \
+        d2/56.0*(1.0 + d2/90.0))));
+
+    double const f0 = slope*delta + e*(sinh_g*coshm1_d + cosh_g*sinhm_d) - \
+        target;
+    double const f1 = slope + e*(cosh_g*coshm1_d + sinh_g*(delta + sinhm_d));
+    double const f2 = e*(sinh_g*(1.0 + coshm1_d) + cosh_g*(delta + sinhm_d));
+    double const step = f0 / (f1 - 0.5*f0*f2/f1);
+    delta -= step;
+    if (std::abs(step) < WARM_CONVERGED) {
+      return guess + delta;
+    }
+  }
+
+  // the guess was not close enough
+  return solveHyperbolic(mean, e);
+}
+
+}
+
+
+/******************************************************************************
+* PUBLIC STATIC METHODS *******************************************************
+******************************************************************************/
+
+radian_type Anomally::eccentricFromTrue(
+    radian_type const trueAnomally,
+    double const eccentricity) noexcept
+{
+  // (1-e)(1+e) rather than 1-e^2, which cancels as e approaches one
+  double const num = std::sqrt((1.0-eccentricity) * (1.0+eccentricity)) * \
+      std::sin(trueAnomally);
+  double const den = eccentricity + std::cos(trueAnomally);
+  return std::atan2(num, den);
+}
+
+void Anomally::eccentricFromTrue(
+    radian_type const * const trueAnomallies,
+    double const * const eccentricities,
+    radian_type * const eccentricAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    eccentricAnomallies[i] = eccentricFromTrue(trueAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+radian_type Anomally::meanFromEccentric(
+    radian_type const eccentricAnomally,
+    double const eccentricity) noexcept
+{
+  return eccentricAnomally - eccentricity*std::sin(eccentricAnomally);
+}
+
+void Anomally::meanFromEccentric(
+    radian_type const * const eccentricAnomallies,
+    double const * const eccentricities,
+    radian_type * const meanAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    meanAnomallies[i] = meanFromEccentric(eccentricAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+radian_type Anomally::eccentricFromMean(
+    radian_type const meanAnomally,
+    double const eccentricity) noexcept
+{
+  return solveKepler(meanAnomally, eccentricity);
+}
+
+radian_type Anomally::eccentricFromMean(
+    radian_type const meanAnomally,
+    double const eccentricity,
+    radian_type const guess) noexcept
+{
+  return warmKepler(meanAnomally, eccentricity, guess);
+}
+
+void Anomally::eccentricFromMean(
+    radian_type const * const meanAnomallies,
+    double const * const eccentricities,
+    radian_type * const eccentricAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    eccentricAnomallies[i] = solveKepler(meanAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+radian_type Anomally::hyperbolicFromTrue(
+    radian_type const trueAnomally,
+    double const eccentricity) noexcept
+{
+  double const ratio = std::sqrt((eccentricity-1.0) / (eccentricity+1.0));
+  return 2.0 * std::atanh(ratio * std::tan(trueAnomally*0.5));
+}
+
+void Anomally::hyperbolicFromTrue(
+    radian_type const * const trueAnomallies,
+    double const * const eccentricities,
+    radian_type * const hyperbolicAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    hyperbolicAnomallies[i] = hyperbolicFromTrue(trueAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+radian_type Anomally::meanFromHyperbolic(
+    radian_type const hyperbolicAnomally,
+    double const eccentricity) noexcept
+{
+  return eccentricity*sinhMinus(hyperbolicAnomally) + \
+      (eccentricity-1.0)*hyperbolicAnomally;
+}
+
+void Anomally::meanFromHyperbolic(
+    radian_type const * const hyperbolicAnomallies,
+    double const * const eccentricities,
+    radian_type * const meanAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    meanAnomallies[i] = meanFromHyperbolic(hyperbolicAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+radian_type Anomally::hyperbolicFromMean(
+    radian_type const meanAnomally,
+    double const eccentricity) noexcept
+{
+  return solveHyperbolic(meanAnomally, eccentricity);
+}
+
+radian_type Anomally::hyperbolicFromMean(
+    radian_type const meanAnomally,
+    double const eccentricity,
+    radian_type const guess) noexcept
+{
+  return warmHyperbolic(meanAnomally, eccentricity, guess);
+}
+
+void Anomally::hyperbolicFromMean(
+    radian_type const * const meanAnomallies,
+    double const * const eccentricities,
+    radian_type * const hyperbolicAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    hyperbolicAnomallies[i] = solveHyperbolic(meanAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+radian_type Anomally::trueFromHyperbolic(
+    radian_type const hyperbolicAnomally,
+    double const eccentricity) noexcept
+{
+  double const ratio = std::sqrt((1.0+eccentricity) / (eccentricity-1.0));
+  return 2.0 * std::atan(ratio * std::tanh(hyperbolicAnomally*0.5));
+}
+
+void Anomally::trueFromHyperbolic(
+    radian_type const * const hyperbolicAnomallies,
+    double const * const eccentricities,
+    radian_type * const trueAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    trueAnomallies[i] = trueFromHyperbolic(hyperbolicAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+radian_type Anomally::trueFromEccentric(
+    radian_type const eccentricAnomally,
+    double const eccentricity) noexcept
+{
+  double const e2 = eccentricAnomally*0.5;
+  double const ratio = std::sqrt((1.0+eccentricity) / (1.0-eccentricity));
+
+  return 2.0 * std::atan2(ratio*std::sin(e2), std::cos(e2));
+}
+
+void Anomally::trueFromEccentric(
+    radian_type const * const eccentricAnomallies,
+    double const * const eccentricities,
+    radian_type * const trueAnomallies,
+    size_t const num) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    trueAnomallies[i] = trueFromEccentric(eccentricAnomallies[i], \
+        eccentricities[i]);
+  }
+}
+
+}
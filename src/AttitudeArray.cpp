@@ -0,0 +1,178 @@
+/**
+* @file AttitudeArray.cpp
+* @brief Implementation of the AttitudeArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+#include "AttitudeArray.hpp"
+
+#include <cassert>
+#include <cmath>
+
+namespace gravitree
+{
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+AttitudeArray::AttitudeArray() :
+  m_w(),
+  m_x(),
+  m_y(),
+  m_z(),
+  m_rateX(),
+  m_rateY(),
+  m_rateZ(),
+  m_stepW(),
+  m_stepX(),
+  m_stepY(),
+  m_stepZ(),
+  m_stepSeconds()
+{
+  // do nothing
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+size_t AttitudeArray::size() const noexcept
+{
+  return m_w.size();
+}
+
+void AttitudeArray::add(
+    size_t const slot,
+    Quaternion const & orientation,
+    Rotation const & angularVelocity)
+{
+  if (slot >= size()) {
+    m_w.resize(slot+1, 1.0);
+    m_x.resize(slot+1, 0.0);
+    m_y.resize(slot+1, 0.0);
+    m_z.resize(slot+1, 0.0);
+    m_rateX.resize(slot+1, 0.0);
+    m_rateY.resize(slot+1, 0.0);
+    m_rateZ.resize(slot+1, 0.0);
+    m_stepW.resize(slot+1, 1.0);
+    m_stepX.resize(slot+1, 0.0);
+    m_stepY.resize(slot+1, 0.0);
+    m_stepZ.resize(slot+1, 0.0);
+    m_stepSeconds.resize(slot+1, NAN);
+  }
+
+  setOrientation(slot, orientation);
+  setAngularVelocity(slot, angularVelocity);
+}
+
+void AttitudeArray::remove(
+    size_t const slot) noexcept
+{
+  setOrientation(slot, Quaternion());
+  setAngularVelocity(slot, Rotation());
+}
+
+Quaternion AttitudeArray::orientation(
+    size_t const slot) const noexcept
+{
+  assert(slot < size());
+
+  return Quaternion(m_w[slot], m_x[slot], m_y[slot], m_z[slot]);
+}
+
+void AttitudeArray::setOrientation(
+    size_t const slot,
+    Quaternion const & orientation) noexcept
+{
+  assert(slot < size());
+
+  m_w[slot] = orientation.w();
+  m_x[slot] = orientation.x();
+  m_y[slot] = orientation.y();
+  m_z[slot] = orientation.z();
+}
+
+void AttitudeArray::setAngularVelocity(
+    size_t const slot,
+    Rotation const & angularVelocity) noexcept
+{
+  assert(slot < size());
+
+  Vector3D const axis = angularVelocity.axis();
+  double const length = axis.magnitude();
+  double const scale = length > 0.0 ? angularVelocity.angle() / length : 0.0;
+
+  m_rateX[slot] = axis.x()*scale;
+  m_rateY[slot] = axis.y()*scale;
+  m_rateZ[slot] = axis.z()*scale;
+  m_stepSeconds[slot] = NAN;
+}
+
+void AttitudeArray::propagate(
+    size_t const begin,
+    size_t const end,
+    second_type const seconds) noexcept
+{
+  assert(end <= size());
+
+  // the cached rotations only need to be recomputed when the step changes
+  for (size_t slot = begin; slot < end; ++slot) {
+    if (!(m_stepSeconds[slot] == seconds)) {
+      updateStep(slot, seconds);
+    }
+  }
+
+  double * const w = m_w.data();
+  double * const x = m_x.data();
+  double * const y = m_y.data();
+  double * const z = m_z.data();
+  double const * const sw = m_stepW.data();
+  double const * const sx = m_stepX.data();
+  double const * const sy = m_stepY.data();
+  double const * const sz = m_stepZ.data();
+  for (size_t i = begin; i < end; ++i) {
+    double const qw = sw[i]*w[i] - sx[i]*x[i] - sy[i]*y[i] - sz[i]*z[i];
+    double const qx = sw[i]*x[i] + sx[i]*w[i] + sy[i]*z[i] - sz[i]*y[i];
+    double const qy = sw[i]*y[i] - sx[i]*z[i] + sy[i]*w[i] + sz[i]*x[i];
+    double const qz = sw[i]*z[i] + sx[i]*y[i] - sy[i]*x[i] + sz[i]*w[i];
+
+    // a first order correction of the magnitude, which keeps rounding error
+    // from accumulating over many steps without a square root
+    double const correction = 1.5 - 0.5*(qw*qw + qx*qx + qy*qy + qz*qz);
+    w[i] = qw*correction;
+    x[i] = qx*correction;
+    y[i] = qy*correction;
+    z[i] = qz*correction;
+  }
+}
+
+
+/******************************************************************************
+* PRIVATE METHODS *************************************************************
+******************************************************************************/
+
+void AttitudeArray::updateStep(
+    size_t const slot,
+    second_type const seconds) noexcept
+{
+  double const rate = std::sqrt(m_rateX[slot]*m_rateX[slot] + \
+      m_rateY[slot]*m_rateY[slot] + m_rateZ[slot]*m_rateZ[slot]);
+  double const half = 0.5*rate*seconds;
+
+  // sin(half) / rate, which tends to seconds / 2 for slow rotations
+  double const scale = rate > 0.0 ? std::sin(half) / rate : 0.5*seconds;
+
+  m_stepW[slot] = std::cos(half);
+  m_stepX[slot] = m_rateX[slot]*scale;
+  m_stepY[slot] = m_rateY[slot]*scale;
+  m_stepZ[slot] = m_rateZ[slot]*scale;
+  m_stepSeconds[slot] = seconds;
+}
+
+}
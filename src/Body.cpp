@@ -49,6 +49,12 @@ kilo_type Body::mass() const noexcept
   return m_mass;
 }
 
+void Body::setMass(
+    kilo_type const mass) noexcept
+{
+  m_mass = mass;
+}
+
 Rotation Body::angularVelocity() const noexcept
 {
   return m_angularVelocity;
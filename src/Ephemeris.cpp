@@ -0,0 +1,256 @@
+/**
+* @file Ephemeris.cpp
+* @brief Implementation of the Ephemeris class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+#include "Ephemeris.hpp"
+#include "Constants.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace gravitree
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+namespace
+{
+
+// the number of coefficients of each polynomial (one more than its degree)
+constexpr size_t const NUM_COEFFICIENTS = 12;
+
+// position and velocity
+constexpr size_t const NUM_COMPONENTS = 6;
+
+constexpr size_t const SEGMENT_SIZE = NUM_COEFFICIENTS * NUM_COMPONENTS;
+
+// the number of segments first tried
+constexpr size_t const MIN_SEGMENTS = 8;
+
+// the most segments used, even if the tolerance is not reached (e.g., when
+// it is below the rounding error of the positions)
+constexpr size_t const MAX_SEGMENTS = 65536;
+
+}
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+Ephemeris::Ephemeris(
+    OrbitalState const & state,
+    meter_type const tolerance) :
+  Ephemeris(state, tolerance, tolerance * state.orbit().meanMotion())
+{
+  // do nothing
+}
+
+Ephemeris::Ephemeris(
+    OrbitalState const & state,
+    meter_type const tolerance,
+    double const velocityTolerance) :
+  m_state(state),
+  m_tolerance(tolerance),
+  m_velocityTolerance(velocityTolerance),
+  m_period(state.orbit().period()),
+  m_segmentLength(0),
+  m_coefficients()
+{
+  if (!state.orbit().isClosed() || !std::isfinite(m_period) || \
+      m_period <= 0) {
+    throw std::invalid_argument("Ephemeris requires a closed orbit");
+  }
+  if (!(tolerance > 0) || !(velocityTolerance > 0)) {
+    throw std::invalid_argument("Invalid tolerance");
+  }
+
+  build();
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+Vector3D Ephemeris::position(
+    second_type const time) const
+{
+  double x;
+  size_t const segment = locate(time, &x);
+
+  Vector3D position;
+  evaluate(segment, x, &position, nullptr);
+
+  return position;
+}
+
+Vector3D Ephemeris::velocity(
+    second_type const time) const
+{
+  Vector3D position;
+  Vector3D velocity;
+  state(time, &position, &velocity);
+
+  return velocity;
+}
+
+void Ephemeris::state(
+    second_type const time,
+    Vector3D * const position,
+    Vector3D * const velocity) const
+{
+  double x;
+  size_t const segment = locate(time, &x);
+
+  evaluate(segment, x, position, velocity);
+}
+
+size_t Ephemeris::numSegments() const
+{
+  return m_coefficients.size() / SEGMENT_SIZE;
+}
+
+OrbitalState const & Ephemeris::orbitalState() const noexcept
+{
+  return m_state;
+}
+
+
+/******************************************************************************
+* PRIVATE METHODS *************************************************************
+******************************************************************************/
+
+void Ephemeris::build()
+{
+  size_t numSegments = MIN_SEGMENTS;
+  while (!fit(numSegments) && numSegments < MAX_SEGMENTS) {
+    numSegments *= 2;
+  }
+}
+
+bool Ephemeris::fit(
+    size_t const numSegments)
+{
+  double const pi = Constants::PI;
+  double const n = static_cast<double>(NUM_COEFFICIENTS);
+
+  m_segmentLength = m_period / numSegments;
+  m_coefficients.assign(numSegments * SEGMENT_SIZE, 0.0);
+
+  OrbitalState sample = m_state;
+  double values[NUM_COEFFICIENTS][NUM_COMPONENTS];
+
+  bool within = true;
+  for (size_t segment = 0; segment < numSegments; ++segment) {
+    second_type const start = segment * m_segmentLength;
+
+    // sample at the roots of the next Chebyshev polynomial
+    for (size_t k = 0; k < NUM_COEFFICIENTS; ++k) {
+      double const x = std::cos(pi * (k + 0.5) / n);
+      sample.setTime(start + 0.5 * (x + 1.0) * m_segmentLength);
+
+      Vector3D position;
+      Vector3D velocity;
+      sample.state(&position, &velocity);
+      values[k][0] = position.x();
+      values[k][1] = position.y();
+      values[k][2] = position.z();
+      values[k][3] = velocity.x();
+      values[k][4] = velocity.y();
+      values[k][5] = velocity.z();
+    }
+
+    double * const coefficients = m_coefficients.data() + \
+        segment * SEGMENT_SIZE;
+    for (size_t j = 0; j < NUM_COEFFICIENTS; ++j) {
+      double const scale = (j == 0 ? 1.0 : 2.0) / n;
+      for (size_t k = 0; k < NUM_COEFFICIENTS; ++k) {
+        double const weight = scale * std::cos(pi * j * (k + 0.5) / n);
+        for (size_t c = 0; c < NUM_COMPONENTS; ++c) {
+          coefficients[c*NUM_COEFFICIENTS + j] += weight * values[k][c];
+        }
+      }
+    }
+
+    // the error of the fit is largest near the extrema of the next
+    // Chebyshev polynomial
+    for (size_t k = 0; k <= NUM_COEFFICIENTS; ++k) {
+      double const x = std::cos(pi * k / n);
+      sample.setTime(start + 0.5 * (x + 1.0) * m_segmentLength);
+
+      Vector3D position;
+      Vector3D velocity;
+      sample.state(&position, &velocity);
+
+      Vector3D fittedPosition;
+      Vector3D fittedVelocity;
+      evaluate(segment, x, &fittedPosition, &fittedVelocity);
+      within = within && \
+          fittedPosition.distance(position) <= m_tolerance && \
+          fittedVelocity.distance(velocity) <= m_velocityTolerance;
+    }
+  }
+
+  return within;
+}
+
+void Ephemeris::evaluate(
+    size_t const segment,
+    double const x,
+    Vector3D * const position,
+    Vector3D * const velocity) const noexcept
+{
+  assert(segment * SEGMENT_SIZE < m_coefficients.size());
+
+  double const * const coefficients = m_coefficients.data() + \
+      segment * SEGMENT_SIZE;
+  size_t const numComponents = velocity != nullptr ? NUM_COMPONENTS : 3;
+
+  // Clenshaw's recurrence
+  double result[NUM_COMPONENTS];
+  for (size_t c = 0; c < numComponents; ++c) {
+    double const * const a = coefficients + c*NUM_COEFFICIENTS;
+    double b1 = 0;
+    double b2 = 0;
+    for (size_t j = NUM_COEFFICIENTS - 1; j > 0; --j) {
+      double const b0 = 2.0*x*b1 - b2 + a[j];
+      b2 = b1;
+      b1 = b0;
+    }
+    result[c] = x*b1 - b2 + a[0];
+  }
+
+  *position = Vector3D(result[0], result[1], result[2]);
+  if (velocity != nullptr) {
+    *velocity = Vector3D(result[3], result[4], result[5]);
+  }
+}
+
+size_t Ephemeris::locate(
+    second_type const time,
+    double * const x) const noexcept
+{
+  size_t const numSegments = m_coefficients.size() / SEGMENT_SIZE;
+
+  second_type const phase = std::max(0.0, \
+      time - std::floor(time / m_period) * m_period);
+  size_t const segment = std::min(numSegments - 1, \
+      static_cast<size_t>(phase / m_segmentLength));
+
+  *x = 2.0 * (phase - segment * m_segmentLength) / m_segmentLength - 1.0;
+
+  return segment;
+}
+
+}
@@ -8,8 +8,8 @@
 */
 
 #include "KeplerOrbit.hpp"
-#include "Gravity.hpp"
-#include "Constants.hpp"
+#include "OrbitFormula.hpp"
+#include "Propagator.hpp"
 #include <cmath>
 
 namespace gravitree
@@ -22,13 +22,16 @@ namespace gravitree
 namespace
 {
 
-double calcPeriod(
-    meter_type const semimajorAxis,
-    kilo_type const parentMass)
+KeplerOrbit::propagator_type choosePropagator(
+    double const eccentricity)
 {
-  double const a3 = semimajorAxis*semimajorAxis*semimajorAxis;
-  double const mu = Gravity::G * parentMass;
-  return 2.0*Constants::PI*std::sqrt(a3/mu);
+  if (eccentricity <= CircularPropagator::MAX_ECCENTRICITY) {
+    return KeplerOrbit::propagator_type::CIRCULAR;
+  } else if (eccentricity < 1.0) {
+    return KeplerOrbit::propagator_type::ELLIPTIC;
+  } else {
+    return KeplerOrbit::propagator_type::HYPERBOLIC;
+  }
 }
 
 }
@@ -50,8 +53,66 @@ KeplerOrbit::KeplerOrbit(
   m_longitudeOfAscendingNode(longitudeOfAscendingNode),
   m_argumentOfPeriapsis(argumentOfPeriapsis),
   m_parentMass(parentMass),
-  m_period(calcPeriod(semimajorAxis, parentMass)),
-  m_mu(parentMass*Gravity::G)
+  m_period(OrbitFormula::period<RuntimeSqrt>(semimajorAxis, \
+      OrbitFormula::mu(parentMass))),
+  m_mu(OrbitFormula::mu(parentMass)),
+  m_meanMotion(OrbitFormula::meanMotion<RuntimeSqrt>(semimajorAxis, \
+      eccentricity, m_mu)),
+  m_semilatusRectum(OrbitFormula::semilatusRectum(semimajorAxis, \
+      eccentricity)),
+  m_angularMomentum(OrbitFormula::angularMomentum<RuntimeSqrt>( \
+      semimajorAxis, eccentricity, m_mu)),
+  m_semiminorAxis(OrbitFormula::semiminorAxis<RuntimeSqrt>(semimajorAxis, \
+      eccentricity)),
+  m_halfAngleRatio(OrbitFormula::halfAngleRatio<RuntimeSqrt>(eccentricity)),
+  m_perifocalP(),
+  m_perifocalQ(),
+  m_propagator(choosePropagator(eccentricity))
+{
+  double const cos_W = std::cos(longitudeOfAscendingNode);
+  double const sin_W = std::sin(longitudeOfAscendingNode);
+  double const cos_w = std::cos(argumentOfPeriapsis);
+  double const sin_w = std::sin(argumentOfPeriapsis);
+  double const cos_i = std::cos(inclination);
+  double const sin_i = std::sin(inclination);
+
+  m_perifocalP = Vector3D(
+      OrbitFormula::frameX(cos_W, sin_W, cos_w, sin_w, cos_i),
+      OrbitFormula::frameY(cos_W, sin_W, cos_w, sin_w, cos_i),
+      OrbitFormula::frameZ(sin_w, sin_i));
+  m_perifocalQ = Vector3D(
+      OrbitFormula::frameX(cos_W, sin_W, -sin_w, cos_w, cos_i),
+      OrbitFormula::frameY(cos_W, sin_W, -sin_w, cos_w, cos_i),
+      OrbitFormula::frameZ(cos_w, sin_i));
+}
+
+
+KeplerOrbit::KeplerOrbit(
+    meter_type const semimajorAxis,
+    double const eccentricity,
+    radian_type const inclination,
+    radian_type const longitudeOfAscendingNode,
+    radian_type const argumentOfPeriapsis,
+    kilo_type const parentMass,
+    derived_struct const & derived) :
+  m_semimajorAxis(semimajorAxis),
+  m_eccentricity(eccentricity),
+  m_inclination(inclination),
+  m_longitudeOfAscendingNode(longitudeOfAscendingNode),
+  m_argumentOfPeriapsis(argumentOfPeriapsis),
+  m_parentMass(parentMass),
+  m_period(derived.period),
+  m_mu(derived.mu),
+  m_meanMotion(derived.meanMotion),
+  m_semilatusRectum(derived.semilatusRectum),
+  m_angularMomentum(derived.angularMomentum),
+  m_semiminorAxis(derived.semiminorAxis),
+  m_halfAngleRatio(derived.halfAngleRatio),
+  m_perifocalP(derived.perifocalP[0], derived.perifocalP[1], \
+      derived.perifocalP[2]),
+  m_perifocalQ(derived.perifocalQ[0], derived.perifocalQ[1], \
+      derived.perifocalQ[2]),
+  m_propagator(choosePropagator(eccentricity))
 {
   // do nothing
 }
@@ -100,6 +161,11 @@ second_type KeplerOrbit::period() const
   return m_period;
 }
 
+double KeplerOrbit::meanMotion() const
+{
+  return m_meanMotion;
+}
+
 double KeplerOrbit::mu() const
 {
   return m_mu;
@@ -107,29 +173,22 @@ double KeplerOrbit::mu() const
 
 double KeplerOrbit::angularMomentum() const
 {
-  return std::sqrt(m_mu * semilatusRectum());
+  return m_angularMomentum;
 }
 
 double KeplerOrbit::semilatusRectum() const
 {
-  return m_semimajorAxis * (1.0 - m_eccentricity*m_eccentricity);
+  return m_semilatusRectum;
 }
 
 meter_type KeplerOrbit::apoapsis() const
 {
-  if (!isClosed()) {
-    return INFINITY; 
-  }
-
-  return semilatusRectum() / (1.0 - m_eccentricity);
+  return OrbitFormula::apoapsis(m_semimajorAxis, m_eccentricity);
 }
 
 meter_type KeplerOrbit::periapsis() const
 {
-  double const num = m_semimajorAxis * ( 1 - m_eccentricity*m_eccentricity);
-  double const den = 1 + m_eccentricity;
-
-  return num / den;
+  return OrbitFormula::periapsis(m_semimajorAxis, m_eccentricity);
 }
 
 bool KeplerOrbit::isClosed() const
@@ -137,5 +196,29 @@ bool KeplerOrbit::isClosed() const
   return m_eccentricity < 1.0;
 }
 
+meter_type KeplerOrbit::semiminorAxis() const
+{
+  return m_semiminorAxis;
+}
+
+double KeplerOrbit::halfAngleRatio() const
+{
+  return m_halfAngleRatio;
+}
+
+Vector3D const & KeplerOrbit::perifocalP() const
+{
+  return m_perifocalP;
+}
+
+Vector3D const & KeplerOrbit::perifocalQ() const
+{
+  return m_perifocalQ;
 }
 
+KeplerOrbit::propagator_type KeplerOrbit::propagator() const
+{
+  return m_propagator;
+}
+
+}
@@ -8,57 +8,121 @@
  */
 
 #include "OrbitalState.hpp"
+#include "Anomally.hpp"
 #include "Constants.hpp"
 #include "Gravity.hpp"
+#include "Propagator.hpp"
+#include "VectorExpression.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace gravitree
 {
 
 /******************************************************************************
-* HELPER FUNCTIONS ************************************************************
+* CONSTANTS *******************************************************************
 ******************************************************************************/
 
 namespace
 {
 
-radian_type calcEccentricAnomally(
-    KeplerOrbit const orbit,
-    radian_type const trueAnomally)
-{
-  double const e2 = orbit.eccentricity() * orbit.eccentricity();
-  double const num = std::sqrt(1.0-e2) * std::sin(trueAnomally);
-  double const den = orbit.eccentricity() + std::cos(trueAnomally);
-  return std::atan2(num, den);
+// the number of states whose elements are found together before any of them
+// are constructed
+constexpr size_t const ELEMENTS_BLOCK = 64;
+
 }
 
-radian_type calcMeanAnomally(
-    KeplerOrbit const orbit,
-    radian_type const eccentricAnomally)
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+namespace
 {
-  return eccentricAnomally - orbit.eccentricity()*std::sin(eccentricAnomally);
-}
 
-double newtonsMethod(
-    radian_type const meanAnomally,
-    double const eccentricity,
-    size_t const maxIterations,
-    double const tolerance)
+struct elements_struct
 {
-  double eccentricAnomally = meanAnomally;
-  double residual = eccentricity*std::sin(eccentricAnomally);
-  for (size_t i = 0; i < maxIterations; ++i) {
-    eccentricAnomally -= \
-        (residual / (1.0 - eccentricity * std::cos(eccentricAnomally)));
-    residual = eccentricAnomally - \
-        eccentricity * std::sin(eccentricAnomally) - meanAnomally;
-    if (residual < tolerance) {
-      break;
-    }
-  }
+  meter_type semimajorAxis;
+  double eccentricity;
+  radian_type inclination;
+  radian_type longitudeOfAscendingNode;
+  radian_type argumentOfPeriapsis;
+  radian_type trueAnomally;
+};
 
-  return eccentricAnomally;
+/**
+* @brief Find the elements of the orbit through a position and velocity. This
+* works on the components directly and selects rather than branches, so that
+* loops over it can be vectorized.
+*
+* @param position The position.
+* @param velocity The velocity.
+* @param mu The gravitational parameter of the parent.
+*
+* @return The elements.
+*/
+inline elements_struct toElements(
+    Vector3D const & position,
+    Vector3D const & velocity,
+    double const mu) noexcept
+{
+  double const rx = position.x();
+  double const ry = position.y();
+  double const rz = position.z();
+  double const vx = velocity.x();
+  double const vy = velocity.y();
+  double const vz = velocity.z();
+
+  // the angular momentum
+  double const hx = ry*vz - rz*vy;
+  double const hy = rz*vx - rx*vz;
+  double const hz = rx*vy - ry*vx;
+  double const h2 = hx*hx + hy*hy + hz*hz;
+  double const h = std::sqrt(h2);
+
+  double const r = std::sqrt(rx*rx + ry*ry + rz*rz);
+  double const v2 = vx*vx + vy*vy + vz*vz;
+  double const rv = rx*vx + ry*vy + rz*vz;
+
+  double const energy = v2*0.5 - (mu / r);
+  double const semimajorAxis = - 0.5 * mu / energy;
+
+  // the eccentricity vector, (v x h)/mu - r/|r|
+  double const ex = (vy*hz - vz*hy) / mu - rx / r;
+  double const ey = (vz*hx - vx*hz) / mu - ry / r;
+  double const ez = (vx*hy - vy*hx) / mu - rz / r;
+  double const eccentricity = std::sqrt(ex*ex + ey*ey + ez*ez);
+
+  // unlike acos(), this stays finite when rounding makes |hz| > h
+  double const n = std::sqrt(hx*hx + hy*hy);
+  double const inclination = std::atan2(n, hz);
+
+  // the ascending node, which for equatorial orbits is taken to be along x
+  bool const equatorial = !(n > 0);
+  double const nx = equatorial ? 1.0 : -hy / n;
+  double const ny = equatorial ? 0.0 : hx / n;
+  double const longitudeOfAscendingNode = std::atan2(ny, nx);
+
+  // the argument of latitude, the angle from the node to the position
+  // within the plane of the orbit
+  double const cos_u = rx*nx + ry*ny;
+  double const sin_u = (ry*nx - rx*ny) * hz / h + rz * (hx*ny - hy*nx) / h;
+  double const latitude = std::atan2(sin_u, cos_u);
+
+  // from e*cos(v) = p/r - 1 and e*sin(v) = sqrt(p/mu)*(r.v)/r, where
+  // p = h^2/mu. For circular orbits both are rounding error, but as the
+  // argument of periapsis is taken relative to it the position is kept.
+  double const trueAnomally = std::atan2(h * rv, h2 - mu * r);
+
+  return elements_struct{
+      semimajorAxis,
+      eccentricity,
+      inclination,
+      longitudeOfAscendingNode,
+      latitude - trueAnomally,
+      trueAnomally};
 }
 
 }
@@ -73,63 +137,57 @@ OrbitalState OrbitalState::fromVectors(
     Vector3D const velocity,
     kilo_type const parentMass)
 {
-  Vector3D const hVec = position.cross(velocity);
-
-  double const h = hVec.magnitude();
-  double const r = position.magnitude();
-  double const v = velocity.magnitude();
-
-  assert(r > 0);
-
-  double const mu = parentMass * Gravity::G;
+  assert(position.magnitude() > 0);
 
-  double const E = v*v*0.5 - (mu / r);
+  elements_struct const elements = \
+      toElements(position, velocity, parentMass * Gravity::G);
+  assert(std::isfinite(elements.semimajorAxis));
+  assert(std::isfinite(elements.trueAnomally));
 
-  assert(E != 0);
+  KeplerOrbit orbit(elements.semimajorAxis, elements.eccentricity, \
+      elements.inclination, elements.longitudeOfAscendingNode, \
+      elements.argumentOfPeriapsis, parentMass);
 
-  double const semimajorAxis = - 0.5 * mu / E;
-  Vector3D const e = (velocity.cross(hVec) / mu) - (position/r);
-  double const eccentricity = e.magnitude();
-
-  double const cos_i = hVec.z() / h;
-  double const inclination = std::acos(cos_i);
-  double const sin_i = std::sqrt(hVec.x()*hVec.x()+hVec.y()*hVec.y())/h;
+  return OrbitalState(orbit, elements.trueAnomally);
+}
 
-  double const p = semimajorAxis * (1.0 - eccentricity*eccentricity);
+void OrbitalState::fromVectors(
+    Vector3D const * const positions,
+    Vector3D const * const velocities,
+    kilo_type const * const masses,
+    size_t const num,
+    std::vector<OrbitalState> * const states)
+{
+  states->clear();
+  states->reserve(num);
 
-  double const trueAnomally = std::atan2( \
-      std::sqrt(p/mu) * (velocity*position), p-r);
-  assert(std::isfinite(trueAnomally));
+  elements_struct elements[ELEMENTS_BLOCK];
+  for (size_t begin = 0; begin < num; begin += ELEMENTS_BLOCK) {
+    size_t const size = std::min(ELEMENTS_BLOCK, num - begin);
 
-  double longitudeOfAscendingNode;
-  double argumentOfPeriapsis;
-  if (sin_i == 0) {
-    // equatorial orbit
-    assert(e.z() == 0);
-    longitudeOfAscendingNode = 0.0;
-    argumentOfPeriapsis = std::atan2(e.y(), e.x());
-    if (hVec.z() < 0) {
-      // counter clockwise orbit
-      argumentOfPeriapsis = 2.0 * Constants::PI - argumentOfPeriapsis;
+    for (size_t i = 0; i < size; ++i) {
+      elements[i] = toElements(positions[begin + i], velocities[begin + i], \
+          masses[begin + i] * Gravity::G);
     }
-  } else {
-    assert(sin_i != 0);
-    longitudeOfAscendingNode = std::atan2(hVec.x(), -hVec.y());
-    double const cos_W = std::cos(longitudeOfAscendingNode);
-    double const sin_W = std::sin(longitudeOfAscendingNode);
-
-    double const w_v = std::atan2( \
-        position.z() / sin_i, \
-        position.x() * cos_W + position.y() * sin_W);
-    assert(std::isfinite(w_v));
 
-    argumentOfPeriapsis = w_v - trueAnomally;
+    for (size_t i = 0; i < size; ++i) {
+      KeplerOrbit orbit(elements[i].semimajorAxis, elements[i].eccentricity, \
+          elements[i].inclination, elements[i].longitudeOfAscendingNode, \
+          elements[i].argumentOfPeriapsis, masses[begin + i]);
+      states->emplace_back(orbit, elements[i].trueAnomally);
+    }
   }
+}
 
-  KeplerOrbit orbit(semimajorAxis, eccentricity, inclination,
-      longitudeOfAscendingNode, argumentOfPeriapsis, parentMass);
-
-  return OrbitalState(orbit, trueAnomally);
+void OrbitalState::state(
+    OrbitalState const * const states,
+    size_t const num,
+    Vector3D * const positions,
+    Vector3D * const velocities) noexcept
+{
+  for (size_t i = 0; i < num; ++i) {
+    states[i].state(positions + i, velocities + i);
+  }
 }
 
 
@@ -146,11 +204,39 @@ OrbitalState::OrbitalState(
   m_meanAnomally(0),
   m_time(0)
 {
-  m_eccentricAnomally = calcEccentricAnomally(orbit, trueAnomally);
-  m_meanAnomally = calcMeanAnomally(orbit, m_eccentricAnomally);
+  if (orbit.isClosed()) {
+    m_eccentricAnomally = Anomally::eccentricFromTrue(trueAnomally, \
+        orbit.eccentricity());
+    m_meanAnomally = Anomally::meanFromEccentric(m_eccentricAnomally, \
+        orbit.eccentricity());
+
+    // time since epoch 
+    m_time = (m_meanAnomally*orbit.period()) / (2.0 * Constants::PI);
+  } else {
+    // open orbits keep the hyperbolic anomally in place of the eccentric
+    m_eccentricAnomally = Anomally::hyperbolicFromTrue(trueAnomally, \
+        orbit.eccentricity());
+    m_meanAnomally = Anomally::meanFromHyperbolic(m_eccentricAnomally, \
+        orbit.eccentricity());
+
+    // time since periapsis
+    m_time = m_meanAnomally / orbit.meanMotion();
+  }
+}
 
-  // time since epoch 
-  m_time = (m_meanAnomally*orbit.period()) / (2.0 * Constants::PI);
+OrbitalState::OrbitalState(
+    KeplerOrbit const orbit,
+    radian_type const trueAnomally,
+    radian_type const eccentricAnomally,
+    radian_type const meanAnomally,
+    second_type const time) noexcept :
+  m_orbit(orbit),
+  m_trueAnomally(trueAnomally),
+  m_eccentricAnomally(eccentricAnomally),
+  m_meanAnomally(meanAnomally),
+  m_time(time)
+{
+  // do nothing
 }
 
 
@@ -162,75 +248,87 @@ void OrbitalState::setTime(
     second_type const time) noexcept
 {
   m_time = time;
+  m_meanAnomally = m_orbit.meanMotion() * time;
 
-  double const sweepRate = 2.0 * Constants::PI / m_orbit.period(); 
-  m_meanAnomally = sweepRate * time;
-
-  m_eccentricAnomally = newtonsMethod(m_meanAnomally, \
-      m_orbit.eccentricity(), 512, 1e-8);
+  double const e = m_orbit.eccentricity();
+  double const ratio = m_orbit.halfAngleRatio();
+  switch (m_orbit.propagator()) {
+    case KeplerOrbit::propagator_type::CIRCULAR:
+      CircularPropagator::solve(m_meanAnomally, e, ratio, \
+          &m_eccentricAnomally, &m_trueAnomally);
+      break;
+    case KeplerOrbit::propagator_type::ELLIPTIC:
+      EllipticPropagator::solve(m_meanAnomally, e, ratio, \
+          &m_eccentricAnomally, &m_trueAnomally);
+      break;
+    case KeplerOrbit::propagator_type::HYPERBOLIC:
+      HyperbolicPropagator::solve(m_meanAnomally, e, ratio, \
+          &m_eccentricAnomally, &m_trueAnomally);
+      break;
+  }
+}
 
-  double const e2 = m_eccentricAnomally*0.5;
+void OrbitalState::advance(
+    second_type const seconds) noexcept
+{
+  m_time += seconds;
+  m_meanAnomally = m_orbit.meanMotion() * m_time;
 
-  m_trueAnomally = 2.0 * std::atan2(
-      std::sqrt(1.0+m_orbit.eccentricity())*std::sin(e2),
-      std::sqrt(1.0-m_orbit.eccentricity())*std::cos(e2));
+  double const e = m_orbit.eccentricity();
+  double const ratio = m_orbit.halfAngleRatio();
+  switch (m_orbit.propagator()) {
+    case KeplerOrbit::propagator_type::CIRCULAR:
+      CircularPropagator::advance(m_meanAnomally, e, ratio, \
+          &m_eccentricAnomally, &m_trueAnomally);
+      break;
+    case KeplerOrbit::propagator_type::ELLIPTIC:
+      EllipticPropagator::advance(m_meanAnomally, e, ratio, \
+          &m_eccentricAnomally, &m_trueAnomally);
+      break;
+    case KeplerOrbit::propagator_type::HYPERBOLIC:
+      HyperbolicPropagator::advance(m_meanAnomally, e, ratio, \
+          &m_eccentricAnomally, &m_trueAnomally);
+      break;
+  }
 }
 
 Vector3D OrbitalState::velocity() const noexcept
 {
-  double const cos_W = std::cos(m_orbit.longitudeOfAscendingNode());
-  double const sin_W = std::sin(m_orbit.longitudeOfAscendingNode());
+  Vector3D position;
+  Vector3D velocity;
+  state(&position, &velocity);
 
-  double const sin_v = std::sin(m_trueAnomally);
-  double const cos_wv = std::cos( \
-      m_orbit.argumentOfPeriapsis() + m_trueAnomally);
-  double const sin_wv = std::sin( \
-      m_orbit.argumentOfPeriapsis() + m_trueAnomally);
-
-  double const cos_i = std::cos(m_orbit.inclination());
-  double const sin_i = std::sin(m_orbit.inclination());
-
-  double const r = distance();
-  double const p = m_orbit.semilatusRectum(); 
-
-  double const h = m_orbit.angularMomentum(); 
-  double const h_r = h / r;
-  double const he_rp = (m_orbit.eccentricity() / p) * h_r;
-
-  Vector3D const pos = position();
-  Vector3D const vel =  Vector3D(
-      (pos.x() * he_rp * sin_v) - (h_r*(cos_W*sin_wv+sin_W*cos_wv*cos_i)),
-      (pos.y() * he_rp * sin_v) - (h_r*(sin_W*sin_wv-cos_W*cos_wv*cos_i)),
-      (pos.z() * he_rp * sin_v) + (h_r*(sin_i * cos_wv)));
-
-  return vel;
+  return velocity;
 }
 
 Vector3D OrbitalState::position() const noexcept
 {
-  double const cos_W = std::cos(m_orbit.longitudeOfAscendingNode());
-  double const sin_W = std::sin(m_orbit.longitudeOfAscendingNode());
-
-  double const r = distance();
-
-  double const cos_wv = std::cos( \
-      m_orbit.argumentOfPeriapsis() + m_trueAnomally);
-  double const sin_wv = std::sin( \
-      m_orbit.argumentOfPeriapsis() + m_trueAnomally);
-
-  double const cos_i = std::cos(m_orbit.inclination());
-  double const sin_i = std::sin(m_orbit.inclination());
+  return evaluatePosition(m_orbit.perifocalP(), m_orbit.perifocalQ(), \
+      m_orbit.semimajorAxis(), m_orbit.semiminorAxis(), \
+      m_orbit.eccentricity(), m_eccentricAnomally);
+}
 
-  return Vector3D(
-      r * (cos_W * cos_wv - sin_W * sin_wv * cos_i),
-      r * (sin_W * cos_wv + cos_W * sin_wv * cos_i),
-      r * (sin_i * sin_wv));
+void OrbitalState::state(
+    Vector3D * const position,
+    Vector3D * const velocity) const noexcept
+{
+  evaluateState(m_orbit.perifocalP(), m_orbit.perifocalQ(), \
+      m_orbit.semimajorAxis(), m_orbit.semiminorAxis(), \
+      m_orbit.eccentricity(), m_orbit.meanMotion(), m_eccentricAnomally, \
+      position, velocity);
 }
 
 meter_type OrbitalState::distance() const noexcept
 {
   double const a = m_orbit.semimajorAxis();
   double const e = m_orbit.eccentricity();
+
+  if (!m_orbit.isClosed()) {
+    // 1 - e cosh(H), without cancellation for near parabolic orbits
+    double const sinh_H2 = std::sinh(m_eccentricAnomally*0.5);
+    return a * ((1.0 - e) - 2.0 * e * sinh_H2 * sinh_H2);
+  }
+
   double const cos_E = std::cos(m_eccentricAnomally);
 
   return a * (1.0 - e * cos_E);
@@ -261,5 +359,80 @@ KeplerOrbit OrbitalState::orbit() const noexcept
   return m_orbit;
 }
 
+
+
+/******************************************************************************
+* PRIVATE STATIC METHODS ******************************************************
+******************************************************************************/
+
+Vector3D OrbitalState::evaluatePosition(
+    Vector3D const & p,
+    Vector3D const & q,
+    meter_type const semimajorAxis,
+    meter_type const semiminorAxis,
+    double const eccentricity,
+    radian_type const eccentricAnomally) noexcept
+{
+  double x;
+  double y;
+  if (eccentricity < 1.0) {
+    // (a (cos E - e), b sin E)
+    double const cos_E = std::cos(eccentricAnomally);
+    double const sin_E = std::sin(eccentricAnomally);
+    x = semimajorAxis * (cos_E - eccentricity);
+    y = semiminorAxis * sin_E;
+  } else {
+    // (a (cosh H - e), b sinh H), without cancellation for near parabolic
+    // orbits
+    double const cosh_H = std::cosh(eccentricAnomally);
+    double const sinh_H = std::sinh(eccentricAnomally);
+    x = semimajorAxis * ((sinh_H*sinh_H / (cosh_H + 1.0)) - \
+        (eccentricity - 1.0));
+    y = semiminorAxis * sinh_H;
+  }
+
+  return evaluate(lazy(p)*x + lazy(q)*y);
+}
+
+void OrbitalState::evaluateState(
+    Vector3D const & p,
+    Vector3D const & q,
+    meter_type const semimajorAxis,
+    meter_type const semiminorAxis,
+    double const eccentricity,
+    double const meanMotion,
+    radian_type const eccentricAnomally,
+    Vector3D * const position,
+    Vector3D * const velocity) noexcept
+{
+  double x;
+  double y;
+  double dx;
+  double dy;
+  if (eccentricity < 1.0) {
+    // the derivative of the position, with dE/dt = n / (1 - e cos E)
+    double const cos_E = std::cos(eccentricAnomally);
+    double const sin_E = std::sin(eccentricAnomally);
+    double const rate = meanMotion / (1.0 - eccentricity * cos_E);
+    x = semimajorAxis * (cos_E - eccentricity);
+    y = semiminorAxis * sin_E;
+    dx = -semimajorAxis * sin_E * rate;
+    dy = semiminorAxis * cos_E * rate;
+  } else {
+    // and with dH/dt = n / (e cosh H - 1)
+    double const cosh_H = std::cosh(eccentricAnomally);
+    double const sinh_H = std::sinh(eccentricAnomally);
+    double const coshm1_H = sinh_H*sinh_H / (cosh_H + 1.0);
+    double const rate = meanMotion / ((eccentricity - 1.0) + \
+        eccentricity * coshm1_H);
+    x = semimajorAxis * (coshm1_H - (eccentricity - 1.0));
+    y = semiminorAxis * sinh_H;
+    dx = semimajorAxis * sinh_H * rate;
+    dy = semiminorAxis * cosh_H * rate;
+  }
+
+  *position = evaluate(lazy(p)*x + lazy(q)*y);
+  *velocity = evaluate(lazy(p)*dx + lazy(q)*dy);
 }
 
+}
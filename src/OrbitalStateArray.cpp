@@ -0,0 +1,560 @@
+/**
+* @file OrbitalStateArray.cpp
+* @brief Implementation of the OrbitalStateArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-14
+*/
+
+#include "OrbitalStateArray.hpp"
+#include "Anomally.hpp"
+#include "Constants.hpp"
+#include "OrbitFormula.hpp"
+#include "Propagator.hpp"
+
+#include <utility>
+#include <cassert>
+#include <cmath>
+
+namespace gravitree
+{
+
+constexpr size_t const OrbitalStateArray::NO_PARENT;
+constexpr size_t const OrbitalStateArray::FREE_PARTITION;
+constexpr size_t const OrbitalStateArray::NUM_PARTITIONS;
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+namespace
+{
+
+double calcMeanMotion(
+    KeplerOrbit const & orbit)
+{
+  // bodies without a valid period (e.g., the root), remain stationary
+  double const meanMotion = orbit.meanMotion();
+  return std::isfinite(meanMotion) && meanMotion > 0 ? meanMotion : 0.0;
+}
+
+}
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+OrbitalStateArray::OrbitalStateArray() :
+  m_semimajorAxis(),
+  m_eccentricity(),
+  m_inclination(),
+  m_longitudeOfAscendingNode(),
+  m_argumentOfPeriapsis(),
+  m_parentMass(),
+  m_meanMotion(),
+  m_perifocalP(),
+  m_perifocalQ(),
+  m_semiminorAxis(),
+  m_halfAngleRatio(),
+  m_propagator(),
+  m_singleP(),
+  m_singleQ(),
+  m_singleEccentricity(),
+  m_time(),
+  m_meanAnomally(),
+  m_eccentricAnomally(),
+  m_trueAnomally(),
+  m_rows(),
+  m_slots(),
+  m_parent(),
+  m_free(),
+  m_bounds()
+{
+  // do nothing
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+size_t OrbitalStateArray::size() const noexcept
+{
+  return m_parent.size();
+}
+
+size_t OrbitalStateArray::add(
+    OrbitalState const & state,
+    size_t const parent)
+{
+  size_t slot;
+  if (!m_free.empty()) {
+    slot = m_free.back();
+    m_free.pop_back();
+  } else {
+    // the new row is the last, which is in the partition of free slots
+    slot = m_parent.size();
+
+    m_semimajorAxis.emplace_back();
+    m_eccentricity.emplace_back();
+    m_inclination.emplace_back();
+    m_longitudeOfAscendingNode.emplace_back();
+    m_argumentOfPeriapsis.emplace_back();
+    m_parentMass.emplace_back();
+    m_meanMotion.emplace_back();
+    m_perifocalP.emplace_back();
+    m_perifocalQ.emplace_back();
+    m_semiminorAxis.emplace_back();
+    m_halfAngleRatio.emplace_back();
+    m_propagator.emplace_back(KeplerOrbit::propagator_type::CIRCULAR);
+    m_singleP.emplace_back();
+    m_singleQ.emplace_back();
+    m_singleEccentricity.emplace_back();
+    m_time.emplace_back();
+    m_meanAnomally.emplace_back();
+    m_eccentricAnomally.emplace_back();
+    m_trueAnomally.emplace_back();
+    m_rows.emplace_back(slot);
+    m_slots.emplace_back(slot);
+    m_parent.emplace_back();
+    ++m_bounds[NUM_PARTITIONS];
+  }
+
+  set(slot, state);
+  m_parent[slot] = parent;
+
+  return slot;
+}
+
+void OrbitalStateArray::remove(
+    size_t const slot)
+{
+  assert(slot < size());
+
+  size_t const row = m_rows[slot];
+
+  m_semimajorAxis[row] = 0.0;
+  m_eccentricity[row] = 0.0;
+  m_inclination[row] = 0.0;
+  m_longitudeOfAscendingNode[row] = 0.0;
+  m_argumentOfPeriapsis[row] = 0.0;
+  m_parentMass[row] = 0.0;
+  m_meanMotion[row] = 0.0;
+  m_perifocalP[row] = Vector3D();
+  m_perifocalQ[row] = Vector3D();
+  m_semiminorAxis[row] = 0.0;
+  m_halfAngleRatio[row] = 0.0;
+  m_propagator[row] = KeplerOrbit::propagator_type::CIRCULAR;
+  m_singleP[row] = Vector3F();
+  m_singleQ[row] = Vector3F();
+  m_singleEccentricity[row] = 0.0f;
+  m_time[row] = 0.0;
+  m_meanAnomally[row] = 0.0;
+  m_eccentricAnomally[row] = 0.0;
+  m_trueAnomally[row] = 0.0;
+  m_parent[slot] = NO_PARENT;
+
+  relocate(slot, FREE_PARTITION);
+
+  m_free.emplace_back(slot);
+}
+
+void OrbitalStateArray::set(
+    size_t const slot,
+    OrbitalState const & state)
+{
+  assert(slot < size());
+
+  KeplerOrbit const & orbit = state.m_orbit;
+  size_t const row = m_rows[slot];
+
+  m_semimajorAxis[row] = orbit.semimajorAxis();
+  m_eccentricity[row] = orbit.eccentricity();
+  m_inclination[row] = orbit.inclination();
+  m_longitudeOfAscendingNode[row] = orbit.longitudeOfAscendingNode();
+  m_argumentOfPeriapsis[row] = orbit.argumentOfPeriapsis();
+  m_parentMass[row] = orbit.parentMass();
+  m_meanMotion[row] = calcMeanMotion(orbit);
+  m_perifocalP[row] = orbit.perifocalP();
+  m_perifocalQ[row] = orbit.perifocalQ();
+  m_semiminorAxis[row] = orbit.semiminorAxis();
+  m_halfAngleRatio[row] = orbit.halfAngleRatio();
+  m_propagator[row] = orbit.propagator();
+  m_singleP[row] = Vector3F(orbit.perifocalP() * orbit.semimajorAxis());
+  m_singleQ[row] = Vector3F(orbit.perifocalQ() * orbit.semiminorAxis());
+  m_singleEccentricity[row] = static_cast<float>(orbit.eccentricity());
+
+  // stationary states do not keep time
+  m_time[row] = m_meanMotion[row] != 0.0 ? state.m_time : 0.0;
+  m_meanAnomally[row] = state.m_meanAnomally;
+  m_eccentricAnomally[row] = state.m_eccentricAnomally;
+  m_trueAnomally[row] = state.m_trueAnomally;
+
+  relocate(slot, static_cast<size_t>(orbit.propagator()));
+}
+
+OrbitalState OrbitalStateArray::get(
+    size_t const slot) const
+{
+  assert(slot < size());
+
+  size_t const row = m_rows[slot];
+
+  KeplerOrbit const orbit(m_semimajorAxis[row], m_eccentricity[row],
+      m_inclination[row], m_longitudeOfAscendingNode[row],
+      m_argumentOfPeriapsis[row], m_parentMass[row]);
+
+  return OrbitalState(orbit, m_trueAnomally[row], m_eccentricAnomally[row],
+      m_meanAnomally[row], m_time[row]);
+}
+
+size_t OrbitalStateArray::parent(
+    size_t const slot) const noexcept
+{
+  return m_parent[slot];
+}
+
+void OrbitalStateArray::setParent(
+    size_t const slot,
+    size_t const parent) noexcept
+{
+  m_parent[slot] = parent;
+}
+
+void OrbitalStateArray::propagate(
+    size_t const begin,
+    size_t const end,
+    second_type const seconds) noexcept
+{
+  assert(end <= size());
+
+  for (size_t slot = begin; slot < end; ++slot) {
+    size_t const row = m_rows[slot];
+    switch (m_propagator[row]) {
+      case KeplerOrbit::propagator_type::CIRCULAR:
+        propagateRows<CircularPropagator>(row, row + 1, seconds);
+        break;
+      case KeplerOrbit::propagator_type::ELLIPTIC:
+        propagateRows<EllipticPropagator>(row, row + 1, seconds);
+        break;
+      case KeplerOrbit::propagator_type::HYPERBOLIC:
+        propagateRows<HyperbolicPropagator>(row, row + 1, seconds);
+        break;
+    }
+  }
+}
+
+size_t OrbitalStateArray::groupSize(
+    KeplerOrbit::propagator_type const propagator) const noexcept
+{
+  size_t const p = static_cast<size_t>(propagator);
+  return m_bounds[p + 1] - m_bounds[p];
+}
+
+void OrbitalStateArray::propagateGroup(
+    KeplerOrbit::propagator_type const propagator,
+    size_t const begin,
+    size_t const end,
+    second_type const seconds) noexcept
+{
+  assert(end <= groupSize(propagator));
+
+  size_t const first = m_bounds[static_cast<size_t>(propagator)];
+  switch (propagator) {
+    case KeplerOrbit::propagator_type::CIRCULAR:
+      propagateRows<CircularPropagator>(first + begin, first + end, seconds);
+      break;
+    case KeplerOrbit::propagator_type::ELLIPTIC:
+      propagateRows<EllipticPropagator>(first + begin, first + end, seconds);
+      break;
+    case KeplerOrbit::propagator_type::HYPERBOLIC:
+      propagateRows<HyperbolicPropagator>(first + begin, first + end, \
+          seconds);
+      break;
+  }
+}
+
+OrbitalState OrbitalStateArray::predict(
+    size_t const slot,
+    second_type const seconds) const
+{
+  assert(slot < size());
+
+  size_t const row = m_rows[slot];
+  double const e = m_eccentricity[row];
+  second_type const time = m_time[row] + seconds;
+  radian_type const mean = m_meanMotion[row] * time;
+
+  KeplerOrbit const orbit(m_semimajorAxis[row], e, m_inclination[row],
+      m_longitudeOfAscendingNode[row], m_argumentOfPeriapsis[row],
+      m_parentMass[row]);
+
+  radian_type anomally = 0;
+  radian_type trueAnomally = 0;
+  solveRow(row, mean, &anomally, &trueAnomally);
+
+  return OrbitalState(orbit, trueAnomally, anomally, mean, time);
+}
+
+void OrbitalStateArray::predictState(
+    size_t const slot,
+    second_type const seconds,
+    Vector3D * const position,
+    Vector3D * const velocity) const noexcept
+{
+  assert(slot < size());
+
+  size_t const row = m_rows[slot];
+  radian_type const mean = m_meanMotion[row] * (m_time[row] + seconds);
+
+  radian_type anomally = 0;
+  radian_type trueAnomally = 0;
+  solveRow(row, mean, &anomally, &trueAnomally);
+
+  OrbitalState::evaluateState(m_perifocalP[row], m_perifocalQ[row], \
+      m_semimajorAxis[row], m_semiminorAxis[row], m_eccentricity[row], \
+      m_meanMotion[row], anomally, position, velocity);
+}
+
+second_type OrbitalStateArray::period(
+    size_t const slot) const noexcept
+{
+  double const meanMotion = m_meanMotion[m_rows[slot]];
+  return meanMotion != 0.0 ? 2.0 * Constants::PI / meanMotion : 0.0;
+}
+
+Vector3D OrbitalStateArray::position(
+    size_t const slot) const
+{
+  size_t const row = m_rows[slot];
+  return OrbitalState::evaluatePosition(m_perifocalP[row], \
+      m_perifocalQ[row], m_semimajorAxis[row], m_semiminorAxis[row], \
+      m_eccentricity[row], m_eccentricAnomally[row]);
+}
+
+Vector3D OrbitalStateArray::velocity(
+    size_t const slot) const
+{
+  Vector3D position;
+  Vector3D velocity;
+  state(slot, &position, &velocity);
+
+  return velocity;
+}
+
+void OrbitalStateArray::localPositions(
+    size_t const begin,
+    size_t const end,
+    Vector3F * const positions) const noexcept
+{
+  assert(end <= size());
+
+  double const tau = 2.0 * Constants::PI;
+
+  // the policy of each row selects the formula for the shape of its orbit,
+  // and free rows hold a closed orbit at the origin
+  for (size_t slot = begin; slot < end; ++slot) {
+    size_t const row = m_rows[slot];
+    if (m_propagator[row] != KeplerOrbit::propagator_type::HYPERBOLIC) {
+      // only the turns are removed in double precision
+      double const eccentric = m_eccentricAnomally[row];
+      float const anomally = static_cast<float>(eccentric - \
+          tau * std::floor(eccentric / tau + 0.5));
+      float const cos_E = std::cos(anomally);
+      float const sin_E = std::sin(anomally);
+
+      positions[slot - begin] = \
+          m_singleP[row] * (cos_E - m_singleEccentricity[row]) + \
+          m_singleQ[row] * sin_E;
+    } else {
+      float const anomally = static_cast<float>(m_eccentricAnomally[row]);
+      float const cosh_H = std::cosh(anomally);
+      float const sinh_H = std::sinh(anomally);
+      float const excess = static_cast<float>(m_eccentricity[row] - 1.0);
+
+      positions[slot - begin] = \
+          m_singleP[row] * (sinh_H*sinh_H / (cosh_H + 1.0f) - excess) + \
+          m_singleQ[row] * sinh_H;
+    }
+  }
+}
+
+void OrbitalStateArray::state(
+    size_t const slot,
+    Vector3D * const position,
+    Vector3D * const velocity) const noexcept
+{
+  size_t const row = m_rows[slot];
+  OrbitalState::evaluateState(m_perifocalP[row], m_perifocalQ[row], \
+      m_semimajorAxis[row], m_semiminorAxis[row], m_eccentricity[row], \
+      m_meanMotion[row], m_eccentricAnomally[row], position, velocity);
+}
+
+void OrbitalStateArray::state(
+    size_t const begin,
+    size_t const end,
+    Vector3D * const positions,
+    Vector3D * const velocities) const noexcept
+{
+  assert(end <= size());
+
+  for (size_t slot = begin; slot < end; ++slot) {
+    state(slot, positions + (slot - begin), velocities + (slot - begin));
+  }
+}
+
+meter_type OrbitalStateArray::periapsis(
+    size_t const slot) const noexcept
+{
+  size_t const row = m_rows[slot];
+  return m_semimajorAxis[row] * (1.0 - m_eccentricity[row]);
+}
+
+meter_type OrbitalStateArray::apoapsis(
+    size_t const slot) const noexcept
+{
+  size_t const row = m_rows[slot];
+  if (m_eccentricity[row] >= 1.0) {
+    return INFINITY;
+  }
+
+  return m_semimajorAxis[row] * (1.0 + m_eccentricity[row]);
+}
+
+double OrbitalStateArray::maxSpeed(
+    size_t const slot) const noexcept
+{
+  size_t const row = m_rows[slot];
+  if (m_meanMotion[row] == 0.0) {
+    return 0.0;
+  }
+
+  return std::sqrt(OrbitFormula::mu(m_parentMass[row]) * \
+      (2.0 / periapsis(slot) - 1.0 / m_semimajorAxis[row]));
+}
+
+meter_type OrbitalStateArray::sphereOfInfluence(
+    size_t const slot,
+    kilo_type const mass) const noexcept
+{
+  size_t const row = m_rows[slot];
+  meter_type const distance = m_eccentricity[row] < 1.0 ? \
+      m_semimajorAxis[row] : periapsis(slot);
+
+  return distance * std::pow(mass / m_parentMass[row], 0.4);
+}
+
+
+/******************************************************************************
+* PRIVATE METHODS *************************************************************
+******************************************************************************/
+
+size_t OrbitalStateArray::partition(
+    size_t const row) const noexcept
+{
+  size_t part = 0;
+  while (row >= m_bounds[part + 1]) {
+    ++part;
+  }
+
+  return part;
+}
+
+void OrbitalStateArray::relocate(
+    size_t const slot,
+    size_t const target) noexcept
+{
+  // each step crosses one boundary, moving the row to the near end of the
+  // next partition, and the row it displaces to the far end of its own
+  size_t part = partition(m_rows[slot]);
+  while (part < target) {
+    swapRows(m_rows[slot], m_bounds[part + 1] - 1);
+    --m_bounds[part + 1];
+    ++part;
+  }
+  while (part > target) {
+    swapRows(m_rows[slot], m_bounds[part]);
+    ++m_bounds[part];
+    --part;
+  }
+}
+
+void OrbitalStateArray::swapRows(
+    size_t const a,
+    size_t const b) noexcept
+{
+  if (a == b) {
+    return;
+  }
+
+  std::swap(m_semimajorAxis[a], m_semimajorAxis[b]);
+  std::swap(m_eccentricity[a], m_eccentricity[b]);
+  std::swap(m_inclination[a], m_inclination[b]);
+  std::swap(m_longitudeOfAscendingNode[a], m_longitudeOfAscendingNode[b]);
+  std::swap(m_argumentOfPeriapsis[a], m_argumentOfPeriapsis[b]);
+  std::swap(m_parentMass[a], m_parentMass[b]);
+  std::swap(m_meanMotion[a], m_meanMotion[b]);
+  std::swap(m_perifocalP[a], m_perifocalP[b]);
+  std::swap(m_perifocalQ[a], m_perifocalQ[b]);
+  std::swap(m_semiminorAxis[a], m_semiminorAxis[b]);
+  std::swap(m_halfAngleRatio[a], m_halfAngleRatio[b]);
+  std::swap(m_propagator[a], m_propagator[b]);
+  std::swap(m_singleP[a], m_singleP[b]);
+  std::swap(m_singleQ[a], m_singleQ[b]);
+  std::swap(m_singleEccentricity[a], m_singleEccentricity[b]);
+  std::swap(m_time[a], m_time[b]);
+  std::swap(m_meanAnomally[a], m_meanAnomally[b]);
+  std::swap(m_eccentricAnomally[a], m_eccentricAnomally[b]);
+  std::swap(m_trueAnomally[a], m_trueAnomally[b]);
+
+  std::swap(m_slots[a], m_slots[b]);
+  m_rows[m_slots[a]] = a;
+  m_rows[m_slots[b]] = b;
+}
+
+void OrbitalStateArray::solveRow(
+    size_t const row,
+    radian_type const mean,
+    radian_type * const anomally,
+    radian_type * const trueAnomally) const noexcept
+{
+  double const e = m_eccentricity[row];
+  double const ratio = m_halfAngleRatio[row];
+  switch (m_propagator[row]) {
+    case KeplerOrbit::propagator_type::CIRCULAR:
+      CircularPropagator::solve(mean, e, ratio, anomally, trueAnomally);
+      break;
+    case KeplerOrbit::propagator_type::ELLIPTIC:
+      EllipticPropagator::solve(mean, e, ratio, anomally, trueAnomally);
+      break;
+    case KeplerOrbit::propagator_type::HYPERBOLIC:
+      HyperbolicPropagator::solve(mean, e, ratio, anomally, trueAnomally);
+      break;
+  }
+}
+
+template<typename P>
+void OrbitalStateArray::propagateRows(
+    size_t const begin,
+    size_t const end,
+    second_type const seconds) noexcept
+{
+  // the rows are contiguous, so advancing the mean anomallies has no
+  // indirection, and every orbit has the same shape, so solving for the
+  // other anomallies has no branches on the policy
+  for (size_t row = begin; row < end; ++row) {
+    m_time[row] += seconds;
+    m_meanAnomally[row] = m_meanMotion[row] * m_time[row];
+  }
+
+  for (size_t row = begin; row < end; ++row) {
+    P::solve(m_meanAnomally[row], m_eccentricity[row], \
+        m_halfAngleRatio[row], &m_eccentricAnomally[row], \
+        &m_trueAnomally[row]);
+  }
+}
+
+}
@@ -21,6 +21,23 @@ std::ostream& operator<<(
   return os;
 }
 
+std::ostream& operator<<(
+    std::ostream& os,
+    Vector3F const vec)
+{
+  os << "Vector3F{" << vec.x() << " " << vec.y() << " " << vec.z() << "}";
+  return os;
+}
+
+std::ostream& operator<<(
+    std::ostream& os,
+    CompactVector3D const vec)
+{
+  os << "CompactVector3D{" << vec.x() << " " << vec.y() << " " << vec.z() << \
+      "}";
+  return os;
+}
+
 std::ostream& operator<<(
     std::ostream& os,
     Rotation const rot)
@@ -29,4 +46,30 @@ std::ostream& operator<<(
   return os;
 }
 
+std::ostream& operator<<(
+    std::ostream& os,
+    Quaternion const quat)
+{
+  os << "Quaternion{" << quat.w() << " " << quat.x() << " " << quat.y() << \
+      " " << quat.z() << "}";
+  return os;
+}
+
+std::ostream& operator<<(
+    std::ostream& os,
+    Matrix3D const & mat)
+{
+  os << "Matrix3D{" << mat.row(0) << "," << mat.row(1) << "," << \
+      mat.row(2) << "}";
+  return os;
+}
+
+std::ostream& operator<<(
+    std::ostream& os,
+    BodyHandle const handle)
+{
+  os << "BodyHandle{" << handle.slot() << "," << handle.generation() << "}";
+  return os;
+}
+
 }
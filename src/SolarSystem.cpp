@@ -8,30 +8,102 @@
 */
 
 #include "SolarSystem.hpp"
+#include "CompactVector3D.hpp"
+#include "OrbitFormula.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_set>
 
 namespace gravitree
 {
 
 
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+namespace
+{
+
+// the smallest batch of queries worth splitting between threads
+constexpr size_t const MIN_PARALLEL_QUERIES = 2048;
+
+// the number of times the spatial index is refit before it is rebuilt, as
+// its bounds loosen as the bodies move
+constexpr size_t const MAX_SPATIAL_REFITS = 16;
+
+// the number of samples taken per period of the fastest closed orbit when
+// bracketing closest approaches
+constexpr double const APPROACH_SAMPLES_PER_PERIOD = 16.0;
+
+// the fraction of the closest distance yet found by which an approach
+// between two samples may come closer, and the most samples taken over an
+// interval, after which that is no longer ensured
+constexpr double const APPROACH_DISTANCE_TOLERANCE = 1.0e-3;
+constexpr double const APPROACH_MAX_SAMPLES = 1048576.0;
+
+// the precision to which the time of a closest approach is found
+constexpr second_type const APPROACH_TOLERANCE = 1.0e-3;
+constexpr size_t const APPROACH_MAX_ITERATIONS = 100;
+
+}
+
+
 /******************************************************************************
 * CONSTRUCTORS / DESTRUCTOR ***************************************************
 ******************************************************************************/
 
 SolarSystem::SolarSystem(
-    Body const root) :
+    Body const root,
+    size_t const numThreads) :
   m_time(0.0),
   m_bodies(),
-  m_root(nullptr)
+  m_root(nullptr),
+  m_states(),
+  m_attitudes(),
+  m_slots(),
+  m_generations(),
+  m_pool(new ThreadPool(numThreads)),
+  m_localPositions(),
+  m_rootPositions(),
+  m_single(false),
+  m_singleLocals(),
+  m_singleRoots(),
+  m_ancestors(),
+  m_traversal(),
+  m_reparent{{}, {}, {}, {}, {}, {}, {}, {}},
+  m_spatialMutex(),
+  m_spatial(),
+  m_spatialRebuild(true),
+  m_spatialStale(true),
+  m_spatialRefits(0)
 {
+  size_t const slot = m_states.add( \
+      OrbitalState(KeplerOrbit(0, 0, 0, 0, 0, 0), 0), \
+      OrbitalStateArray::NO_PARENT);
+
   std::unique_ptr<node_struct> rootPtr(new node_struct{
       root,
-      OrbitalState(KeplerOrbit(0, 0, 0, 0, 0, 0), 0),
+      slot,
       nullptr,
-      {}});
+      {},
+      INFINITY,
+      0.0,
+      0.0});
   m_root = rootPtr.get();
 
+  m_slots.emplace_back(m_root);
+  m_generations.emplace_back(0);
+  m_localPositions.emplace_back();
+  m_rootPositions.emplace_back();
+  m_singleLocals.emplace_back();
+  m_singleRoots.emplace_back();
+  m_ancestors.add(slot, AncestorIndex::NO_PARENT);
+  m_attitudes.add(slot, Quaternion(), root.angularVelocity());
+
   m_bodies.emplace(m_root->body.id(), std::move(rootPtr));
 }
 
@@ -43,163 +115,1294 @@ void SolarSystem::tick(
     second_type const seconds)
 {
   m_time += seconds;
+
+  // each body only depends on its own state, so how the range is split
+  // between threads cannot change the result. The bodies are propagated in
+  // groups by policy, both so that each group runs the kernel of its policy
+  // and so that the threads split the more costly policies evenly.
+  for (size_t p = 0; p < KeplerOrbit::NUM_PROPAGATORS; ++p) {
+    KeplerOrbit::propagator_type const propagator = \
+        static_cast<KeplerOrbit::propagator_type>(p);
+    m_pool->parallelFor(m_states.groupSize(propagator),
+        [this, propagator, seconds](size_t const begin, size_t const end) {
+      m_states.propagateGroup(propagator, begin, end, seconds);
+    });
+  }
+  m_pool->parallelFor(m_attitudes.size(),
+      [this, seconds](size_t const begin, size_t const end) {
+    m_attitudes.propagate(begin, end, seconds);
+  });
+
+  reparentBodies();
+
+  // the queries made until the next tick only read these
+  updateLocalPositions();
+  updateRootPositions(m_root);
+  m_ancestors.update();
+}
+
+void SolarSystem::setNumThreads(
+    size_t const numThreads)
+{
+  if (numThreads != m_pool->numThreads()) {
+    m_pool.reset(new ThreadPool(numThreads));
+  }
+}
+
+size_t SolarSystem::numThreads() const noexcept
+{
+  return m_pool->numThreads();
 }
 
-void SolarSystem::addBody(
+void SolarSystem::setSinglePrecision(
+    bool const enabled)
+{
+  if (enabled && !m_single) {
+    m_single = true;
+    updateLocalPositions();
+    updateRootPositions(m_root);
+  }
+  m_single = enabled;
+}
+
+bool SolarSystem::singlePrecision() const noexcept
+{
+  return m_single;
+}
+
+BodyHandle SolarSystem::addBody(
     Body const body,
     Vector3D const position,
     Vector3D const velocity,
     Body::id_type const parent)
 {
-  node_struct * const parentNode = m_bodies.at(parent).get();
+  node_struct * const parentNode = findNode(parent);
+
+  OrbitalState const state = OrbitalState::fromVectors( \
+      position, velocity, parentNode->body.mass());
+
+  return addNode(body, state, parentNode);
+}
+
+BodyHandle SolarSystem::addBody(
+    Body const body,
+    Vector3D const position,
+    Vector3D const velocity,
+    BodyHandle const parent)
+{
+  node_struct * const parentNode = findNode(parent);
 
   OrbitalState const state = OrbitalState::fromVectors( \
       position, velocity, parentNode->body.mass());
 
-  addBody(body, state, parent);
+  return addNode(body, state, parentNode);
 }
 
-void SolarSystem::addBody(
+BodyHandle SolarSystem::addBody(
     Body const body,
     OrbitalState const state,
     Body::id_type const parent)
 {
-  node_struct * const parentNode = m_bodies.at(parent).get();
-
-  std::unique_ptr<node_struct> ptr(new node_struct{body, state, parentNode, {}});
+  return addNode(body, state, findNode(parent));
+}
 
-  parentNode->children.emplace_back(ptr.get());
+BodyHandle SolarSystem::addBody(
+    Body const body,
+    OrbitalState const state,
+    BodyHandle const parent)
+{
+  return addNode(body, state, findNode(parent));
+}
 
-  m_bodies.emplace(body.id(), std::move(ptr));
+void SolarSystem::addBodies(
+    CatalogBody const * const bodies,
+    size_t const num)
+{
+  addBodies(bodies, nullptr, num);
 }
 
-void SolarSystem::removeBody(
-    Body::id_type const id)
+void SolarSystem::addBodies(
+    CatalogBody const * const bodies,
+    KeplerOrbit::derived_struct const * const orbits,
+    size_t const num)
 {
-  node_struct * const node = m_bodies.at(id).get();
-  if (node->parent != nullptr) {
-    throw InvalidOperationException("Remove root");
+  // check the whole catalog first, so that a bad entry leaves the system
+  // unchanged
+  std::unordered_set<Body::id_type> added;
+  for (size_t i = 0; i < num; ++i) {
+    CatalogBody const & entry = bodies[i];
+    if (entry.isRoot()) {
+      if (entry.id() != m_root->body.id()) {
+        throw std::invalid_argument("Catalog root is not the system root");
+      }
+    } else if (m_bodies.count(entry.id()) > 0 || \
+        added.count(entry.id()) > 0) {
+      throw InvalidOperationException("Duplicate body id");
+    } else if (m_bodies.count(entry.parent()) == 0 && \
+        added.count(entry.parent()) == 0) {
+      // checked before the id is added, so no body can orbit itself
+      throw std::out_of_range("Catalog body orbits an unknown body");
+    } else {
+      added.insert(entry.id());
+    }
   }
 
-  Vector3D const offsetPos = node->state.position();
-  Vector3D const offsetVel = node->state.velocity();
+  for (size_t i = 0; i < num; ++i) {
+    CatalogBody const & entry = bodies[i];
+    if (entry.isRoot()) {
+      continue;
+    }
 
-  for (node_struct * const child : node->children) {
-    Vector3D const pos = offsetPos + child->state.position();
-    Vector3D const vel = offsetVel + child->state.velocity();
+    node_struct * const parentNode = findNode(entry.parent());
+    kilo_type const parentMass = parentNode->body.mass();
+    KeplerOrbit const orbit = orbits != nullptr && \
+        orbits[i].mu == OrbitFormula::mu(parentMass) ? \
+        KeplerOrbit(entry.semimajorAxis(), entry.eccentricity(), \
+            entry.inclination(), entry.longitudeOfAscendingNode(), \
+            entry.argumentOfPeriapsis(), parentMass, orbits[i]) : \
+        KeplerOrbit(entry.semimajorAxis(), entry.eccentricity(), \
+            entry.inclination(), entry.longitudeOfAscendingNode(), \
+            entry.argumentOfPeriapsis(), parentMass);
+    addNode(Body(entry.id(), entry.mass()), \
+        OrbitalState(orbit, entry.trueAnomally()), parentNode);
+  }
+}
 
-    child->state = OrbitalState::fromVectors(pos, vel, \
-        node->parent->body.mass());
+void SolarSystem::removeBody(
+    Body::id_type const id)
+{
+  removeNode(findNode(id));
+}
 
-    node->parent->children.emplace_back(child);
-  }
+void SolarSystem::removeBody(
+    BodyHandle const handle)
+{
+  removeNode(findNode(handle));
+}
 
-  m_bodies.erase(id); 
+BodyHandle SolarSystem::getHandle(
+    Body::id_type const id) const
+{
+  size_t const slot = findNode(id)->slot;
+  return BodyHandle(slot, m_generations[slot]);
+}
+
+bool SolarSystem::isValid(
+    BodyHandle const handle) const noexcept
+{
+  return handle.slot() < m_slots.size() && \
+      m_slots[handle.slot()] != nullptr && \
+      m_generations[handle.slot()] == handle.generation();
 }
 
 Body const * SolarSystem::getBody(
     Body::id_type const id) const
 {
-  return &m_bodies.at(id)->body;
+  return &findNode(id)->body;
 }
 
 Body * SolarSystem::getBody(
     Body::id_type const id)
 {
-  return &m_bodies.at(id)->body;
+  return &findNode(id)->body;
+}
+
+Body const * SolarSystem::getBody(
+    BodyHandle const handle) const
+{
+  return &findNode(handle)->body;
+}
+
+Body * SolarSystem::getBody(
+    BodyHandle const handle)
+{
+  return &findNode(handle)->body;
+}
+
+void SolarSystem::setMass(
+    Body::id_type const id,
+    kilo_type const mass)
+{
+  setNodeMass(findNode(id), mass);
+}
+
+void SolarSystem::setMass(
+    BodyHandle const handle,
+    kilo_type const mass)
+{
+  setNodeMass(findNode(handle), mass);
+}
+
+Body const * SolarSystem::getParent(
+    Body::id_type const id) const
+{
+  node_struct const * const parent = findNode(id)->parent;
+  return parent != nullptr ? &parent->body : nullptr;
+}
+
+Body const * SolarSystem::getParent(
+    BodyHandle const handle) const
+{
+  node_struct const * const parent = findNode(handle)->parent;
+  return parent != nullptr ? &parent->body : nullptr;
+}
+
+Quaternion SolarSystem::getOrientation(
+    Body::id_type const id) const
+{
+  return m_attitudes.orientation(findNode(id)->slot);
+}
+
+Quaternion SolarSystem::getOrientation(
+    BodyHandle const handle) const
+{
+  return m_attitudes.orientation(findNode(handle)->slot);
+}
+
+void SolarSystem::getOrientations(
+    std::vector<std::pair<Body const *, Quaternion>> * const list) const
+{
+  list->clear();
+  for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+    node_struct const * const node = m_slots[slot];
+    if (node != nullptr) {
+      list->emplace_back(&node->body, m_attitudes.orientation(slot));
+    }
+  }
+}
+
+void SolarSystem::setOrientation(
+    Body::id_type const id,
+    Quaternion const orientation)
+{
+  m_attitudes.setOrientation(findNode(id)->slot, orientation);
+}
+
+void SolarSystem::setOrientation(
+    BodyHandle const handle,
+    Quaternion const orientation)
+{
+  m_attitudes.setOrientation(findNode(handle)->slot, orientation);
+}
+
+void SolarSystem::setAngularVelocity(
+    Body::id_type const id,
+    Rotation const velocity)
+{
+  node_struct * const node = findNode(id);
+  node->body.setAngularVelocity(velocity);
+  m_attitudes.setAngularVelocity(node->slot, velocity);
+}
+
+void SolarSystem::setAngularVelocity(
+    BodyHandle const handle,
+    Rotation const velocity)
+{
+  node_struct * const node = findNode(handle);
+  node->body.setAngularVelocity(velocity);
+  m_attitudes.setAngularVelocity(node->slot, velocity);
 }
 
 Vector3D SolarSystem::getBodyPositionRelativeTo(
       Body::id_type const queryBody,
       Body::id_type const relativeRoot) const
 {
-  node_struct const * const origin = m_bodies.at(relativeRoot).get();
-  node_struct const * const destination = m_bodies.at(queryBody).get();
+  size_t const query = findNode(queryBody)->slot;
+  size_t const root = findNode(relativeRoot)->slot;
 
-  // find the parent nodes 
-  std::vector<std::pair<Body::id_type, Vector3D>> originParents;
-  node_struct const * parent = origin;
-  Vector3D originOffset;
-  while (parent != nullptr) {
-    originParents.emplace_back(parent->body.id(), originOffset);
-    originOffset += parent->state.position(); 
-    parent = parent->parent;
-  }
+  return pathOffset(query, root);
+}
 
-  std::vector<std::pair<Body::id_type, Vector3D>> destinationParents;
-  parent = destination;
-  Vector3D destinationOffset;
-  while (parent != nullptr) {
-    destinationParents.emplace_back(parent->body.id(), destinationOffset);
-    destinationOffset += parent->state.position(); 
-    parent = parent->parent;
-  }
+Vector3D SolarSystem::getBodyPositionRelativeTo(
+      BodyHandle const queryBody,
+      BodyHandle const relativeRoot) const
+{
+  size_t const query = findNode(queryBody)->slot;
+  size_t const root = findNode(relativeRoot)->slot;
 
-  // iterate down to find the last common parent
-  size_t i = 1;
-  while ((*(originParents.end() - i)).first != \
-         (*(destinationParents.end() - i)).first) {
-    assert(i <= originParents.size());
-    assert(i <= destinationParents.size());
-    ++i;
-  }
+  return pathOffset(query, root);
+}
+
+Vector3D SolarSystem::getBodyPositionRelativeTo(
+      Body::id_type const queryBody,
+      Body::id_type const relativeRoot,
+      frame_type const frame) const
+{
+  size_t const query = findNode(queryBody)->slot;
+  size_t const root = findNode(relativeRoot)->slot;
+
+  return frameOf(root, frame) * pathOffset(query, root);
+}
 
-  return (*(destinationParents.end()-i)).second - \
-         (*(originParents.end()-i)).second;
+Vector3D SolarSystem::getBodyPositionRelativeTo(
+      BodyHandle const queryBody,
+      BodyHandle const relativeRoot,
+      frame_type const frame) const
+{
+  size_t const query = findNode(queryBody)->slot;
+  size_t const root = findNode(relativeRoot)->slot;
+
+  return frameOf(root, frame) * pathOffset(query, root);
 }
 
 std::vector<std::pair<Body const *, Vector3D>>
     SolarSystem::getRelativeTo(
         Body::id_type const id) const
 {
-  // start with children nodes
   std::vector<std::pair<Body const *, Vector3D>> list;
-  list.reserve(m_bodies.size());
+  relativeTo(findNode(id)->slot, frame_type::INERTIAL, &list);
+  return list;
+}
+
+std::vector<std::pair<Body const *, Vector3D>>
+    SolarSystem::getRelativeTo(
+        BodyHandle const handle) const
+{
+  std::vector<std::pair<Body const *, Vector3D>> list;
+  relativeTo(findNode(handle)->slot, frame_type::INERTIAL, &list);
+  return list;
+}
+
+void SolarSystem::getRelativeTo(
+    Body::id_type const id,
+    std::vector<std::pair<Body const *, Vector3D>> * const list) const
+{
+  relativeTo(findNode(id)->slot, frame_type::INERTIAL, list);
+}
+
+void SolarSystem::getRelativeTo(
+    BodyHandle const handle,
+    std::vector<std::pair<Body const *, Vector3D>> * const list) const
+{
+  relativeTo(findNode(handle)->slot, frame_type::INERTIAL, list);
+}
+
+void SolarSystem::getRelativeTo(
+    Body::id_type const id,
+    std::vector<std::pair<Body const *, Vector3F>> * const list) const
+{
+  relativeTo(findNode(id)->slot, frame_type::INERTIAL, list);
+}
+
+void SolarSystem::getRelativeTo(
+    BodyHandle const handle,
+    std::vector<std::pair<Body const *, Vector3F>> * const list) const
+{
+  relativeTo(findNode(handle)->slot, frame_type::INERTIAL, list);
+}
+
+void SolarSystem::getRelativeTo(
+    Body::id_type const id,
+    frame_type const frame,
+    std::vector<std::pair<Body const *, Vector3D>> * const list) const
+{
+  relativeTo(findNode(id)->slot, frame, list);
+}
+
+void SolarSystem::getRelativeTo(
+    BodyHandle const handle,
+    frame_type const frame,
+    std::vector<std::pair<Body const *, Vector3D>> * const list) const
+{
+  relativeTo(findNode(handle)->slot, frame, list);
+}
+
+void SolarSystem::getRelativeTo(
+    Body::id_type const id,
+    frame_type const frame,
+    std::vector<std::pair<Body const *, Vector3F>> * const list) const
+{
+  relativeTo(findNode(id)->slot, frame, list);
+}
+
+void SolarSystem::getRelativeTo(
+    BodyHandle const handle,
+    frame_type const frame,
+    std::vector<std::pair<Body const *, Vector3F>> * const list) const
+{
+  relativeTo(findNode(handle)->slot, frame, list);
+}
+
+void SolarSystem::getBodyPositionsRelativeTo(
+    std::pair<Body::id_type, Body::id_type> const * const queries,
+    size_t const numQueries,
+    Vector3D * const positions) const
+{
+  batchPositions(queries, numQueries, positions);
+}
+
+void SolarSystem::getBodyPositionsRelativeTo(
+    std::pair<BodyHandle, BodyHandle> const * const queries,
+    size_t const numQueries,
+    Vector3D * const positions) const
+{
+  batchPositions(queries, numQueries, positions);
+}
+
+void SolarSystem::getBodiesWithin(
+    Body::id_type const body,
+    meter_type const radius,
+    std::vector<Body const *> * const list) const
+{
+  size_t const slot = findNode(body)->slot;
+  bodiesWithin(m_rootPositions[slot], radius, list);
+}
+
+void SolarSystem::getBodiesWithin(
+    BodyHandle const body,
+    meter_type const radius,
+    std::vector<Body const *> * const list) const
+{
+  size_t const slot = findNode(body)->slot;
+  bodiesWithin(m_rootPositions[slot], radius, list);
+}
+
+void SolarSystem::getBodiesWithin(
+    Vector3D const point,
+    Body::id_type const relativeRoot,
+    meter_type const radius,
+    std::vector<Body const *> * const list) const
+{
+  size_t const slot = findNode(relativeRoot)->slot;
+  bodiesWithin(m_rootPositions[slot] + point, radius, list);
+}
+
+void SolarSystem::getBodiesWithin(
+    Vector3D const point,
+    BodyHandle const relativeRoot,
+    meter_type const radius,
+    std::vector<Body const *> * const list) const
+{
+  size_t const slot = findNode(relativeRoot)->slot;
+  bodiesWithin(m_rootPositions[slot] + point, radius, list);
+}
+
+void SolarSystem::getBodiesInside(
+    Vector3D const min,
+    Vector3D const max,
+    Body::id_type const relativeRoot,
+    std::vector<Body const *> * const list) const
+{
+  size_t const slot = findNode(relativeRoot)->slot;
+  Vector3D const origin = m_rootPositions[slot];
+  bodiesInside(origin + min, origin + max, list);
+}
+
+void SolarSystem::getBodiesInside(
+    Vector3D const min,
+    Vector3D const max,
+    BodyHandle const relativeRoot,
+    std::vector<Body const *> * const list) const
+{
+  size_t const slot = findNode(relativeRoot)->slot;
+  Vector3D const origin = m_rootPositions[slot];
+  bodiesInside(origin + min, origin + max, list);
+}
+
+Approach SolarSystem::findClosestApproach(
+    Body::id_type const body,
+    Body::id_type const other,
+    second_type const start,
+    second_type const end) const
+{
+  return findClosestApproach(getHandle(body), getHandle(other), start, end);
+}
+
+Approach SolarSystem::findClosestApproach(
+    BodyHandle const body,
+    BodyHandle const other,
+    second_type const start,
+    second_type const end) const
+{
+  if (!(start <= end)) {
+    throw std::invalid_argument("Invalid time interval");
+  }
+
+  node_struct const * const otherNode = findNode(other);
+  size_t const slot = findNode(body)->slot;
 
-  node_struct const * node = m_bodies.at(id).get();
-  Vector3D origin = node->state.position();
+  std::vector<std::pair<size_t, double>> path;
+  approachPath(slot, otherNode->slot, &path);
 
-  getTreeRelativeTo(-origin, node, &list);
+  std::pair<second_type, meter_type> const closest = \
+      closestApproach(path, start, end);
 
-  // scan up the tree adding nodes, when siblings are encountered add their
-  // trees
-  node_struct const * parent = node->parent;
-  while (parent != nullptr) {
-    list.emplace_back(&parent->body, -origin);
+  return Approach(&otherNode->body, closest.first, closest.second);
+}
 
-    for (node_struct const * const sibling : parent->children) {
-      if (sibling != node) {
-        getTreeRelativeTo(-origin, sibling, &list);
+void SolarSystem::findClosestApproaches(
+    Body::id_type const body,
+    second_type const start,
+    second_type const end,
+    meter_type const threshold,
+    std::vector<Approach> * const list) const
+{
+  findClosestApproaches(getHandle(body), start, end, threshold, list);
+}
+
+void SolarSystem::findClosestApproaches(
+    BodyHandle const body,
+    second_type const start,
+    second_type const end,
+    meter_type const threshold,
+    std::vector<Approach> * const list) const
+{
+  if (!(start <= end)) {
+    throw std::invalid_argument("Invalid time interval");
+  }
+
+  size_t const slot = findNode(body)->slot;
+
+  std::vector<std::pair<second_type, meter_type>> closest(m_slots.size(), \
+      std::make_pair(0.0, INFINITY));
+  m_pool->parallelFor(m_slots.size(),
+      [this, slot, start, end, threshold, &closest](
+          size_t const begin,
+          size_t const last) {
+    std::vector<std::pair<size_t, double>> path;
+    for (size_t other = begin; other < last; ++other) {
+      if (other == slot || m_slots[other] == nullptr || \
+          minimumDistance(slot, other) > threshold) {
+        continue;
       }
+
+      approachPath(slot, other, &path);
+      closest[other] = closestApproach(path, start, end);
     }
+  });
 
-    // move up the tree
-    node = parent;
-    parent = node->parent;
-    origin += node->state.position();
+  list->clear();
+  for (size_t other = 0; other < closest.size(); ++other) {
+    if (closest[other].second <= threshold) {
+      list->emplace_back(&m_slots[other]->body, closest[other].first, \
+          closest[other].second);
+    }
   }
-
-  return list;
 }
 
 /******************************************************************************
 * PRIVATE METHODS *************************************************************
 ******************************************************************************/
 
-void SolarSystem::getTreeRelativeTo(
-      Vector3D const origin,
-      node_struct const * const node,
-      std::vector<std::pair<Body const *, Vector3D>> * const list) const
+SolarSystem::node_struct * SolarSystem::findNode(
+    Body::id_type const id) const
+{
+  return m_bodies.at(id).get();
+}
+
+SolarSystem::node_struct * SolarSystem::findNode(
+    BodyHandle const handle) const
+{
+  if (!isValid(handle)) {
+    throw std::out_of_range("Stale or invalid body handle");
+  }
+
+  return m_slots[handle.slot()];
+}
+
+BodyHandle SolarSystem::addNode(
+    Body const & body,
+    OrbitalState const & state,
+    node_struct * const parentNode)
+{
+  if (m_bodies.count(body.id()) > 0) {
+    throw InvalidOperationException("Duplicate body id");
+  }
+
+  size_t const slot = m_states.add(state, parentNode->slot);
+
+  std::unique_ptr<node_struct> ptr(new node_struct{body, slot, parentNode, {}, \
+      0.0, 0.0, 0.0});
+  updateSphere(ptr.get());
+
+  attachChild(parentNode, ptr.get());
+
+  if (slot == m_slots.size()) {
+    m_slots.emplace_back();
+    m_generations.emplace_back(0);
+    m_localPositions.emplace_back();
+    m_rootPositions.emplace_back();
+    m_singleLocals.emplace_back();
+    m_singleRoots.emplace_back();
+  }
+  m_slots[slot] = ptr.get();
+  m_ancestors.add(slot, parentNode->slot);
+  m_ancestors.update();
+  m_attitudes.add(slot, Quaternion(), body.angularVelocity());
+  m_spatialRebuild = true;
+  updateLocalPosition(slot);
+  updateRootPositions(ptr.get());
+
+  m_bodies.emplace(body.id(), std::move(ptr));
+
+  return BodyHandle(slot, m_generations[slot]);
+}
+
+void SolarSystem::removeNode(
+    node_struct * const node)
+{
+  node_struct * const parent = node->parent;
+  if (parent == nullptr) {
+    throw InvalidOperationException("Remove root");
+  }
+
+  Vector3D offsetPos;
+  Vector3D offsetVel;
+  m_states.state(node->slot, &offsetPos, &offsetVel);
+
+  std::vector<node_struct*> const & children = node->children;
+  std::vector<Vector3D> positions(children.size());
+  std::vector<Vector3D> velocities(children.size());
+  std::vector<kilo_type> const masses(children.size(), parent->body.mass());
+  for (size_t i = 0; i < children.size(); ++i) {
+    m_states.state(children[i]->slot, &positions[i], &velocities[i]);
+    positions[i] += offsetPos;
+    velocities[i] += offsetVel;
+  }
+
+  std::vector<OrbitalState> states;
+  OrbitalState::fromVectors(positions.data(), velocities.data(), \
+      masses.data(), children.size(), &states);
+  for (size_t i = 0; i < children.size(); ++i) {
+    moveNode(children[i], parent, states[i]);
+    updateRootPositions(children[i]);
+  }
+
+  parent->children.erase(std::find(parent->children.begin(), \
+      parent->children.end(), node));
+
+  m_states.remove(node->slot);
+  m_ancestors.remove(node->slot);
+  m_ancestors.update();
+  m_attitudes.remove(node->slot);
+  m_slots[node->slot] = nullptr;
+  ++m_generations[node->slot];
+  m_spatialRebuild = true;
+
+  // copy the id, as erasing destroys the node
+  Body::id_type const id = node->body.id();
+  m_bodies.erase(id);
+}
+
+void SolarSystem::setNodeMass(
+    node_struct * const node,
+    kilo_type const mass)
+{
+  node->body.setMass(mass);
+
+  node_struct * const parent = node->parent;
+  if (parent != nullptr) {
+    // the siblings are sorted by mass, and the sphere grows with it
+    std::vector<node_struct*> & siblings = parent->children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+    attachChild(parent, node);
+    updateSphere(node);
+  }
+
+  // the children continue from where they are, about the new mass
+  std::vector<node_struct*> const & children = node->children;
+  std::vector<Vector3D> positions(children.size());
+  std::vector<Vector3D> velocities(children.size());
+  std::vector<kilo_type> const masses(children.size(), mass);
+  for (size_t i = 0; i < children.size(); ++i) {
+    m_states.state(children[i]->slot, &positions[i], &velocities[i]);
+  }
+
+  std::vector<OrbitalState> states;
+  OrbitalState::fromVectors(positions.data(), velocities.data(), \
+      masses.data(), children.size(), &states);
+  for (size_t i = 0; i < children.size(); ++i) {
+    size_t const slot = children[i]->slot;
+    m_states.set(slot, states[i]);
+    updateSphere(children[i]);
+    updateLocalPosition(slot);
+  }
+
+  updateRootPositions(node);
+}
+
+void SolarSystem::moveNode(
+    node_struct * const node,
+    node_struct * const parent,
+    OrbitalState const & state)
+{
+  m_states.set(node->slot, state);
+  m_states.setParent(node->slot, parent->slot);
+  m_ancestors.setParent(node->slot, parent->slot);
+  node->parent = parent;
+  updateSphere(node);
+  updateLocalPosition(node->slot);
+
+  attachChild(parent, node);
+}
+
+void SolarSystem::attachChild(
+    node_struct * const parent,
+    node_struct * const child)
+{
+  // bodies of equal mass keep the order they were added in, so adding many
+  // bodies of the same mass appends them
+  std::vector<node_struct*> & children = parent->children;
+  children.insert(std::upper_bound(children.begin(), children.end(), child, \
+      [](node_struct const * const a, node_struct const * const b) {
+    return a->body.mass() > b->body.mass();
+  }), child);
+}
+
+void SolarSystem::updateSphere(
+    node_struct * const node) const
+{
+  size_t const slot = node->slot;
+  node->sphereOfInfluence = \
+      m_states.sphereOfInfluence(slot, node->body.mass());
+  node->periapsis = m_states.periapsis(slot);
+  node->apoapsis = m_states.apoapsis(slot);
+}
+
+void SolarSystem::reparentBodies()
+{
+  reparent_struct & scratch = m_reparent;
+
+  // rule out the nodes whose apsides keep them inside the sphere of their
+  // parent and outside those of their siblings, and mark the positions the
+  // checks of the rest will read
+  scratch.candidates.clear();
+  scratch.needed.clear();
+  scratch.isNeeded.resize(m_slots.size(), 0);
+  auto const need = [&scratch](size_t const slot) {
+    if (!scratch.isNeeded[slot]) {
+      scratch.isNeeded[slot] = 1;
+      scratch.needed.emplace_back(slot);
+    }
+  };
+  for (node_struct * const node : m_slots) {
+    if (node == nullptr || node->parent == nullptr) {
+      continue;
+    }
+
+    // the sphere of the root is infinite, so only nodes with a grandparent
+    // can leave their parent's
+    bool candidate = node->apoapsis > node->parent->sphereOfInfluence;
+
+    // only a more massive sibling can capture a node, and since the siblings
+    // are sorted by mass these come first
+    for (node_struct const * const sibling : node->parent->children) {
+      if (sibling->body.mass() <= node->body.mass()) {
+        break;
+      }
+      if (mayEnterSphere(node, sibling)) {
+        candidate = true;
+        need(sibling->slot);
+      }
+    }
+
+    if (candidate) {
+      scratch.candidates.emplace_back(node);
+      need(node->slot);
+    }
+  }
+
+  if (scratch.candidates.empty()) {
+    return;
+  }
+
+  m_pool->parallelFor(scratch.needed.size(),
+      [this, &scratch](size_t const begin, size_t const end) {
+    for (size_t i = begin; i < end; ++i) {
+      size_t const slot = scratch.needed[i];
+      m_localPositions[slot] = m_states.position(slot);
+      scratch.isNeeded[slot] = 0;
+    }
+  });
+
+  // find the new parents in parallel, which only reads shared state
+  scratch.captures.assign(scratch.candidates.size(), nullptr);
+  m_pool->parallelFor(scratch.candidates.size(),
+      [this, &scratch](size_t const begin, size_t const end) {
+    for (size_t i = begin; i < end; ++i) {
+      scratch.captures[i] = findSphere(scratch.candidates[i]);
+    }
+  });
+
+  // compute all of the new relative vectors before moving any node, as
+  // moving a node changes the frame of its position
+  scratch.positions.clear();
+  scratch.velocities.clear();
+  scratch.masses.clear();
+  for (size_t i = 0; i < scratch.candidates.size(); ++i) {
+    node_struct const * const parent = scratch.captures[i];
+    if (parent == nullptr) {
+      continue;
+    }
+
+    node_struct const * const node = scratch.candidates[i];
+    Vector3D position;
+    Vector3D velocity;
+    m_states.state(node->slot, &position, &velocity);
+
+    Vector3D offsetPos;
+    Vector3D offsetVel;
+    if (parent == node->parent->parent) {
+      // leaving the sphere of the old parent
+      m_states.state(node->parent->slot, &offsetPos, &offsetVel);
+      position += offsetPos;
+      velocity += offsetVel;
+    } else {
+      // entering the sphere of a sibling
+      m_states.state(parent->slot, &offsetPos, &offsetVel);
+      position -= offsetPos;
+      velocity -= offsetVel;
+    }
+
+    scratch.positions.emplace_back(position);
+    scratch.velocities.emplace_back(velocity);
+    scratch.masses.emplace_back(parent->body.mass());
+  }
+
+  // the new orbits are found together, as many bodies may cross spheres of
+  // influence in one tick
+  OrbitalState::fromVectors(scratch.positions.data(), \
+      scratch.velocities.data(), scratch.masses.data(), \
+      scratch.positions.size(), &scratch.states);
+
+  size_t move = 0;
+  for (size_t i = 0; i < scratch.candidates.size(); ++i) {
+    if (scratch.captures[i] == nullptr) {
+      continue;
+    }
+
+    node_struct * const node = scratch.candidates[i];
+    std::vector<node_struct*> & siblings = node->parent->children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+
+    moveNode(node, scratch.captures[i], scratch.states[move]);
+    ++move;
+  }
+}
+
+bool SolarSystem::mayEnterSphere(
+    node_struct const * const node,
+    node_struct const * const sibling) noexcept
+{
+  meter_type const radius = sibling->sphereOfInfluence;
+  return node->periapsis <= sibling->apoapsis + radius && \
+      node->apoapsis >= sibling->periapsis - radius;
+}
+
+SolarSystem::node_struct * SolarSystem::findSphere(
+    node_struct const * const node) const
+{
+  node_struct const * const parent = node->parent;
+  Vector3D const position = m_localPositions[node->slot];
+
+  if (node->apoapsis > parent->sphereOfInfluence && \
+      position.magnitude() > parent->sphereOfInfluence) {
+    return parent->parent;
+  }
+
+  node_struct * capture = nullptr;
+  kilo_type const mass = node->body.mass();
+  for (node_struct * const sibling : parent->children) {
+    if (sibling->body.mass() <= mass) {
+      break;
+    }
+
+    // the positions of the siblings the node cannot enter were not computed
+    if (!mayEnterSphere(node, sibling)) {
+      continue;
+    }
+
+    // prefer the smallest sphere when they overlap
+    meter_type const radius = sibling->sphereOfInfluence;
+    if (position.distance(m_localPositions[sibling->slot]) < radius && \
+        (capture == nullptr || radius < capture->sphereOfInfluence)) {
+      capture = sibling;
+    }
+  }
+
+  return capture;
+}
+
+Vector3D SolarSystem::pathOffset(
+    size_t const queryBody,
+    size_t const relativeRoot) const
 {
-  assert(origin.isValid());
+  // only sum the offsets along the paths up to the common ancestor, which
+  // keeps the result in the scale of the ancestor's frame rather than the
+  // root's
+  size_t const ancestor = \
+      m_ancestors.lowestCommonAncestor(queryBody, relativeRoot);
 
-  Vector3D const offset = node->state.position() + origin;
-  list->emplace_back(&node->body, offset);
+  // accumulated without a length, which is only needed for the result
+  CompactVector3D offset;
+  for (size_t slot = queryBody; slot != ancestor; \
+      slot = m_ancestors.parent(slot)) {
+    offset += CompactVector3D(m_localPositions[slot]);
+  }
+  for (size_t slot = relativeRoot; slot != ancestor; \
+      slot = m_ancestors.parent(slot)) {
+    offset -= CompactVector3D(m_localPositions[slot]);
+  }
+
+  return offset.toVector3D();
+}
+
+template<typename T>
+void SolarSystem::batchPositions(
+    std::pair<T, T> const * const queries,
+    size_t const numQueries,
+    Vector3D * const positions) const
+{
+  auto const answer = [this, queries, positions](
+      size_t const begin,
+      size_t const end) {
+    for (size_t i = begin; i < end; ++i) {
+      positions[i] = pathOffset(findNode(queries[i].first)->slot, \
+          findNode(queries[i].second)->slot);
+    }
+  };
+
+  if (numQueries < MIN_PARALLEL_QUERIES) {
+    answer(0, numQueries);
+  } else {
+    m_pool->parallelFor(numQueries, answer);
+  }
+}
+
+Matrix3D SolarSystem::frameOf(
+    size_t const slot,
+    frame_type const frame) const noexcept
+{
+  if (frame == frame_type::INERTIAL) {
+    return Matrix3D();
+  }
+
+  // the orientation takes vectors from the body's frame to the system's, so
+  // its inverse (the transpose) takes them back
+  return Matrix3D(m_attitudes.orientation(slot)).transposed();
+}
+
+void SolarSystem::relativeTo(
+    size_t const originSlot,
+    frame_type const frame,
+    std::vector<std::pair<Body const *, Vector3D>> * const list) const
+{
+  list->clear();
+  list->reserve(m_bodies.size());
+
+  Vector3D const origin = m_rootPositions[originSlot];
+  if (frame == frame_type::INERTIAL) {
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+      node_struct const * const node = m_slots[slot];
+      if (node != nullptr) {
+        list->emplace_back(&node->body, m_rootPositions[slot] - origin);
+      }
+    }
+  } else {
+    Matrix3D const rotation = frameOf(originSlot, frame);
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+      node_struct const * const node = m_slots[slot];
+      if (node != nullptr) {
+        list->emplace_back(&node->body, \
+            rotation * (m_rootPositions[slot] - origin));
+      }
+    }
+  }
+}
+
+void SolarSystem::relativeTo(
+    size_t const originSlot,
+    frame_type const frame,
+    std::vector<std::pair<Body const *, Vector3F>> * const list) const
+{
+  list->clear();
+  list->reserve(m_bodies.size());
+
+  // rounded only once relative to the origin, so the error does not grow
+  // with the distance of the origin from the root
+  std::vector<Vector3D> const & roots = \
+      m_single ? m_singleRoots : m_rootPositions;
+  Vector3D const origin = roots[originSlot];
+  if (frame == frame_type::INERTIAL) {
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+      node_struct const * const node = m_slots[slot];
+      if (node != nullptr) {
+        list->emplace_back(&node->body, Vector3F(roots[slot] - origin));
+      }
+    }
+  } else {
+    Matrix3D const rotation = frameOf(originSlot, frame);
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+      node_struct const * const node = m_slots[slot];
+      if (node != nullptr) {
+        list->emplace_back(&node->body, \
+            Vector3F(rotation * (roots[slot] - origin)));
+      }
+    }
+  }
+}
+
+void SolarSystem::bodiesWithin(
+    Vector3D const center,
+    meter_type const radius,
+    std::vector<Body const *> * const list) const
+{
+  updateSpatialIndex();
+
+  list->clear();
+  m_spatial.within(center, radius, [this, list](size_t const slot) {
+    list->emplace_back(&m_slots[slot]->body);
+  });
+}
+
+void SolarSystem::bodiesInside(
+    Vector3D const min,
+    Vector3D const max,
+    std::vector<Body const *> * const list) const
+{
+  updateSpatialIndex();
+
+  list->clear();
+  m_spatial.inside(min, max, [this, list](size_t const slot) {
+    list->emplace_back(&m_slots[slot]->body);
+  });
+}
+
+void SolarSystem::updateSpatialIndex() const
+{
+  // the index is shared by concurrent queries, so only one brings it up to
+  // date, and the others wait rather than use it half built
+  std::lock_guard<std::mutex> lock(m_spatialMutex);
+
+  if (m_spatialRebuild || m_spatialRefits >= MAX_SPATIAL_REFITS) {
+    std::vector<size_t> slots;
+    slots.reserve(m_bodies.size());
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+      if (m_slots[slot] != nullptr) {
+        slots.emplace_back(slot);
+      }
+    }
+    m_spatial.build(m_rootPositions.data(), slots.data(), slots.size());
+
+    m_spatialRefits = 0;
+  } else if (m_spatialStale) {
+    m_spatial.refit(m_rootPositions.data());
+
+    ++m_spatialRefits;
+  }
+
+  m_spatialRebuild = false;
+  m_spatialStale = false;
+}
+
+void SolarSystem::approachPath(
+    size_t const body,
+    size_t const other,
+    std::vector<std::pair<size_t, double>> * const path) const
+{
+  size_t const ancestor = m_ancestors.lowestCommonAncestor(body, other);
+
+  path->clear();
+  for (size_t slot = body; slot != ancestor; slot = m_ancestors.parent(slot)) {
+    path->emplace_back(slot, -1.0);
+  }
+  for (size_t slot = other; slot != ancestor; \
+      slot = m_ancestors.parent(slot)) {
+    path->emplace_back(slot, 1.0);
+  }
+}
+
+meter_type SolarSystem::minimumDistance(
+    size_t const body,
+    size_t const other) const
+{
+  size_t const ancestor = m_ancestors.lowestCommonAncestor(body, other);
+
+  // each body stays within the shell of the orbit of its ancestor just below
+  // the common one, widened by the apoapses of the orbits below that
+  meter_type inner[2] = {0.0, 0.0};
+  meter_type outer[2] = {0.0, 0.0};
+  size_t const ends[2] = {body, other};
+  for (size_t i = 0; i < 2; ++i) {
+    meter_type reach = 0.0;
+    for (size_t slot = ends[i]; slot != ancestor; \
+        slot = m_ancestors.parent(slot)) {
+      node_struct const * const node = m_slots[slot];
+      if (m_ancestors.parent(slot) == ancestor) {
+        inner[i] = node->periapsis - reach;
+        outer[i] = node->apoapsis + reach;
+      } else {
+        reach += node->apoapsis;
+      }
+    }
+  }
+
+  return std::max(0.0, std::max(inner[0] - outer[1], inner[1] - outer[0]));
+}
+
+std::pair<second_type, meter_type> SolarSystem::closestApproach(
+    std::vector<std::pair<size_t, double>> const & path,
+    second_type const start,
+    second_type const end) const
+{
+  // the offset between the bodies, and its rate of change projected onto
+  // it, which is negative while the bodies approach each other
+  auto const offset = [this, &path](
+      second_type const time,
+      Vector3D * const position) {
+    Vector3D velocity;
+    *position = Vector3D();
+    for (std::pair<size_t, double> const & step : path) {
+      Vector3D stepPosition;
+      Vector3D stepVelocity;
+      m_states.predictState(step.first, time, &stepPosition, &stepVelocity);
+      *position += stepPosition * step.second;
+      velocity += stepVelocity * step.second;
+    }
+    return *position * velocity;
+  };
+
+  // the distance between the bodies changes no faster than their relative
+  // speed, which is at most the sum of the speeds at periapsis along the
+  // path. The period of an open orbit is meaningless, so only closed orbits
+  // shorten the steps by their period.
+  double speed = 0.0;
+  second_type period = INFINITY;
+  for (std::pair<size_t, double> const & step : path) {
+    speed += m_states.maxSpeed(step.first);
+    second_type const p = m_states.period(step.first);
+    if (p > 0.0 && std::isfinite(m_states.apoapsis(step.first))) {
+      period = std::min(period, p);
+    }
+  }
+
+  Vector3D position;
+  double rate = offset(start, &position);
+  std::pair<second_type, meter_type> closest(start, position.magnitude());
+
+  if (!(speed > 0.0) || end <= start) {
+    // nothing moves
+    return closest;
+  }
+
+  second_type const maxStep = period / APPROACH_SAMPLES_PER_PERIOD;
+  second_type const minStep = (end - start) / APPROACH_MAX_SAMPLES;
+
+  second_type time = start;
+  meter_type distance = closest.second;
+  while (time < end && closest.second > 0.0) {
+    // no time within the step comes closer than the distance less how far
+    // the bodies can move towards each other, so nothing skipped comes
+    // closer than the tolerance of the closest distance yet found
+    second_type const step = std::max(minStep, std::min(maxStep, \
+        (distance - closest.second * (1.0 - APPROACH_DISTANCE_TOLERANCE)) / \
+        speed));
+    // (a step lost to rounding ends the interval)
+    second_type const next = time + step < end && time + step > time ? \
+        time + step : end;
+    double const nextRate = offset(next, &position);
+    distance = position.magnitude();
+    if (distance < closest.second) {
+      closest = std::make_pair(next, distance);
+    }
+
+    if (rate < 0 && nextRate >= 0) {
+      // refine the bracketed minimum with the Illinois method
+      second_type a = time;
+      second_type b = next;
+      double fa = rate;
+      double fb = nextRate;
+      int side = 0;
+      for (size_t iter = 0; iter < APPROACH_MAX_ITERATIONS && \
+          b - a > APPROACH_TOLERANCE; ++iter) {
+        second_type const c = (a*fb - b*fa) / (fb - fa);
+        double const fc = offset(c, &position);
+        if (position.magnitude() < closest.second) {
+          closest = std::make_pair(c, position.magnitude());
+        }
 
-  for (node_struct const * const child : node->children) {
-    assert(child != nullptr); 
-    getTreeRelativeTo(offset, child, list); 
+        if (fc < 0) {
+          a = c;
+          fa = fc;
+          if (side == -1) {
+            fb *= 0.5;
+          }
+          side = -1;
+        } else {
+          b = c;
+          fb = fc;
+          if (side == 1) {
+            fa *= 0.5;
+          }
+          side = 1;
+        }
+      }
+    }
+
+    time = next;
+    rate = nextRate;
+  }
+
+  return closest;
+}
+
+void SolarSystem::updateLocalPosition(
+    size_t const slot)
+{
+  m_localPositions[slot] = m_states.position(slot);
+  if (m_single) {
+    m_states.localPositions(slot, slot + 1, &m_singleLocals[slot]);
+  }
+}
+
+void SolarSystem::updateLocalPositions()
+{
+  // every orbit has moved, so recompute all local positions in parallel
+  m_pool->parallelFor(m_slots.size(),
+      [this](size_t const begin, size_t const end) {
+    for (size_t slot = begin; slot < end; ++slot) {
+      m_localPositions[slot] = m_states.position(slot);
+    }
+    if (m_single) {
+      m_states.localPositions(begin, end, m_singleLocals.data() + begin);
+    }
+  });
+}
+
+void SolarSystem::updateRootPositions(
+    node_struct const * const start)
+{
+  // the root position of the parent of the start is already up to date
+  m_traversal.clear();
+  m_traversal.emplace_back(start);
+
+  while (!m_traversal.empty()) {
+    node_struct const * const node = m_traversal.back();
+    m_traversal.pop_back();
+
+    size_t const slot = node->slot;
+    m_rootPositions[slot] = m_localPositions[slot];
+    if (node->parent != nullptr) {
+      m_rootPositions[slot] += m_rootPositions[node->parent->slot];
+    }
+    assert(m_rootPositions[slot].isValid());
+
+    // summed in double precision, so that the error of each position does
+    // not grow with its distance from the root
+    if (m_single) {
+      m_singleRoots[slot] = m_singleLocals[slot].toVector3D();
+      if (node->parent != nullptr) {
+        m_singleRoots[slot] += m_singleRoots[node->parent->slot];
+      }
+    }
+
+    for (node_struct const * const child : node->children) {
+      assert(child != nullptr);
+      m_traversal.emplace_back(child);
+    }
   }
+
+  m_spatialStale = true;
 }
 
 }
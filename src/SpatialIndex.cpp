@@ -0,0 +1,279 @@
+/**
+* @file SpatialIndex.cpp
+* @brief Implementation of the SpatialIndex class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-22
+*/
+
+#include "SpatialIndex.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace gravitree
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+namespace
+{
+
+// the most points kept in a leaf
+constexpr size_t const LEAF_SIZE = 8;
+
+// enough for the depth of a median split hierarchy over any number of points
+constexpr size_t const MAX_DEPTH = 64;
+
+}
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+namespace
+{
+
+double component(
+    Vector3D const & v,
+    size_t const axis) noexcept
+{
+  return axis == 0 ? v.x() : (axis == 1 ? v.y() : v.z());
+}
+
+}
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+SpatialIndex::SpatialIndex() :
+  m_nodes(),
+  m_items(),
+  m_points()
+{
+  // do nothing
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+void SpatialIndex::build(
+    Vector3D const * const positions,
+    size_t const * const items,
+    size_t const numItems)
+{
+  m_nodes.clear();
+  m_items.assign(items, items + numItems);
+  m_points.resize(numItems);
+
+  if (numItems > 0) {
+    // order the items, then compute the bounds as if they had moved
+    buildNode(positions, 0, numItems);
+  }
+
+  refit(positions);
+}
+
+void SpatialIndex::refit(
+    Vector3D const * const positions)
+{
+  for (size_t i = 0; i < m_items.size(); ++i) {
+    m_points[i] = positions[m_items[i]];
+  }
+
+  // children always come after their parents
+  for (size_t index = m_nodes.size(); index > 0; --index) {
+    node_struct & node = m_nodes[index-1];
+    if (node.right == 0) {
+      fitLeaf(&node);
+    } else {
+      node_struct const & left = m_nodes[index];
+      node_struct const & right = m_nodes[node.right];
+      for (size_t axis = 0; axis < 3; ++axis) {
+        node.min[axis] = std::min(left.min[axis], right.min[axis]);
+        node.max[axis] = std::max(left.max[axis], right.max[axis]);
+      }
+    }
+  }
+}
+
+size_t SpatialIndex::size() const noexcept
+{
+  return m_items.size();
+}
+
+void SpatialIndex::within(
+    Vector3D const & center,
+    double const radius,
+    visit_function const & visit) const
+{
+  if (m_nodes.empty()) {
+    return;
+  }
+
+  double const c[3] = {center.x(), center.y(), center.z()};
+  double const radius2 = radius * radius;
+
+  size_t stack[MAX_DEPTH];
+  size_t top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    node_struct const & node = m_nodes[stack[--top]];
+
+    // the squared distances to the nearest and farthest points of the box
+    double nearest = 0;
+    double farthest = 0;
+    for (size_t axis = 0; axis < 3; ++axis) {
+      double const below = node.min[axis] - c[axis];
+      double const above = c[axis] - node.max[axis];
+      double const gap = std::max(0.0, std::max(below, above));
+      double const span = std::max(std::abs(below), std::abs(above));
+      nearest += gap * gap;
+      farthest += span * span;
+    }
+
+    if (nearest > radius2) {
+      continue;
+    }
+
+    if (node.right == 0 || farthest <= radius2) {
+      bool const all = farthest <= radius2;
+      for (size_t i = node.begin; i < node.end; ++i) {
+        if (all || m_points[i].distance2(center) <= radius2) {
+          visit(m_items[i]);
+        }
+      }
+    } else {
+      assert(top + 2 <= MAX_DEPTH);
+      stack[top++] = node.right;
+      stack[top++] = static_cast<size_t>(&node - m_nodes.data()) + 1;
+    }
+  }
+}
+
+void SpatialIndex::inside(
+    Vector3D const & min,
+    Vector3D const & max,
+    visit_function const & visit) const
+{
+  if (m_nodes.empty()) {
+    return;
+  }
+
+  double const lo[3] = {min.x(), min.y(), min.z()};
+  double const hi[3] = {max.x(), max.y(), max.z()};
+
+  size_t stack[MAX_DEPTH];
+  size_t top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    node_struct const & node = m_nodes[stack[--top]];
+
+    bool overlaps = true;
+    bool contained = true;
+    for (size_t axis = 0; axis < 3; ++axis) {
+      overlaps = overlaps && node.min[axis] <= hi[axis] && \
+          node.max[axis] >= lo[axis];
+      contained = contained && node.min[axis] >= lo[axis] && \
+          node.max[axis] <= hi[axis];
+    }
+
+    if (!overlaps) {
+      continue;
+    }
+
+    if (node.right == 0 || contained) {
+      for (size_t i = node.begin; i < node.end; ++i) {
+        Vector3D const & p = m_points[i];
+        if (contained || (p.x() >= lo[0] && p.x() <= hi[0] && \
+            p.y() >= lo[1] && p.y() <= hi[1] && \
+            p.z() >= lo[2] && p.z() <= hi[2])) {
+          visit(m_items[i]);
+        }
+      }
+    } else {
+      assert(top + 2 <= MAX_DEPTH);
+      stack[top++] = node.right;
+      stack[top++] = static_cast<size_t>(&node - m_nodes.data()) + 1;
+    }
+  }
+}
+
+
+/******************************************************************************
+* PRIVATE METHODS *************************************************************
+******************************************************************************/
+
+void SpatialIndex::buildNode(
+    Vector3D const * const positions,
+    size_t const begin,
+    size_t const end)
+{
+  size_t const index = m_nodes.size();
+  m_nodes.emplace_back(node_struct{{0, 0, 0}, {0, 0, 0}, begin, end, 0});
+  if (end - begin <= LEAF_SIZE) {
+    return;
+  }
+
+  double min[3];
+  double max[3];
+  for (size_t axis = 0; axis < 3; ++axis) {
+    min[axis] = std::numeric_limits<double>::max();
+    max[axis] = -std::numeric_limits<double>::max();
+  }
+  for (size_t i = begin; i < end; ++i) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      double const value = component(positions[m_items[i]], axis);
+      min[axis] = std::min(min[axis], value);
+      max[axis] = std::max(max[axis], value);
+    }
+  }
+
+  size_t axis = 0;
+  for (size_t a = 1; a < 3; ++a) {
+    if (max[a] - min[a] > max[axis] - min[axis]) {
+      axis = a;
+    }
+  }
+
+  size_t const mid = begin + (end - begin) / 2;
+  std::nth_element(m_items.begin() + begin, m_items.begin() + mid, \
+      m_items.begin() + end, \
+      [positions, axis](size_t const a, size_t const b) {
+    return component(positions[a], axis) < component(positions[b], axis);
+  });
+
+  buildNode(positions, begin, mid);
+  m_nodes[index].right = m_nodes.size();
+  buildNode(positions, mid, end);
+}
+
+void SpatialIndex::fitLeaf(
+    node_struct * const node) const noexcept
+{
+  for (size_t axis = 0; axis < 3; ++axis) {
+    node->min[axis] = std::numeric_limits<double>::max();
+    node->max[axis] = -std::numeric_limits<double>::max();
+  }
+
+  for (size_t i = node->begin; i < node->end; ++i) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      double const value = component(m_points[i], axis);
+      node->min[axis] = std::min(node->min[axis], value);
+      node->max[axis] = std::max(node->max[axis], value);
+    }
+  }
+}
+
+}
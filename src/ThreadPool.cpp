@@ -0,0 +1,147 @@
+/**
+* @file ThreadPool.cpp
+* @brief Implementation of the ThreadPool class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-12
+*/
+
+#include "ThreadPool.hpp"
+
+namespace gravitree
+{
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+ThreadPool::ThreadPool(
+    size_t const numThreads) :
+  m_threads(),
+  m_call(),
+  m_mutex(),
+  m_start(),
+  m_finish(),
+  m_func(nullptr),
+  m_num(0),
+  m_round(0),
+  m_remaining(0),
+  m_error(),
+  m_shutdown(false)
+{
+  for (size_t t = 1; t < numThreads; ++t) {
+    m_threads.emplace_back(&ThreadPool::work, this, t);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shutdown = true;
+  }
+  m_start.notify_all();
+
+  for (std::thread & thread : m_threads) {
+    thread.join();
+  }
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+size_t ThreadPool::numThreads() const noexcept
+{
+  return m_threads.size() + 1;
+}
+
+void ThreadPool::parallelFor(
+    size_t const num,
+    range_function const & func)
+{
+  if (m_threads.empty() || num < 2) {
+    func(0, num);
+    return;
+  }
+
+  std::lock_guard<std::mutex> call(m_call);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_func = &func;
+    m_num = num;
+    m_remaining = m_threads.size();
+    m_error = nullptr;
+    ++m_round;
+  }
+  m_start.notify_all();
+
+  runChunk(0);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_finish.wait(lock, [this]() { return m_remaining == 0; });
+  m_func = nullptr;
+
+  if (m_error) {
+    std::exception_ptr error = m_error;
+    m_error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+
+/******************************************************************************
+* PRIVATE METHODS *************************************************************
+******************************************************************************/
+
+void ThreadPool::work(
+    size_t const threadId)
+{
+  size_t round = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_start.wait(lock, [this, round]() {
+          return m_shutdown || m_round != round; });
+      if (m_shutdown) {
+        return;
+      }
+      round = m_round;
+    }
+
+    runChunk(threadId);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      --m_remaining;
+    }
+    m_finish.notify_one();
+  }
+}
+
+void ThreadPool::runChunk(
+    size_t const threadId)
+{
+  size_t const numThreads = m_threads.size() + 1;
+  size_t const begin = (m_num * threadId) / numThreads;
+  size_t const end = (m_num * (threadId + 1)) / numThreads;
+
+  if (begin == end) {
+    return;
+  }
+
+  try {
+    (*m_func)(begin, end);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_error) {
+      m_error = std::current_exception();
+    }
+  }
+}
+
+}
@@ -0,0 +1,351 @@
+/**
+* @file Vector3DArray.cpp
+* @brief Implementation of the Vector3DArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+#include "Vector3DArray.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace gravitree
+{
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+Vector3DArray::Vector3DArray(
+    size_t const size) :
+  m_x(size, 0.0),
+  m_y(size, 0.0),
+  m_z(size, 0.0)
+{
+  // do nothing
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+size_t Vector3DArray::size() const noexcept
+{
+  return m_x.size();
+}
+
+void Vector3DArray::resize(
+    size_t const size)
+{
+  m_x.resize(size, 0.0);
+  m_y.resize(size, 0.0);
+  m_z.resize(size, 0.0);
+}
+
+void Vector3DArray::clear() noexcept
+{
+  m_x.clear();
+  m_y.clear();
+  m_z.clear();
+}
+
+void Vector3DArray::add(
+    Vector3D const & vec)
+{
+  m_x.emplace_back(vec.x());
+  m_y.emplace_back(vec.y());
+  m_z.emplace_back(vec.z());
+}
+
+void Vector3DArray::add(
+    CompactVector3D const & vec)
+{
+  m_x.emplace_back(vec.x());
+  m_y.emplace_back(vec.y());
+  m_z.emplace_back(vec.z());
+}
+
+Vector3D Vector3DArray::get(
+    size_t const index) const noexcept
+{
+  assert(index < size());
+
+  return Vector3D(m_x[index], m_y[index], m_z[index]);
+}
+
+void Vector3DArray::set(
+    size_t const index,
+    Vector3D const & vec) noexcept
+{
+  assert(index < size());
+
+  m_x[index] = vec.x();
+  m_y[index] = vec.y();
+  m_z[index] = vec.z();
+}
+
+double const * Vector3DArray::x() const noexcept
+{
+  return m_x.data();
+}
+
+double const * Vector3DArray::y() const noexcept
+{
+  return m_y.data();
+}
+
+double const * Vector3DArray::z() const noexcept
+{
+  return m_z.data();
+}
+
+double * Vector3DArray::x() noexcept
+{
+  return m_x.data();
+}
+
+double * Vector3DArray::y() noexcept
+{
+  return m_y.data();
+}
+
+double * Vector3DArray::z() noexcept
+{
+  return m_z.data();
+}
+
+Vector3DArray & Vector3DArray::operator+=(
+    Vector3DArray const & other)
+{
+  addScaled(1.0, other);
+
+  return *this;
+}
+
+Vector3DArray & Vector3DArray::operator-=(
+    Vector3DArray const & other)
+{
+  addScaled(-1.0, other);
+
+  return *this;
+}
+
+Vector3DArray & Vector3DArray::operator+=(
+    Vector3D const & vec) noexcept
+{
+  size_t const num = size();
+  double * const x = m_x.data();
+  double * const y = m_y.data();
+  double * const z = m_z.data();
+  double const vx = vec.x();
+  double const vy = vec.y();
+  double const vz = vec.z();
+  for (size_t i = 0; i < num; ++i) {
+    x[i] += vx;
+    y[i] += vy;
+    z[i] += vz;
+  }
+
+  return *this;
+}
+
+Vector3DArray & Vector3DArray::operator-=(
+    Vector3D const & vec) noexcept
+{
+  return *this += -vec;
+}
+
+Vector3DArray & Vector3DArray::operator*=(
+    double const scalar) noexcept
+{
+  size_t const num = size();
+  double * const x = m_x.data();
+  double * const y = m_y.data();
+  double * const z = m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    x[i] *= scalar;
+    y[i] *= scalar;
+    z[i] *= scalar;
+  }
+
+  return *this;
+}
+
+void Vector3DArray::scale(
+    double const * const scalars) noexcept
+{
+  size_t const num = size();
+  double * const x = m_x.data();
+  double * const y = m_y.data();
+  double * const z = m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    x[i] *= scalars[i];
+    y[i] *= scalars[i];
+    z[i] *= scalars[i];
+  }
+}
+
+void Vector3DArray::addScaled(
+    double const scalar,
+    Vector3DArray const & other)
+{
+  checkSize(other);
+
+  size_t const num = size();
+  double * const x = m_x.data();
+  double * const y = m_y.data();
+  double * const z = m_z.data();
+  double const * const ox = other.m_x.data();
+  double const * const oy = other.m_y.data();
+  double const * const oz = other.m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    x[i] += scalar*ox[i];
+    y[i] += scalar*oy[i];
+    z[i] += scalar*oz[i];
+  }
+}
+
+void Vector3DArray::dot(
+    Vector3DArray const & other,
+    double * const products) const
+{
+  checkSize(other);
+
+  size_t const num = size();
+  double const * const x = m_x.data();
+  double const * const y = m_y.data();
+  double const * const z = m_z.data();
+  double const * const ox = other.m_x.data();
+  double const * const oy = other.m_y.data();
+  double const * const oz = other.m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    products[i] = x[i]*ox[i] + y[i]*oy[i] + z[i]*oz[i];
+  }
+}
+
+void Vector3DArray::cross(
+    Vector3DArray const & other,
+    Vector3DArray * const products) const
+{
+  checkSize(other);
+
+  size_t const num = size();
+  // the output may be one of the inputs, so compute through a temporary
+  Vector3DArray result(num);
+  double const * const x = m_x.data();
+  double const * const y = m_y.data();
+  double const * const z = m_z.data();
+  double const * const ox = other.m_x.data();
+  double const * const oy = other.m_y.data();
+  double const * const oz = other.m_z.data();
+  double * const px = result.m_x.data();
+  double * const py = result.m_y.data();
+  double * const pz = result.m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    px[i] = y[i]*oz[i] - z[i]*oy[i];
+    py[i] = z[i]*ox[i] - x[i]*oz[i];
+    pz[i] = x[i]*oy[i] - y[i]*ox[i];
+  }
+
+  products->m_x.swap(result.m_x);
+  products->m_y.swap(result.m_y);
+  products->m_z.swap(result.m_z);
+}
+
+void Vector3DArray::magnitude2(
+    double * const magnitudes) const noexcept
+{
+  size_t const num = size();
+  double const * const x = m_x.data();
+  double const * const y = m_y.data();
+  double const * const z = m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    magnitudes[i] = x[i]*x[i] + y[i]*y[i] + z[i]*z[i];
+  }
+}
+
+void Vector3DArray::magnitude(
+    double * const magnitudes) const noexcept
+{
+  magnitude2(magnitudes);
+
+  size_t const num = size();
+  for (size_t i = 0; i < num; ++i) {
+    magnitudes[i] = std::sqrt(magnitudes[i]);
+  }
+}
+
+void Vector3DArray::distance(
+    Vector3DArray const & other,
+    double * const distances) const
+{
+  checkSize(other);
+
+  size_t const num = size();
+  double const * const x = m_x.data();
+  double const * const y = m_y.data();
+  double const * const z = m_z.data();
+  double const * const ox = other.m_x.data();
+  double const * const oy = other.m_y.data();
+  double const * const oz = other.m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    double const dx = x[i] - ox[i];
+    double const dy = y[i] - oy[i];
+    double const dz = z[i] - oz[i];
+    distances[i] = std::sqrt(dx*dx + dy*dy + dz*dz);
+  }
+}
+
+void Vector3DArray::distance(
+    Vector3D const & point,
+    double * const distances) const noexcept
+{
+  size_t const num = size();
+  double const * const x = m_x.data();
+  double const * const y = m_y.data();
+  double const * const z = m_z.data();
+  double const px = point.x();
+  double const py = point.y();
+  double const pz = point.z();
+  for (size_t i = 0; i < num; ++i) {
+    double const dx = x[i] - px;
+    double const dy = y[i] - py;
+    double const dz = z[i] - pz;
+    distances[i] = std::sqrt(dx*dx + dy*dy + dz*dz);
+  }
+}
+
+void Vector3DArray::normalize() noexcept
+{
+  size_t const num = size();
+  double * const x = m_x.data();
+  double * const y = m_y.data();
+  double * const z = m_z.data();
+  for (size_t i = 0; i < num; ++i) {
+    double const inverse = 1.0 / std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+    x[i] *= inverse;
+    y[i] *= inverse;
+    z[i] *= inverse;
+  }
+}
+
+
+/******************************************************************************
+* PRIVATE METHODS *************************************************************
+******************************************************************************/
+
+void Vector3DArray::checkSize(
+    Vector3DArray const & other) const
+{
+  if (other.size() != size()) {
+    throw std::invalid_argument("Vector3DArray sizes differ");
+  }
+}
+
+}
@@ -0,0 +1,253 @@
+/**
+* @file Anomally_bench.cpp
+* @brief Throughput and accuracy of the array conversions of the Anomally
+* class, measured against a long double reference. The array conversions are
+* scalar loops over the single conversions (the compiler does not vectorize
+* them), so this measures the scalar code, called in bulk.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Anomally.hpp"
+#include "Constants.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+
+namespace gravitree
+{
+
+namespace
+{
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+constexpr size_t const NUM_ANOMALLIES = 1 << 20;
+
+constexpr size_t const NUM_REPEATS = 10;
+
+// the reference is slow, so only every this many results are checked
+constexpr size_t const CHECK_STRIDE = 16;
+
+constexpr int const REFERENCE_ITERATIONS = 8;
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+typedef void (*array_function)(
+    radian_type const *,
+    double const *,
+    radian_type *,
+    size_t);
+
+typedef std::function<long double(long double, long double)> \
+    reference_function;
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+long double referenceEccentricFromTrue(
+    long double const v,
+    long double const e)
+{
+  return std::atan2(std::sqrt((1.0L - e) * (1.0L + e)) * std::sin(v), \
+      e + std::cos(v));
+}
+
+long double referenceMeanFromEccentric(
+    long double const E,
+    long double const e)
+{
+  return E - e*std::sin(E);
+}
+
+long double referenceTrueFromEccentric(
+    long double const E,
+    long double const e)
+{
+  long double const ratio = std::sqrt((1.0L + e) / (1.0L - e));
+  return 2.0L * std::atan2(ratio*std::sin(E*0.5L), std::cos(E*0.5L));
+}
+
+long double referenceEccentricFromMean(
+    long double const M,
+    long double const e)
+{
+  // bisect to near the root, then polish with Newton's method
+  long double low = M - e;
+  long double high = M + e;
+  for (int i = 0; i < 64; ++i) {
+    long double const mid = 0.5L * (low + high);
+    if (referenceMeanFromEccentric(mid, e) < M) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  long double E = 0.5L * (low + high);
+  for (int i = 0; i < REFERENCE_ITERATIONS; ++i) {
+    E -= (E - e*std::sin(E) - M) / (1.0L - e*std::cos(E));
+  }
+  return E;
+}
+
+long double referenceHyperbolicFromTrue(
+    long double const v,
+    long double const e)
+{
+  long double const ratio = std::sqrt((e - 1.0L) / (e + 1.0L));
+  return 2.0L * std::atanh(ratio * std::tan(v*0.5L));
+}
+
+long double referenceMeanFromHyperbolic(
+    long double const H,
+    long double const e)
+{
+  return e*std::sinh(H) - H;
+}
+
+long double referenceTrueFromHyperbolic(
+    long double const H,
+    long double const e)
+{
+  long double const ratio = std::sqrt((e + 1.0L) / (e - 1.0L));
+  return 2.0L * std::atan(ratio * std::tanh(H*0.5L));
+}
+
+long double referenceHyperbolicFromMean(
+    long double const M,
+    long double const e)
+{
+  // M is increasing in H, and |H| < asinh(|M|/e) + |M|/(e-1)
+  long double const bound = std::asinh(std::abs(M) / e) + \
+      std::abs(M) / (e - 1.0L);
+  long double low = -bound;
+  long double high = bound;
+  for (int i = 0; i < 128; ++i) {
+    long double const mid = 0.5L * (low + high);
+    if (referenceMeanFromHyperbolic(mid, e) < M) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  long double H = 0.5L * (low + high);
+  for (int i = 0; i < REFERENCE_ITERATIONS; ++i) {
+    H -= (e*std::sinh(H) - H - M) / (e*std::cosh(H) - 1.0L);
+  }
+  return H;
+}
+
+/**
+* @brief Time a conversion and find its largest error.
+*
+* @param name The name of the conversion.
+* @param func The array conversion.
+* @param reference The long double version of the conversion.
+* @param inputs The anomallies to convert.
+* @param eccentricities The eccentricity of each.
+*/
+void bench(
+    char const * const name,
+    array_function const func,
+    reference_function const & reference,
+    std::vector<double> const & inputs,
+    std::vector<double> const & eccentricities)
+{
+  size_t const num = inputs.size();
+  std::vector<double> outputs(num);
+
+  std::chrono::steady_clock::time_point const start = \
+      std::chrono::steady_clock::now();
+  for (size_t r = 0; r < NUM_REPEATS; ++r) {
+    func(inputs.data(), eccentricities.data(), outputs.data(), num);
+  }
+  std::chrono::steady_clock::time_point const end = \
+      std::chrono::steady_clock::now();
+  double const seconds = std::chrono::duration<double>(end - start).count();
+
+  // the error relative to the magnitude of the result, or absolute for
+  // results smaller than one radian
+  double maxError = 0;
+  for (size_t i = 0; i < num; i += CHECK_STRIDE) {
+    long double const exact = reference(inputs[i], eccentricities[i]);
+    long double const error = std::abs(outputs[i] - exact) / \
+        std::max(1.0L, std::abs(exact));
+    maxError = std::max(maxError, static_cast<double>(error));
+  }
+
+  std::printf("%-20s %10.2f M/s %12.3e\n", name, \
+      (NUM_REPEATS * num) / seconds * 1.0e-6, maxError);
+}
+
+}
+
+}
+
+
+/******************************************************************************
+* MAIN ************************************************************************
+******************************************************************************/
+
+int main()
+{
+  using namespace gravitree;
+
+  std::mt19937_64 rng(2018);
+  std::uniform_real_distribution<double> angle(-Constants::PI, Constants::PI);
+  std::uniform_real_distribution<double> mean(-20.0, 20.0);
+  std::uniform_real_distribution<double> closed(0.0, 0.999);
+  std::uniform_real_distribution<double> open(1.001, 10.0);
+
+  std::vector<double> angles(NUM_ANOMALLIES);
+  std::vector<double> means(NUM_ANOMALLIES);
+  std::vector<double> closedEccentricities(NUM_ANOMALLIES);
+  std::vector<double> openEccentricities(NUM_ANOMALLIES);
+  std::vector<double> within(NUM_ANOMALLIES);
+  for (size_t i = 0; i < NUM_ANOMALLIES; ++i) {
+    angles[i] = angle(rng);
+    means[i] = mean(rng);
+    closedEccentricities[i] = closed(rng);
+    openEccentricities[i] = open(rng);
+    // within the asymptotes of the open orbit
+    within[i] = angles[i] * std::acos(-1.0 / openEccentricities[i]) / \
+        Constants::PI;
+  }
+
+  std::printf("scalar array conversions\n");
+  std::printf("%-20s %14s %12s\n", "conversion", "throughput", "max error");
+
+  bench("eccentricFromTrue", &Anomally::eccentricFromTrue, \
+      referenceEccentricFromTrue, angles, closedEccentricities);
+  bench("meanFromEccentric", &Anomally::meanFromEccentric, \
+      referenceMeanFromEccentric, angles, closedEccentricities);
+  bench("eccentricFromMean", &Anomally::eccentricFromMean, \
+      referenceEccentricFromMean, means, closedEccentricities);
+  bench("trueFromEccentric", &Anomally::trueFromEccentric, \
+      referenceTrueFromEccentric, angles, closedEccentricities);
+  bench("hyperbolicFromTrue", &Anomally::hyperbolicFromTrue, \
+      referenceHyperbolicFromTrue, within, openEccentricities);
+  bench("meanFromHyperbolic", &Anomally::meanFromHyperbolic, \
+      referenceMeanFromHyperbolic, angles, openEccentricities);
+  bench("hyperbolicFromMean", &Anomally::hyperbolicFromMean, \
+      referenceHyperbolicFromMean, means, openEccentricities);
+  bench("trueFromHyperbolic", &Anomally::trueFromHyperbolic, \
+      referenceTrueFromHyperbolic, angles, openEccentricities);
+
+  return 0;
+}
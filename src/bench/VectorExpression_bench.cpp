@@ -0,0 +1,209 @@
+/**
+* @file VectorExpression_bench.cpp
+* @brief Throughput of compound Vector3D expressions evaluated eagerly and
+* through the expression templates, and a check that both give the same
+* vectors.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Vector3D.hpp"
+#include "VectorExpression.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+namespace gravitree
+{
+
+namespace
+{
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+constexpr size_t const NUM_VECTORS = 1 << 10;
+
+constexpr size_t const NUM_REPEATS = 10000;
+
+constexpr double const MU = 3.986004418e14;
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+struct inputs_struct
+{
+  std::vector<Vector3D> positions;
+  std::vector<Vector3D> velocities;
+  std::vector<Vector3D> momenta;
+  std::vector<double> radii;
+  std::vector<double> xs;
+  std::vector<double> ys;
+};
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+// the eccentricity vector, (v x h)/mu - r/|r|
+Vector3D eagerEccentricity(
+    inputs_struct const & in,
+    size_t const i)
+{
+  return (in.velocities[i].cross(in.momenta[i]) / MU) - \
+      (in.positions[i] / in.radii[i]);
+}
+
+Vector3D lazyEccentricity(
+    inputs_struct const & in,
+    size_t const i)
+{
+  return evaluate( \
+      (cross(lazy(in.velocities[i]), lazy(in.momenta[i])) / MU) - \
+      (lazy(in.positions[i]) / in.radii[i]));
+}
+
+// a point in the perifocal frame, p*x + q*y
+Vector3D eagerPerifocal(
+    inputs_struct const & in,
+    size_t const i)
+{
+  return in.positions[i] * in.xs[i] + in.velocities[i] * in.ys[i];
+}
+
+Vector3D lazyPerifocal(
+    inputs_struct const & in,
+    size_t const i)
+{
+  return evaluate(lazy(in.positions[i]) * in.xs[i] + \
+      lazy(in.velocities[i]) * in.ys[i]);
+}
+
+// a chain of offsets, as when summing positions down a tree
+Vector3D eagerChain(
+    inputs_struct const & in,
+    size_t const i)
+{
+  return in.positions[i] + in.velocities[i] + in.momenta[i] - \
+      in.positions[i ^ 1];
+}
+
+Vector3D lazyChain(
+    inputs_struct const & in,
+    size_t const i)
+{
+  return evaluate(lazy(in.positions[i]) + in.velocities[i] + in.momenta[i] - \
+      in.positions[i ^ 1]);
+}
+
+/**
+* @brief Time an expression evaluated both ways, and check that they agree.
+*
+* @tparam EAGER The type of the eager evaluation.
+* @tparam LAZY The type of the lazy evaluation.
+* @param name The name of the expression.
+* @param eager The eager evaluation.
+* @param lazy The lazy evaluation.
+* @param in The inputs.
+*/
+template<typename EAGER, typename LAZY>
+void bench(
+    char const * const name,
+    EAGER const & eager,
+    LAZY const & lazy,
+    inputs_struct const & in)
+{
+  std::vector<Vector3D> eagerOut(NUM_VECTORS);
+  std::vector<Vector3D> lazyOut(NUM_VECTORS);
+
+  std::chrono::steady_clock::time_point const start = \
+      std::chrono::steady_clock::now();
+  for (size_t r = 0; r < NUM_REPEATS; ++r) {
+    for (size_t i = 0; i < NUM_VECTORS; ++i) {
+      eagerOut[i] = eager(in, i);
+    }
+  }
+  std::chrono::steady_clock::time_point const middle = \
+      std::chrono::steady_clock::now();
+  for (size_t r = 0; r < NUM_REPEATS; ++r) {
+    for (size_t i = 0; i < NUM_VECTORS; ++i) {
+      lazyOut[i] = lazy(in, i);
+    }
+  }
+  std::chrono::steady_clock::time_point const end = \
+      std::chrono::steady_clock::now();
+
+  // the components are computed by the same operations, so must be equal,
+  // and the cached lengths may only differ by rounding
+  size_t mismatches = 0;
+  double maxLengthError = 0;
+  for (size_t i = 0; i < NUM_VECTORS; ++i) {
+    Vector3D const & a = eagerOut[i];
+    Vector3D const & b = lazyOut[i];
+    if (a.x() != b.x() || a.y() != b.y() || a.z() != b.z()) {
+      ++mismatches;
+    }
+    double const error = std::abs(a.magnitude2() - b.magnitude2()) / \
+        b.magnitude2();
+    maxLengthError = std::max(maxLengthError, error);
+  }
+
+  double const num = static_cast<double>(NUM_REPEATS * NUM_VECTORS);
+  double const eagerSeconds = \
+      std::chrono::duration<double>(middle - start).count();
+  double const lazySeconds = \
+      std::chrono::duration<double>(end - middle).count();
+  std::printf("%-14s %10.2f %10.2f %8zu %12.3e\n", name, \
+      eagerSeconds / num * 1.0e9, lazySeconds / num * 1.0e9, mismatches, \
+      maxLengthError);
+}
+
+}
+
+}
+
+
+/******************************************************************************
+* MAIN ************************************************************************
+******************************************************************************/
+
+int main()
+{
+  using namespace gravitree;
+
+  std::mt19937_64 rng(2018);
+  std::uniform_real_distribution<double> position(-4.0e7, 4.0e7);
+  std::uniform_real_distribution<double> velocity(-8.0e3, 8.0e3);
+  std::uniform_real_distribution<double> angle(-3.0, 3.0);
+
+  inputs_struct in{{}, {}, {}, {}, {}, {}};
+  for (size_t i = 0; i < NUM_VECTORS; ++i) {
+    Vector3D const r(position(rng), position(rng), position(rng));
+    Vector3D const v(velocity(rng), velocity(rng), velocity(rng));
+    in.positions.emplace_back(r);
+    in.velocities.emplace_back(v);
+    in.momenta.emplace_back(r.cross(v));
+    in.radii.emplace_back(r.magnitude());
+    in.xs.emplace_back(std::cos(angle(rng)));
+    in.ys.emplace_back(std::sin(angle(rng)));
+  }
+
+  std::printf("%-14s %10s %10s %8s %12s\n", "expression", "eager ns", \
+      "lazy ns", "differ", "length error");
+
+  bench("eccentricity", eagerEccentricity, lazyEccentricity, in);
+  bench("perifocal", eagerPerifocal, lazyPerifocal, in);
+  bench("chain", eagerChain, lazyChain, in);
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+/**
+* @file AncestorIndex_test.cpp
+* @brief Unit tests for the AncestorIndex class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-20
+*/
+
+
+#include "AncestorIndex.hpp"
+#include "UnitTest.hpp"
+
+
+namespace gravitree
+{
+
+UNITTEST(AncestorIndex, smallTree)
+{
+  // 0 -> {1, 2}, 1 -> {3, 4}, 2 -> {5}
+  AncestorIndex index;
+  index.add(0, AncestorIndex::NO_PARENT);
+  index.add(1, 0);
+  index.add(2, 0);
+  index.add(3, 1);
+  index.add(4, 1);
+  index.add(5, 2);
+
+  testEqual(index.depth(0), 0U);
+  testEqual(index.depth(4), 2U);
+  testEqual(index.parent(5), 2U);
+
+  testEqual(index.lowestCommonAncestor(3, 4), 1U);
+  testEqual(index.lowestCommonAncestor(4, 3), 1U);
+  testEqual(index.lowestCommonAncestor(3, 5), 0U);
+  testEqual(index.lowestCommonAncestor(1, 4), 1U);
+  testEqual(index.lowestCommonAncestor(2, 2), 2U);
+  testEqual(index.lowestCommonAncestor(0, 5), 0U);
+}
+
+UNITTEST(AncestorIndex, deepChain)
+{
+  // a long chain with a short branch off every tenth node
+  AncestorIndex index;
+  index.add(0, AncestorIndex::NO_PARENT);
+  for (size_t i = 1; i < 1000; ++i) {
+    index.add(i, i-1);
+  }
+  for (size_t i = 1000; i < 1100; ++i) {
+    index.add(i, (i-1000)*10);
+  }
+
+  testEqual(index.depth(999), 999U);
+  testEqual(index.lowestCommonAncestor(999, 1050), 500U);
+  testEqual(index.lowestCommonAncestor(1001, 1050), 10U);
+  testEqual(index.lowestCommonAncestor(1001, 5), 5U);
+  testEqual(index.lowestCommonAncestor(1099, 990), 990U);
+}
+
+UNITTEST(AncestorIndex, reparent)
+{
+  AncestorIndex index;
+  index.add(0, AncestorIndex::NO_PARENT);
+  index.add(1, 0);
+  index.add(2, 1);
+  index.add(3, 2);
+  index.add(4, 0);
+
+  testEqual(index.lowestCommonAncestor(3, 4), 0U);
+
+  // move the subtree of 2 under 4, then remove 1
+  index.setParent(2, 4);
+  index.remove(1);
+
+  testEqual(index.depth(3), 3U);
+  testEqual(index.lowestCommonAncestor(3, 4), 4U);
+
+  // reuse the slot
+  index.add(1, 3);
+  testEqual(index.depth(1), 4U);
+  testEqual(index.lowestCommonAncestor(1, 2), 2U);
+}
+
+UNITTEST(AncestorIndex, separateTrees)
+{
+  AncestorIndex index;
+  index.add(0, AncestorIndex::NO_PARENT);
+  index.add(1, AncestorIndex::NO_PARENT);
+  index.add(2, 0);
+  index.add(3, 1);
+
+  testEqual(index.lowestCommonAncestor(2, 3), AncestorIndex::NO_PARENT);
+}
+
+}
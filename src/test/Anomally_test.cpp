@@ -0,0 +1,246 @@
+/**
+* @file Anomally_test.cpp
+* @brief Unit tests for the Anomally class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-26
+*/
+
+
+#include "Anomally.hpp"
+#include "Constants.hpp"
+#include "UnitTest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace gravitree
+{
+
+UNITTEST(Anomally, EccentricFromMeanKnown)
+{
+  testNearEqual(Anomally::eccentricFromMean(1.0, 0.5), 1.4987011335178482, \
+      1.0e-15, 1.0e-15);
+  testEqual(Anomally::eccentricFromMean(0.0, 0.9), 0.0);
+  testNearEqual(Anomally::eccentricFromMean(Constants::PI, 0.9), \
+      Constants::PI, 1.0e-15, 1.0e-15);
+}
+
+UNITTEST(Anomally, EccentricFromMeanResidual)
+{
+  // including the eccentricities and anomallies where starting from E=M
+  // converges slowest
+  double worst = 0.0;
+  for (int i = 0; i <= 400; ++i) {
+    double const mean = -Constants::PI + 2.0 * Constants::PI * i / 400.0;
+    for (double const e : {0.0, 1.0e-8, 0.1, 0.5, 0.9, 0.99, 0.999, \
+        0.999999}) {
+      double const eccentric = Anomally::eccentricFromMean(mean, e);
+      double const residual = std::abs( \
+          Anomally::meanFromEccentric(eccentric, e) - mean);
+      worst = std::max(worst, residual);
+    }
+  }
+
+  testNearEqual(worst, 0.0, 0.0, 1.0e-14);
+}
+
+UNITTEST(Anomally, EccentricFromMeanKeepsTurns)
+{
+  double const e = 0.3;
+  double const mean = 1.2;
+  double const eccentric = Anomally::eccentricFromMean(mean, e);
+
+  for (int turns = -3; turns <= 3; ++turns) {
+    double const offset = 2.0 * Constants::PI * turns;
+    testNearEqual(Anomally::eccentricFromMean(mean + offset, e), \
+        eccentric + offset, 1.0e-14, 1.0e-13);
+  }
+}
+
+UNITTEST(Anomally, EccentricFromMeanBatch)
+{
+  std::vector<double> means;
+  std::vector<double> eccentricities;
+  for (int i = 0; i < 1000; ++i) {
+    means.emplace_back(0.037 * i - 10.0);
+    eccentricities.emplace_back((i % 97) / 97.0);
+  }
+
+  std::vector<double> eccentric(means.size());
+  Anomally::eccentricFromMean(means.data(), eccentricities.data(), \
+      eccentric.data(), means.size());
+
+  for (size_t i = 0; i < means.size(); ++i) {
+    testEqual(eccentric[i], \
+        Anomally::eccentricFromMean(means[i], eccentricities[i]));
+  }
+}
+
+UNITTEST(Anomally, RoundTrip)
+{
+  double const e = 0.6;
+  for (double const v : {-3.0, -1.0, 0.0, 0.5, 2.0, 3.1}) {
+    double const eccentric = Anomally::eccentricFromTrue(v, e);
+    double const mean = Anomally::meanFromEccentric(eccentric, e);
+    testNearEqual(Anomally::trueFromEccentric( \
+        Anomally::eccentricFromMean(mean, e), e), v, 1.0e-12, 1.0e-12);
+  }
+}
+
+UNITTEST(Anomally, HyperbolicFromMeanResidual)
+{
+  // from near parabolic to very open orbits, and from just after periapsis
+  // to far along the asymptote
+  double worst = 0.0;
+  for (double const e : {1.0 + 1.0e-12, 1.0 + 1.0e-6, 1.001, 1.1, 2.0, \
+      10.0, 1.0e3}) {
+    for (int i = -12; i <= 8; ++i) {
+      for (double const sign : {-1.0, 1.0}) {
+        double const mean = sign * std::pow(10.0, i);
+        double const hyperbolic = Anomally::hyperbolicFromMean(mean, e);
+        double const residual = std::abs( \
+            Anomally::meanFromHyperbolic(hyperbolic, e) - mean);
+        worst = std::max(worst, residual / std::abs(mean));
+      }
+    }
+  }
+
+  testNearEqual(worst, 0.0, 0.0, 1.0e-13);
+  testEqual(Anomally::hyperbolicFromMean(0.0, 1.5), 0.0);
+}
+
+UNITTEST(Anomally, HyperbolicFromMeanBatch)
+{
+  std::vector<double> means;
+  std::vector<double> eccentricities;
+  for (int i = 0; i < 1000; ++i) {
+    means.emplace_back(0.37 * i - 100.0);
+    eccentricities.emplace_back(1.0 + (i % 97) / 13.0 + 1.0e-9);
+  }
+
+  std::vector<double> hyperbolic(means.size());
+  Anomally::hyperbolicFromMean(means.data(), eccentricities.data(), \
+      hyperbolic.data(), means.size());
+
+  for (size_t i = 0; i < means.size(); ++i) {
+    testEqual(hyperbolic[i], \
+        Anomally::hyperbolicFromMean(means[i], eccentricities[i]));
+  }
+}
+
+UNITTEST(Anomally, HyperbolicRoundTrip)
+{
+  // the asymptotes are at +/- 2.3 radians
+  double const e = 1.5;
+  for (double const v : {-2.2, -1.0, 0.0, 0.5, 2.0, 2.29}) {
+    double const hyperbolic = Anomally::hyperbolicFromTrue(v, e);
+    double const mean = Anomally::meanFromHyperbolic(hyperbolic, e);
+    testNearEqual(Anomally::trueFromHyperbolic( \
+        Anomally::hyperbolicFromMean(mean, e), e), v, 1.0e-12, 1.0e-12);
+  }
+}
+
+UNITTEST(Anomally, EccentricFromMeanWarm)
+{
+  double worst = 0.0;
+  for (double const e : {0.0, 0.1, 0.5, 0.9, 0.99}) {
+    for (int i = -20; i <= 20; ++i) {
+      double const start = 0.3 * i;
+      double const guess = Anomally::eccentricFromMean(start, e);
+      for (double const step : {-1.0e-2, -1.0e-5, 0.0, 1.0e-7, 1.0e-3}) {
+        double const mean = start + step;
+        double const eccentric = Anomally::eccentricFromMean(mean, e, guess);
+        testNearEqual(eccentric, Anomally::eccentricFromMean(mean, e), \
+            1.0e-14, 1.0e-14);
+        worst = std::max(worst, std::abs( \
+            Anomally::meanFromEccentric(eccentric, e) - mean));
+      }
+    }
+  }
+  testNearEqual(worst, 0.0, 0.0, 1.0e-14);
+
+  // far from the guess it is solved from scratch
+  testEqual(Anomally::eccentricFromMean(2.0, 0.5, -1.0), \
+      Anomally::eccentricFromMean(2.0, 0.5));
+}
+
+UNITTEST(Anomally, HyperbolicFromMeanWarm)
+{
+  for (double const e : {1.0 + 1.0e-9, 1.01, 1.5, 10.0}) {
+    for (double const start : {-50.0, -1.0, -1.0e-3, 0.0, 1.0e-6, 0.2, 7.0}) {
+      double const guess = Anomally::hyperbolicFromMean(start, e);
+      for (double const step : {-1.0e-4, 1.0e-9, 1.0e-3}) {
+        double const mean = start + step;
+        double const hyperbolic = Anomally::hyperbolicFromMean(mean, e, \
+            guess);
+        double const expected = Anomally::hyperbolicFromMean(mean, e);
+        testNearEqual(hyperbolic, expected, 1.0e-13, 1.0e-15);
+      }
+    }
+  }
+
+  testEqual(Anomally::hyperbolicFromMean(20.0, 1.5, 0.0), \
+      Anomally::hyperbolicFromMean(20.0, 1.5));
+}
+
+UNITTEST(Anomally, ConversionBatches)
+{
+  std::vector<double> angles;
+  std::vector<double> closed;
+  std::vector<double> open;
+  for (int i = 0; i < 1000; ++i) {
+    angles.emplace_back(0.0059 * i - 2.9);
+    closed.emplace_back((i % 97) / 97.0);
+    open.emplace_back(1.0 + (i % 89) / 8.0 + 1.0e-3);
+  }
+
+  size_t const num = angles.size();
+  std::vector<double> result(num);
+
+  Anomally::eccentricFromTrue(angles.data(), closed.data(), result.data(), \
+      num);
+  for (size_t i = 0; i < num; ++i) {
+    testEqual(result[i], Anomally::eccentricFromTrue(angles[i], closed[i]));
+  }
+
+  Anomally::meanFromEccentric(angles.data(), closed.data(), result.data(), \
+      num);
+  for (size_t i = 0; i < num; ++i) {
+    testEqual(result[i], Anomally::meanFromEccentric(angles[i], closed[i]));
+  }
+
+  Anomally::trueFromEccentric(angles.data(), closed.data(), result.data(), \
+      num);
+  for (size_t i = 0; i < num; ++i) {
+    testEqual(result[i], Anomally::trueFromEccentric(angles[i], closed[i]));
+  }
+
+  // true anomallies within the asymptotes of every open orbit
+  std::vector<double> within(num);
+  for (size_t i = 0; i < num; ++i) {
+    within[i] = angles[i] * std::acos(-1.0 / open[i]) / Constants::PI;
+  }
+  Anomally::hyperbolicFromTrue(within.data(), open.data(), result.data(), \
+      num);
+  for (size_t i = 0; i < num; ++i) {
+    testEqual(result[i], Anomally::hyperbolicFromTrue(within[i], open[i]));
+  }
+
+  Anomally::meanFromHyperbolic(angles.data(), open.data(), result.data(), \
+      num);
+  for (size_t i = 0; i < num; ++i) {
+    testEqual(result[i], Anomally::meanFromHyperbolic(angles[i], open[i]));
+  }
+
+  Anomally::trueFromHyperbolic(angles.data(), open.data(), result.data(), \
+      num);
+  for (size_t i = 0; i < num; ++i) {
+    testEqual(result[i], Anomally::trueFromHyperbolic(angles[i], open[i]));
+  }
+}
+
+}
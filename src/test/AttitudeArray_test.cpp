@@ -0,0 +1,72 @@
+/**
+* @file AttitudeArray_test.cpp
+* @brief Unit tests for the AttitudeArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "AttitudeArray.hpp"
+#include "Constants.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+
+namespace gravitree
+{
+
+UNITTEST(AttitudeArray, propagate)
+{
+  AttitudeArray array;
+  Quaternion const start = Quaternion::fromRotation( \
+      Rotation(Vector3D(1.0, 1.0, 0.0), 0.4));
+  Rotation const spin(Vector3D(0.0, 0.0, 3.0), 2.0 * Constants::PI / 100.0);
+  array.add(3, start, spin);
+  testEqual(array.size(), 4u);
+
+  // the slots added to make room are at rest
+  testEqual(array.orientation(1), Quaternion());
+
+  // a quarter turn in many steps, then in a few steps of another size
+  for (int i = 0; i < 2500; ++i) {
+    array.propagate(0, array.size(), 0.01);
+  }
+  for (int i = 0; i < 5; ++i) {
+    array.propagate(0, 2, 1.0);
+    array.propagate(2, array.size(), 1.0);
+  }
+
+  Quaternion const expected = Quaternion::fromRotation( \
+      Rotation(spin.axis(), spin.angle() * 30.0)) * start;
+  Quaternion const result = array.orientation(3);
+  testNearEqual(result.w(), expected.w(), 0.0, 1e-12);
+  testNearEqual(result.x(), expected.x(), 0.0, 1e-12);
+  testNearEqual(result.y(), expected.y(), 0.0, 1e-12);
+  testNearEqual(result.z(), expected.z(), 0.0, 1e-12);
+  testNearEqual(result.magnitude(), 1.0, 0.0, 1e-15);
+  testEqual(array.orientation(1), Quaternion());
+}
+
+UNITTEST(AttitudeArray, setAndRemove)
+{
+  AttitudeArray array;
+  array.add(0, Quaternion(), Rotation(Vector3D(1.0, 0.0, 0.0), 1.0));
+  array.propagate(0, 1, 0.5);
+
+  // changing the angular velocity takes effect on the next step
+  array.setAngularVelocity(0, Rotation());
+  Quaternion const turned = array.orientation(0);
+  array.propagate(0, 1, 0.5);
+  testEqual(array.orientation(0), turned);
+
+  array.setOrientation(0, Quaternion(0.0, 0.0, 1.0, 0.0));
+  testEqual(array.orientation(0), Quaternion(0.0, 0.0, 1.0, 0.0));
+
+  array.remove(0);
+  array.propagate(0, 1, 0.5);
+  testEqual(array.orientation(0), Quaternion());
+}
+
+}
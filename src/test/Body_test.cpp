@@ -21,6 +21,9 @@ UNITTEST(Body, mass)
   Body b(3, 10.0);
 
   testEqual(b.mass(), 10.0);
+
+  b.setMass(12.5);
+  testEqual(b.mass(), 12.5);
 }
 
 UNITTEST(Body, name)
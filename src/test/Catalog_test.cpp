@@ -0,0 +1,168 @@
+/**
+* @file Catalog_test.cpp
+* @brief Unit tests for the Catalog class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Catalog.hpp"
+#include "CatalogOrbits.hpp"
+#include "KeplerOrbit.hpp"
+#include "UnitTest.hpp"
+
+#include <cmath>
+
+
+namespace gravitree
+{
+
+namespace
+{
+
+constexpr CatalogBody const BODIES[] = {
+  CatalogBody(0, 1.9885e30),
+  CatalogBody(3, 0, 5.97237e24, 1.49598023e11, 0.0167086, 0.0, -0.1965, \
+      1.9933, 0.3),
+  CatalogBody(4, 3, 7.342e22, 3.844e8, 0.0549, 0.0898, 2.18, 5.55, 1.0),
+  CatalogBody(5, 0, 6.4171e23, 2.279392e11, 0.0934, 0.0323, 0.865, 5.0, \
+      2.0),
+  CatalogBody(6, 0, 1.0e12, -2.0e11, 1.2, 0.5, 0.1, 0.2, 0.0)
+};
+
+constexpr size_t const NUM_BODIES = sizeof(BODIES) / sizeof(BODIES[0]);
+
+// evaluated by the compiler
+static_assert(Catalog::find(BODIES, 4) == 2, "Moon not found");
+static_assert(Catalog::find(BODIES, 7) == NUM_BODIES, "Missing body found");
+static_assert(Catalog::period(BODIES, 1) > 3.15e7 && \
+    Catalog::period(BODIES, 1) < 3.16e7, "Wrong period of the earth");
+static_assert(Catalog::periapsis(BODIES, 2) < Catalog::apoapsis(BODIES, 2), \
+    "Wrong apsides of the moon");
+
+// a large catalog, where each body i orbits body (i-1)/2
+constexpr CatalogBody member(
+    size_t const i)
+{
+  return i == 0 ? CatalogBody(0, 1.0e30) : \
+      CatalogBody(i, (i-1) / 2, 1.0e30 / (i+1), 1.0e12 / (i+1), 0.01, 0.1, \
+          0.2, 0.3, 0.4);
+}
+
+#define MEMBERS_2(i) member(i), member(i+1)
+#define MEMBERS_8(i) MEMBERS_2(i), MEMBERS_2(i+2), MEMBERS_2(i+4), \
+    MEMBERS_2(i+6)
+#define MEMBERS_32(i) MEMBERS_8(i), MEMBERS_8(i+8), MEMBERS_8(i+16), \
+    MEMBERS_8(i+24)
+#define MEMBERS_128(i) MEMBERS_32(i), MEMBERS_32(i+32), MEMBERS_32(i+64), \
+    MEMBERS_32(i+96)
+
+constexpr CatalogBody const LARGE[] = {
+  MEMBERS_128(0), MEMBERS_128(128), MEMBERS_128(256), MEMBERS_128(384)
+};
+
+#undef MEMBERS_128
+#undef MEMBERS_32
+#undef MEMBERS_8
+#undef MEMBERS_2
+
+constexpr size_t const NUM_LARGE = sizeof(LARGE) / sizeof(LARGE[0]);
+
+static_assert(Catalog::find(LARGE, 0) == 0, "First body not found");
+static_assert(Catalog::find(LARGE, 401) == 401, "Body not found");
+static_assert(Catalog::find(LARGE, NUM_LARGE - 1) == NUM_LARGE - 1, \
+    "Last body not found");
+static_assert(Catalog::find(LARGE, NUM_LARGE) == NUM_LARGE, \
+    "Missing body found");
+static_assert(Catalog::parentMass(LARGE, NUM_LARGE - 1) == \
+    LARGE[(NUM_LARGE - 2) / 2].mass(), "Wrong parent of the last body");
+
+constexpr CatalogOrbits<NUM_LARGE> const LARGE_ORBITS(LARGE);
+
+static_assert(LARGE_ORBITS[NUM_LARGE - 1].mu == \
+    Catalog::mu(LARGE, NUM_LARGE - 1), "Wrong orbit of the last body");
+
+}
+
+UNITTEST(Catalog, matchesKeplerOrbit)
+{
+  for (size_t i = 1; i < NUM_BODIES; ++i) {
+    CatalogBody const & body = BODIES[i];
+    KeplerOrbit const orbit(body.semimajorAxis(), body.eccentricity(), \
+        body.inclination(), body.longitudeOfAscendingNode(), \
+        body.argumentOfPeriapsis(), Catalog::parentMass(BODIES, i));
+
+    testNearEqual(Catalog::meanMotion(BODIES, i), orbit.meanMotion(), \
+        1.0e-15, 0.0);
+    testNearEqual(Catalog::angularMomentum(BODIES, i), \
+        orbit.angularMomentum(), 1.0e-15, 0.0);
+    testNearEqual(Catalog::periapsis(BODIES, i), orbit.periapsis(), \
+        1.0e-15, 0.0);
+    if (body.eccentricity() < 1.0) {
+      testNearEqual(Catalog::period(BODIES, i), orbit.period(), 1.0e-15, \
+          0.0);
+      testNearEqual(Catalog::apoapsis(BODIES, i), orbit.apoapsis(), \
+          1.0e-15, 0.0);
+    } else {
+      testTrue(std::isnan(Catalog::period(BODIES, i)));
+      testTrue(std::isinf(Catalog::apoapsis(BODIES, i)));
+    }
+  }
+  testEqual(Catalog::mu(BODIES, 2), BODIES[1].mass() * Gravity::G);
+}
+
+UNITTEST(Catalog, derived)
+{
+  constexpr CatalogOrbits<NUM_BODIES> const orbits(BODIES);
+  for (size_t i = 1; i < NUM_BODIES; ++i) {
+    CatalogBody const & body = BODIES[i];
+    KeplerOrbit const expected(body.semimajorAxis(), body.eccentricity(), \
+        body.inclination(), body.longitudeOfAscendingNode(), \
+        body.argumentOfPeriapsis(), Catalog::parentMass(BODIES, i));
+    KeplerOrbit const orbit(body.semimajorAxis(), body.eccentricity(), \
+        body.inclination(), body.longitudeOfAscendingNode(), \
+        body.argumentOfPeriapsis(), Catalog::parentMass(BODIES, i), \
+        orbits[i]);
+
+    testEqual(orbit.mu(), expected.mu());
+    testNearEqual(orbit.meanMotion(), expected.meanMotion(), 1.0e-15, 0.0);
+    testNearEqual(orbit.semilatusRectum(), expected.semilatusRectum(), \
+        1.0e-15, 0.0);
+    testNearEqual(orbit.angularMomentum(), expected.angularMomentum(), \
+        1.0e-15, 0.0);
+    testNearEqual(orbit.semiminorAxis(), expected.semiminorAxis(), \
+        1.0e-15, 0.0);
+    testNearEqual(orbit.halfAngleRatio(), expected.halfAngleRatio(), \
+        1.0e-15, 0.0);
+    testNearEqual(orbit.perifocalP().distance(expected.perifocalP()), 0.0, \
+        0.0, 1.0e-15);
+    testNearEqual(orbit.perifocalQ().distance(expected.perifocalQ()), 0.0, \
+        0.0, 1.0e-15);
+    testTrue(orbit.propagator() == expected.propagator());
+  }
+  testEqual(orbits.data(), &orbits[0]);
+  testEqual(orbits[0].mu, 0.0);
+}
+
+UNITTEST(Catalog, findLarge)
+{
+  testEqual(NUM_LARGE, 512u);
+  for (size_t i = 0; i < NUM_LARGE; ++i) {
+    testEqual(Catalog::find(LARGE, i), i);
+    testEqual(Catalog::parentMass(LARGE, i), \
+        LARGE[i == 0 ? 0 : (i-1) / 2].mass());
+  }
+  testEqual(Catalog::find(LARGE, NUM_LARGE), NUM_LARGE);
+
+  // the first of repeated entries
+  CatalogBody const repeated[] = {
+    CatalogBody(0, 1.0), CatalogBody(2, 0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0),
+    CatalogBody(1, 0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0),
+    CatalogBody(2, 0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0)
+  };
+  testEqual(Catalog::find(repeated, 2), 1u);
+}
+
+}
@@ -0,0 +1,62 @@
+/**
+* @file CompactVector3D_test.cpp
+* @brief Unit tests for the CompactVector3D class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "CompactVector3D.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+
+namespace gravitree
+{
+
+UNITTEST(CompactVector3D, size)
+{
+  testEqual(sizeof(CompactVector3D), 3*sizeof(double));
+}
+
+UNITTEST(CompactVector3D, fromVector3D)
+{
+  Vector3D const v(1.5, -2.25, 1.0e10);
+  CompactVector3D const c(v);
+
+  testEqual(c.x(), 1.5);
+  testEqual(c.y(), -2.25);
+  testEqual(c.z(), 1.0e10);
+  testEqual(c.toVector3D(), v);
+}
+
+UNITTEST(CompactVector3D, arithmetic)
+{
+  CompactVector3D const v(5.0, 0.0, 0.0);
+  CompactVector3D const u(0.0, 5.0, 0.0);
+
+  testEqual(v + u, CompactVector3D(5.0, 5.0, 0.0));
+  testEqual(v - u, CompactVector3D(5.0, -5.0, 0.0));
+  testEqual(-v, CompactVector3D(-5.0, 0.0, 0.0));
+  testEqual(v * 2.0, CompactVector3D(10.0, 0.0, 0.0));
+  testEqual(v / 5.0, CompactVector3D(1.0, 0.0, 0.0));
+  testEqual(v * u, 0.0);
+  testEqual(v.cross(u), CompactVector3D(0.0, 0.0, 25.0));
+  testEqual(v.magnitude(), 5.0);
+  testEqual(v.distance2(u), 50.0);
+  testEqual(v.normalized(), CompactVector3D(1.0, 0.0, 0.0));
+  testTrue(v != u);
+
+  CompactVector3D w = v;
+  w += u;
+  w -= v;
+  w *= 2.0;
+  testEqual(w, CompactVector3D(0.0, 10.0, 0.0));
+
+  testTrue(w.isValid());
+  testFalse(CompactVector3D().normalized().isValid());
+}
+
+}
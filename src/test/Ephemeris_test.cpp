@@ -0,0 +1,127 @@
+/**
+* @file Ephemeris_test.cpp
+* @brief Unit tests for the Ephemeris class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Ephemeris.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace gravitree
+{
+
+UNITTEST(Ephemeris, WithinTolerance)
+{
+  for (double const e : {0.0167, 0.3, 0.8}) {
+    KeplerOrbit orbit(1.496e11, e, 0.12, -0.19, 1.99, 1.9885e30);
+    OrbitalState const state(orbit, 0.3);
+
+    Ephemeris const ephemeris(state, 1.0);
+    testTrue(ephemeris.numSegments() > 0);
+
+    // including times before the state and after several periods
+    OrbitalState exact = state;
+    for (int i = -50; i <= 200; ++i) {
+      second_type const time = i * orbit.period() / 37.3;
+      exact.setTime(time);
+
+      Vector3D position;
+      Vector3D velocity;
+      ephemeris.state(time, &position, &velocity);
+      testNearEqual(position.distance(exact.position()), 0.0, 0.0, 1.0);
+      testEqual(position, ephemeris.position(time));
+      testNearEqual(velocity.distance(exact.velocity()), 0.0, 0.0, \
+          1.0 * orbit.meanMotion());
+    }
+  }
+}
+
+UNITTEST(Ephemeris, TighterToleranceMoreSegments)
+{
+  KeplerOrbit orbit(7.0e6, 0.4, 0.9, 0.0, 0.3, 5.972e24);
+  OrbitalState const state(orbit, 0.0);
+
+  Ephemeris const coarse(state, 1.0e3);
+  Ephemeris const fine(state, 1.0e-3);
+  testTrue(coarse.numSegments() < fine.numSegments());
+}
+
+UNITTEST(Ephemeris, VelocityTolerance)
+{
+  KeplerOrbit orbit(7.0e6, 0.4, 0.9, 0.0, 0.3, 5.972e24);
+  OrbitalState const state(orbit, 0.0);
+
+  // a loose position tolerance alone allows a coarse fit of the velocity
+  Ephemeris const coarse(state, 1.0e3, 1.0e3);
+  Ephemeris const fine(state, 1.0e3, 1.0e-6);
+  testTrue(coarse.numSegments() < fine.numSegments());
+
+  OrbitalState exact = state;
+  for (int i = 0; i < 200; ++i) {
+    second_type const time = i * orbit.period() / 37.3;
+    exact.setTime(time);
+    testNearEqual(fine.velocity(time).distance(exact.velocity()), 0.0, 0.0, \
+        1.0e-6);
+  }
+
+  bool caught = false;
+  try {
+    Ephemeris const ephemeris(state, 1.0, 0.0);
+  } catch (std::invalid_argument const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+UNITTEST(Ephemeris, ConcurrentQueries)
+{
+  KeplerOrbit orbit(7.0e6, 0.4, 0.9, 0.0, 0.3, 5.972e24);
+  OrbitalState const state(orbit, 0.0);
+
+  // the fit is built before the first query, so none of them write
+  Ephemeris const ephemeris(state, 1.0);
+  Ephemeris const expected(state, 1.0);
+
+  std::vector<Vector3D> positions(4 * 64);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&ephemeris, &orbit, &positions, t]() {
+      for (size_t i = 0; i < 64; ++i) {
+        positions[t*64 + i] = ephemeris.position(i * orbit.period() / 17.0);
+      }
+    });
+  }
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    testEqual(positions[i], \
+        expected.position((i % 64) * orbit.period() / 17.0));
+  }
+}
+
+UNITTEST(Ephemeris, RequiresClosedOrbit)
+{
+  KeplerOrbit orbit(-7.0e6, 1.4, 0.0, 0.0, 0.0, 5.972e24);
+
+  bool caught = false;
+  try {
+    Ephemeris const ephemeris(OrbitalState(orbit, 0.0), 1.0);
+  } catch (std::invalid_argument const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+}
@@ -10,6 +10,7 @@
 #include "KeplerOrbit.hpp"
 #include "Gravity.hpp"
 #include "Constants.hpp"
+#include "Output.hpp"
 #include "UnitTest.hpp"
 
 #include <cmath>
@@ -69,6 +70,86 @@ UNITTEST(KeplerOrbit, angularMomentum)
   testNearEqual(orbit.angularMomentum(), h, 1e-3, 1e-2);
 }
 
+UNITTEST(KeplerOrbit, perifocalFrame)
+{
+  double const i = deg2rad(7.155);
+  double const W = deg2rad(-11.26064);
+  KeplerOrbit orbit(1.496e11, 0.01671022, i, W, deg2rad(114.20783), \
+      1.98847e30);
+
+  Vector3D const & p = orbit.perifocalP();
+  Vector3D const & q = orbit.perifocalQ();
+  testNearEqual(p.magnitude(), 1.0, 1e-15, 0.0);
+  testNearEqual(q.magnitude(), 1.0, 1e-15, 0.0);
+  testNearEqual(p*q, 0.0, 0.0, 1e-15);
+
+  // the frame is right handed about the angular momentum
+  Vector3D const w = p.cross(q);
+  testNearEqual(w.x(), std::sin(i)*std::sin(W), 1e-14, 1e-15);
+  testNearEqual(w.y(), -std::sin(i)*std::cos(W), 1e-14, 1e-15);
+  testNearEqual(w.z(), std::cos(i), 1e-14, 1e-15);
+}
+
+UNITTEST(KeplerOrbit, meanMotion)
+{
+  KeplerOrbit closed(1.496e11, 0.01671022, deg2rad(7.155),
+      deg2rad(-11.26064), 0.0, 1.98847e30);
+  testNearEqual(closed.meanMotion(), 2.0*Constants::PI/closed.period(), \
+      1e-14, 0.0);
 
+  // open orbits have no period, but still sweep mean anomally
+  KeplerOrbit open(-1.496e11, 1.5, 0.0, 0.0, 0.0, 1.98847e30);
+  testFalse(open.isClosed());
+  testNearEqual(open.meanMotion(), closed.meanMotion(), 1e-14, 0.0);
 }
 
+UNITTEST(KeplerOrbit, propagator)
+{
+  KeplerOrbit circular(4.2e7, 1.0e-6, 0.0, 0.0, 0.0, 5.972e24);
+  testTrue(circular.propagator() == \
+      KeplerOrbit::propagator_type::CIRCULAR);
+
+  KeplerOrbit elliptic(4.2e7, 0.01, 0.0, 0.0, 0.0, 5.972e24);
+  testTrue(elliptic.propagator() == \
+      KeplerOrbit::propagator_type::ELLIPTIC);
+
+  KeplerOrbit open(-4.2e7, 1.2, 0.0, 0.0, 0.0, 5.972e24);
+  testTrue(open.propagator() == \
+      KeplerOrbit::propagator_type::HYPERBOLIC);
+}
+
+UNITTEST(KeplerOrbit, derived)
+{
+  KeplerOrbit const expected(-4.2e7, 1.2, 0.1, 0.2, 0.3, 5.972e24);
+  KeplerOrbit::derived_struct const derived = {
+    expected.mu(),
+    expected.period(),
+    expected.meanMotion(),
+    expected.semilatusRectum(),
+    expected.angularMomentum(),
+    expected.semiminorAxis(),
+    expected.halfAngleRatio(),
+    {expected.perifocalP().x(), expected.perifocalP().y(), \
+        expected.perifocalP().z()},
+    {expected.perifocalQ().x(), expected.perifocalQ().y(), \
+        expected.perifocalQ().z()}
+  };
+
+  // the derived quantities are taken as they are
+  KeplerOrbit const orbit(-4.2e7, 1.2, 0.1, 0.2, 0.3, 5.972e24, derived);
+  testEqual(orbit.semimajorAxis(), expected.semimajorAxis());
+  testEqual(orbit.parentMass(), expected.parentMass());
+  testEqual(orbit.mu(), expected.mu());
+  testTrue(std::isnan(orbit.period()));
+  testEqual(orbit.meanMotion(), expected.meanMotion());
+  testEqual(orbit.semilatusRectum(), expected.semilatusRectum());
+  testEqual(orbit.angularMomentum(), expected.angularMomentum());
+  testEqual(orbit.semiminorAxis(), expected.semiminorAxis());
+  testEqual(orbit.halfAngleRatio(), expected.halfAngleRatio());
+  testEqual(orbit.perifocalP(), expected.perifocalP());
+  testEqual(orbit.perifocalQ(), expected.perifocalQ());
+  testTrue(orbit.propagator() == expected.propagator());
+}
+
+
+}
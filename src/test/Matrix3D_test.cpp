@@ -0,0 +1,51 @@
+/**
+* @file Matrix3D_test.cpp
+* @brief Unit tests for the Matrix3D class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Matrix3D.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+
+namespace gravitree
+{
+
+UNITTEST(Matrix3D, fromQuaternion)
+{
+  Quaternion const quat = Quaternion::fromRotation( \
+      Rotation(Vector3D(1.0, -2.0, 0.5), 2.4));
+  Matrix3D const mat(quat);
+
+  for (Vector3D const vec : {Vector3D(1.0, 0.0, 0.0), \
+      Vector3D(0.3, -1.2, 4.0), Vector3D(-7.0, 2.0, 0.1)}) {
+    testNearEqual((mat*vec).distance(quat.rotate(vec)), 0.0, 0.0, 1e-14);
+  }
+  testNearEqual(mat.determinant(), 1.0, 0.0, 1e-15);
+  testEqual(Matrix3D(Quaternion()), Matrix3D());
+}
+
+UNITTEST(Matrix3D, multiply)
+{
+  Matrix3D const a(Vector3D(1.0, 2.0, 3.0), Vector3D(0.0, 1.0, 4.0), \
+      Vector3D(5.0, 6.0, 0.0));
+  Matrix3D const b(Vector3D(-24.0, 18.0, 5.0), Vector3D(20.0, -15.0, -4.0), \
+      Vector3D(-5.0, 4.0, 1.0));
+
+  // b is the inverse of a
+  testEqual(a*b, Matrix3D());
+  testEqual(a*Matrix3D(), a);
+  testEqual(a.transposed().row(0), Vector3D(1.0, 0.0, 5.0));
+  testEqual(a.get(2, 1), 6.0);
+  testEqual(a.determinant(), 1.0);
+
+  Vector3D const vec(1.0, -1.0, 2.0);
+  testEqual(b*(a*vec), vec);
+}
+
+}
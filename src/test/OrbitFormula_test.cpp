@@ -0,0 +1,71 @@
+/**
+* @file OrbitFormula_test.cpp
+* @brief Unit tests for the OrbitFormula class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "OrbitFormula.hpp"
+#include "UnitTest.hpp"
+
+#include <cmath>
+
+
+namespace gravitree
+{
+
+namespace
+{
+
+// evaluated by the compiler
+static_assert(ConstexprSqrt::sqrt(16.0) == 4.0, "Inexact square root");
+static_assert(OrbitFormula::periapsis(2.0e9, 0.5) == 1.0e9, \
+    "Wrong periapsis");
+static_assert(OrbitFormula::apoapsis(2.0e9, 0.5) == 3.0e9, \
+    "Wrong apoapsis");
+static_assert(ConstexprTrig::sin(0.0) == 0.0, "Wrong sine of zero");
+static_assert(ConstexprTrig::cos(0.0) == 1.0, "Wrong cosine of zero");
+
+}
+
+UNITTEST(OrbitFormula, constexprSqrt)
+{
+  for (double const x : {1.0e-300, 2.5e-20, 0.3, 2.0, 1.0e7, 6.02e23, \
+      1.0e300}) {
+    testNearEqual(ConstexprSqrt::sqrt(x), RuntimeSqrt::sqrt(x), 1.0e-15, \
+        0.0);
+  }
+  testEqual(ConstexprSqrt::sqrt(0.0), 0.0);
+  testTrue(std::isnan(ConstexprSqrt::sqrt(-1.0)));
+  testTrue(std::isinf(ConstexprSqrt::sqrt(INFINITY)));
+}
+
+UNITTEST(OrbitFormula, constexprTrig)
+{
+  for (int i = -160; i <= 160; ++i) {
+    double const x = 0.1 * i + 0.01;
+    testNearEqual(ConstexprTrig::sin(x), std::sin(x), 0.0, 1.0e-15);
+    testNearEqual(ConstexprTrig::cos(x), std::cos(x), 0.0, 1.0e-15);
+  }
+}
+
+UNITTEST(OrbitFormula, sqrtPolicies)
+{
+  double const mu = OrbitFormula::mu(5.97237e24);
+  for (double const e : {0.0, 0.0549, 0.7, 1.2, 3.0}) {
+    double const a = e < 1.0 ? 3.844e8 : -3.844e8;
+    testNearEqual(OrbitFormula::meanMotion<ConstexprSqrt>(a, e, mu), \
+        OrbitFormula::meanMotion<RuntimeSqrt>(a, e, mu), 1.0e-15, 0.0);
+    testNearEqual(OrbitFormula::angularMomentum<ConstexprSqrt>(a, e, mu), \
+        OrbitFormula::angularMomentum<RuntimeSqrt>(a, e, mu), 1.0e-15, 0.0);
+    testNearEqual(OrbitFormula::semiminorAxis<ConstexprSqrt>(a, e), \
+        OrbitFormula::semiminorAxis<RuntimeSqrt>(a, e), 1.0e-15, 0.0);
+    testNearEqual(OrbitFormula::halfAngleRatio<ConstexprSqrt>(e), \
+        OrbitFormula::halfAngleRatio<RuntimeSqrt>(e), 1.0e-15, 0.0);
+  }
+}
+
+}
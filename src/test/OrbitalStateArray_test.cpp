@@ -0,0 +1,301 @@
+/**
+* @file OrbitalStateArray_test.cpp
+* @brief Unit tests for the OrbitalStateArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-14
+*/
+
+
+#include "OrbitalStateArray.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+#include <algorithm>
+#include <vector>
+
+
+namespace gravitree
+{
+
+UNITTEST(OrbitalStateArray, addAndGet)
+{
+  OrbitalStateArray states;
+
+  KeplerOrbit orbit(1.496e11, 0.0167, 0.12, -0.19, 1.99, 1.9885e30);
+  OrbitalState const state(orbit, 0.3);
+
+  size_t const slot = states.add(state, OrbitalStateArray::NO_PARENT);
+
+  testEqual(states.size(), 1U);
+  testEqual(states.parent(slot), OrbitalStateArray::NO_PARENT);
+
+  OrbitalState const copy = states.get(slot);
+  testEqual(copy.trueAnomally(), state.trueAnomally());
+  testEqual(copy.eccentricAnomally(), state.eccentricAnomally());
+  testEqual(copy.meanAnomally(), state.meanAnomally());
+  testEqual(copy.time(), state.time());
+  testEqual(copy.orbit().semimajorAxis(), orbit.semimajorAxis());
+  testEqual(copy.orbit().argumentOfPeriapsis(), orbit.argumentOfPeriapsis());
+  testEqual(states.position(slot), state.position());
+  testEqual(states.velocity(slot), state.velocity());
+}
+
+UNITTEST(OrbitalStateArray, propagateMatchesSetTime)
+{
+  OrbitalStateArray states;
+
+  std::vector<OrbitalState> expected;
+  for (size_t i = 0; i < 16; ++i) {
+    KeplerOrbit orbit(1.0e9 * (i+1), 0.05 * i, 0.1 * i, 0.2, 0.3, 1.0e25);
+    expected.emplace_back(orbit, 0.1 * i);
+    states.add(expected.back(), OrbitalStateArray::NO_PARENT);
+  }
+
+  states.propagate(0, 8, 1000.0);
+  states.propagate(8, 16, 1000.0);
+
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i].setTime(expected[i].time() + 1000.0);
+    testEqual(states.get(i).trueAnomally(), expected[i].trueAnomally());
+    testEqual(states.position(i), expected[i].position());
+  }
+}
+
+UNITTEST(OrbitalStateArray, reuseSlot)
+{
+  OrbitalStateArray states;
+
+  KeplerOrbit orbit(1.0e9, 0.1, 0.0, 0.0, 0.0, 1.0e25);
+  size_t const a = states.add(OrbitalState(orbit, 0.0), \
+      OrbitalStateArray::NO_PARENT);
+  size_t const b = states.add(OrbitalState(orbit, 1.0), a);
+
+  testEqual(states.parent(b), a);
+
+  states.remove(b);
+
+  // free slots are stationary
+  states.propagate(0, states.size(), 1.0e4);
+  testEqual(states.position(b), Vector3D(0, 0, 0));
+
+  size_t const c = states.add(OrbitalState(orbit, 2.0), a);
+  testEqual(c, b);
+  testEqual(states.size(), 2U);
+  testEqual(states.get(c).trueAnomally(), 2.0);
+}
+
+UNITTEST(OrbitalStateArray, propagateOpenAndClosed)
+{
+  OrbitalStateArray states;
+
+  std::vector<OrbitalState> expected;
+  for (size_t i = 0; i < 16; ++i) {
+    double const e = (i % 2 == 0) ? 0.05 * i : 1.0 + 0.25 * i;
+    double const a = (e < 1.0 ? 1.0e9 : -1.0e9) * (i+1);
+    KeplerOrbit orbit(a, e, 0.1 * i, 0.2, 0.3, 1.0e25);
+    expected.emplace_back(orbit, 0.1 * i);
+    states.add(expected.back(), OrbitalStateArray::NO_PARENT);
+  }
+
+  // an open orbit replaced by a closed one, and a closed by an open
+  states.set(1, expected[0]);
+  states.set(0, expected[1]);
+  std::swap(expected[0], expected[1]);
+
+  states.propagate(0, 5, 1000.0);
+  states.propagate(5, 16, 1000.0);
+
+  for (size_t i = 0; i < expected.size(); ++i) {
+    OrbitalState const prediction = states.predict(i, 0.0);
+    expected[i].setTime(expected[i].time() + 1000.0);
+    testEqual(states.get(i).trueAnomally(), expected[i].trueAnomally());
+    testEqual(states.position(i), expected[i].position());
+    testEqual(prediction.trueAnomally(), expected[i].trueAnomally());
+  }
+}
+
+UNITTEST(OrbitalStateArray, propagateGroups)
+{
+  OrbitalStateArray states;
+  OrbitalStateArray grouped;
+
+  for (size_t i = 0; i < 18; ++i) {
+    double const e = i % 3 == 0 ? 1.0e-7 * i : \
+        (i % 3 == 1 ? 0.05 * i : 1.0 + 0.2 * i);
+    double const a = (e < 1.0 ? 1.0e9 : -1.0e9) * (i+1);
+    KeplerOrbit orbit(a, e, 0.1 * i, 0.2, 0.3, 1.0e25);
+    states.add(OrbitalState(orbit, 0.1 * i), OrbitalStateArray::NO_PARENT);
+    grouped.add(OrbitalState(orbit, 0.1 * i), OrbitalStateArray::NO_PARENT);
+  }
+
+  // moving an orbit between groups
+  KeplerOrbit const circular(3.0e9, 0.0, 0.0, 0.0, 0.0, 1.0e25);
+  states.set(1, OrbitalState(circular, 0.5));
+  grouped.set(1, OrbitalState(circular, 0.5));
+
+  testEqual(grouped.groupSize(KeplerOrbit::propagator_type::CIRCULAR), 7u);
+  testEqual(grouped.groupSize(KeplerOrbit::propagator_type::ELLIPTIC), 5u);
+  testEqual(grouped.groupSize(KeplerOrbit::propagator_type::HYPERBOLIC), 6u);
+
+  states.propagate(0, states.size(), 1.0e5);
+  for (KeplerOrbit::propagator_type const propagator : { \
+      KeplerOrbit::propagator_type::CIRCULAR, \
+      KeplerOrbit::propagator_type::ELLIPTIC, \
+      KeplerOrbit::propagator_type::HYPERBOLIC}) {
+    size_t const size = grouped.groupSize(propagator);
+    grouped.propagateGroup(propagator, 0, size / 2, 1.0e5);
+    grouped.propagateGroup(propagator, size / 2, size, 1.0e5);
+  }
+
+  for (size_t i = 0; i < states.size(); ++i) {
+    testEqual(grouped.position(i), states.position(i));
+    testEqual(grouped.get(i).trueAnomally(), states.get(i).trueAnomally());
+  }
+}
+
+UNITTEST(OrbitalStateArray, changePolicies)
+{
+  OrbitalStateArray states;
+
+  KeplerOrbit const orbits[] = {
+    KeplerOrbit(2.0e9, 0.0, 0.1, 0.2, 0.3, 1.0e25),
+    KeplerOrbit(2.0e9, 0.4, 0.1, 0.2, 0.3, 1.0e25),
+    KeplerOrbit(-2.0e9, 1.6, 0.1, 0.2, 0.3, 1.0e25)
+  };
+
+  // every state keeps its slot while it moves between groups, and removed
+  // states leave their groups
+  std::vector<size_t> policy;
+  for (size_t i = 0; i < 12; ++i) {
+    policy.emplace_back(i % 3);
+    states.add(OrbitalState(orbits[i % 3], 0.1 * i), \
+        OrbitalStateArray::NO_PARENT);
+  }
+  for (size_t round = 1; round < 4; ++round) {
+    for (size_t i = 0; i < states.size(); i += round) {
+      policy[i] = (policy[i] + round) % 3;
+      states.set(i, OrbitalState(orbits[policy[i]], 0.1 * i));
+    }
+  }
+  states.remove(4);
+  states.remove(7);
+
+  size_t sizes[KeplerOrbit::NUM_PROPAGATORS] = {0, 0, 0};
+  for (size_t i = 0; i < states.size(); ++i) {
+    if (i != 4 && i != 7) {
+      ++sizes[policy[i]];
+    }
+  }
+  for (size_t p = 0; p < KeplerOrbit::NUM_PROPAGATORS; ++p) {
+    KeplerOrbit::propagator_type const propagator = \
+        static_cast<KeplerOrbit::propagator_type>(p);
+    testEqual(states.groupSize(propagator), sizes[p]);
+    states.propagateGroup(propagator, 0, sizes[p], 1.0e4);
+  }
+
+  for (size_t i = 0; i < states.size(); ++i) {
+    if (i == 4 || i == 7) {
+      testEqual(states.position(i), Vector3D());
+    } else {
+      OrbitalState expected(orbits[policy[i]], 0.1 * i);
+      expected.setTime(expected.time() + 1.0e4);
+      testEqual(states.position(i), expected.position());
+    }
+  }
+}
+
+UNITTEST(OrbitalStateArray, predictState)
+{
+  OrbitalStateArray states;
+  for (size_t i = 0; i < 12; ++i) {
+    double const e = i % 3 == 0 ? 0.0 : (i % 3 == 1 ? 0.05 * i : 1.0 + 0.2 * i);
+    double const a = (e < 1.0 ? 1.0e9 : -1.0e9) * (i+1);
+    KeplerOrbit orbit(a, e, 0.1 * i, 0.2, 0.3, 1.0e25);
+    states.add(OrbitalState(orbit, 0.1 * i), OrbitalStateArray::NO_PARENT);
+  }
+
+  for (size_t i = 0; i < states.size(); ++i) {
+    Vector3D expectedPosition;
+    Vector3D expectedVelocity;
+    states.predict(i, 2.5e4).state(&expectedPosition, &expectedVelocity);
+
+    Vector3D position;
+    Vector3D velocity;
+    states.predictState(i, 2.5e4, &position, &velocity);
+    testEqual(position, expectedPosition);
+    testEqual(velocity, expectedVelocity);
+  }
+}
+
+UNITTEST(OrbitalStateArray, maxSpeed)
+{
+  OrbitalStateArray states;
+  for (size_t i = 0; i < 12; ++i) {
+    double const e = i % 3 == 0 ? 0.0 : (i % 3 == 1 ? 0.05 * i : 1.0 + 0.2 * i);
+    double const a = (e < 1.0 ? 1.0e9 : -1.0e9) * (i+1);
+    KeplerOrbit orbit(a, e, 0.1 * i, 0.2, 0.3, 1.0e25);
+    states.add(OrbitalState(orbit, 0.1 * i), OrbitalStateArray::NO_PARENT);
+
+    // the speed at periapsis
+    OrbitalState const periapsis(orbit, 0.0);
+    testNearEqual(states.maxSpeed(i), periapsis.velocity().magnitude(), \
+        1.0e-12, 0.0);
+    testTrue(states.maxSpeed(i) * (1.0 + 1.0e-12) >= \
+        states.velocity(i).magnitude());
+  }
+
+  states.remove(4);
+  testEqual(states.maxSpeed(4), 0.0);
+}
+
+UNITTEST(OrbitalStateArray, state)
+{
+  OrbitalStateArray states;
+  for (size_t i = 0; i < 16; ++i) {
+    KeplerOrbit orbit(1.0e9 * (i+1), 0.05 * i, 0.1 * i, 0.2, 0.3, 1.0e25);
+    states.add(OrbitalState(orbit, 0.1 * i), OrbitalStateArray::NO_PARENT);
+  }
+  states.propagate(0, states.size(), 1000.0);
+
+  std::vector<Vector3D> positions(12);
+  std::vector<Vector3D> velocities(12);
+  states.state(4, 16, positions.data(), velocities.data());
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    Vector3D position;
+    Vector3D velocity;
+    states.state(i + 4, &position, &velocity);
+    testEqual(position, states.position(i + 4));
+    testEqual(velocity, states.get(i + 4).velocity());
+    testEqual(positions[i], position);
+    testEqual(velocities[i], velocity);
+  }
+}
+
+UNITTEST(OrbitalStateArray, localPositions)
+{
+  OrbitalStateArray states;
+  for (size_t i = 0; i < 16; ++i) {
+    KeplerOrbit orbit(4.0e6 * (i+1), 0.06 * i, 0.1 * i, 0.2, 0.3, 5.972e24);
+    states.add(OrbitalState(orbit, 0.1 * i), OrbitalStateArray::NO_PARENT);
+  }
+  KeplerOrbit const flyby(-7.0e6, 1.4, 0.2, 0.1, 0.3, 5.972e24);
+  states.add(OrbitalState(flyby, -600.0), OrbitalStateArray::NO_PARENT);
+
+  // long enough that the anomalies include many turns
+  states.propagate(0, states.size(), 1.0e6);
+  states.propagate(16, 17, -1.0e6 + 1200.0);
+
+  std::vector<Vector3F> positions(states.size() - 2);
+  states.localPositions(2, states.size(), positions.data());
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    Vector3D const exact = states.position(i + 2);
+    testNearEqual(positions[i].toVector3D().distance(exact), 0.0, 0.0, \
+        1.0e-6 * exact.magnitude());
+  }
+}
+
+}
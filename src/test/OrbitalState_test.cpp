@@ -10,9 +10,13 @@
 #include "OrbitalState.hpp"
 #include "KeplerOrbit.hpp"
 #include "Constants.hpp"
+#include "Output.hpp"
 
 #include "UnitTest.hpp"
 
+#include <cmath>
+#include <vector>
+
 namespace gravitree
 {
 
@@ -141,6 +145,49 @@ UNITTEST(OrbitalState, fromVectorsAphelion)
   testNearEqual(state.velocity().magnitude(), 2.92913e4, 1.0e-3, 1.0);
 }
 
+UNITTEST(OrbitalState, fromVectorsRoundTrip)
+{
+  // inclined, equatorial (prograde and retrograde), circular and open orbits
+  std::vector<KeplerOrbit> const orbits{
+      KeplerOrbit(1.496e11, 0.0167, 0.12, -0.19, 1.99, 1.9885e30),
+      KeplerOrbit(7.0e6, 0.3, 0.0, 0.0, 0.8, 5.972e24),
+      KeplerOrbit(7.0e6, 0.3, Constants::PI, 0.0, 0.8, 5.972e24),
+      KeplerOrbit(7.0e6, 0.0, 0.0, 0.0, 0.0, 5.972e24),
+      KeplerOrbit(7.0e6, 0.0, Constants::PI, 0.0, 0.0, 5.972e24),
+      KeplerOrbit(4.2e7, 0.0, 0.9, 2.1, 0.0, 5.972e24),
+      KeplerOrbit(-2.0e7, 1.8, 0.35, 0.7, 1.05, 5.972e24)};
+
+  std::vector<Vector3D> positions;
+  std::vector<Vector3D> velocities;
+  std::vector<kilo_type> masses;
+  for (KeplerOrbit const & orbit : orbits) {
+    for (double const anomally : {0.0, 1.0, 2.0, -2.0}) {
+      OrbitalState const state(orbit, anomally);
+      positions.emplace_back(state.position());
+      velocities.emplace_back(state.velocity());
+      masses.emplace_back(orbit.parentMass());
+    }
+  }
+
+  std::vector<OrbitalState> states;
+  OrbitalState::fromVectors(positions.data(), velocities.data(), \
+      masses.data(), positions.size(), &states);
+  testEqual(states.size(), positions.size());
+
+  for (size_t i = 0; i < states.size(); ++i) {
+    OrbitalState const single = OrbitalState::fromVectors(positions[i], \
+        velocities[i], masses[i]);
+    testEqual(states[i].trueAnomally(), single.trueAnomally());
+    testEqual(states[i].position(), single.position());
+
+    double const scale = positions[i].magnitude();
+    testNearEqual(states[i].position().distance(positions[i]), 0.0, 0.0, \
+        1.0e-9 * scale);
+    testNearEqual(states[i].velocity().distance(velocities[i]), 0.0, 0.0, \
+        1.0e-9 * velocities[i].magnitude());
+  }
+}
+
 UNITTEST(OrbtialState, position)
 {
   KeplerOrbit orbit(1.496e11, 0.0167, deg2rad(7.155), deg2rad(-11.26064),
@@ -183,4 +230,119 @@ UNITTEST(OrbtialState, distance)
   testNearEqual(state.distance(), pos.magnitude(), 1.0e-3, 1.0);
 }
 
+UNITTEST(OrbitalState, hyperbolicFlyby)
+{
+  KeplerOrbit orbit(-2.0e7, 1.8, deg2rad(20.0), deg2rad(40.0), \
+      deg2rad(60.0), 5.972e24);
+  double const mu = orbit.mu();
+  OrbitalState state(orbit, 0);
+
+  testEqual(state.time(), 0.0);
+  testNearEqual(state.distance(), orbit.periapsis(), 1.0e-12, 1.0e-3);
+
+  // energy and angular momentum are kept along the whole flyby
+  for (double const t : {-5.0e4, -600.0, 1.0, 3.0e3, 1.0e6}) {
+    state.setTime(t);
+    Vector3D const pos = state.position();
+    Vector3D const vel = state.velocity();
+    testNearEqual(pos.magnitude(), state.distance(), 1.0e-12, 1.0e-3);
+    testNearEqual(vel*vel*0.5 - mu/pos.magnitude(), \
+        -mu / (2.0*orbit.semimajorAxis()), 1.0e-9, 1.0e-6);
+    testNearEqual(pos.cross(vel).magnitude(), orbit.angularMomentum(), \
+        1.0e-9, 1.0);
+
+    // and the state recovered from the vectors is the same
+    OrbitalState const copy = OrbitalState::fromVectors(pos, vel, \
+        orbit.parentMass());
+    testNearEqual(copy.time(), t, 1.0e-8, 1.0e-6);
+  }
+
+  // the flyby is symmetric about periapsis
+  state.setTime(-2.0e4);
+  meter_type const before = state.distance();
+  state.setTime(2.0e4);
+  testNearEqual(state.distance(), before, 1.0e-12, 1.0e-3);
+  testTrue(state.trueAnomally() > 0);
+}
+
+UNITTEST(OrbitalState, nearParabolic)
+{
+  // as the eccentricity approaches one, the orbit approaches a parabola of
+  // the same periapsis, for which Barker's equation gives the time
+  meter_type const periapsis = 7.0e6;
+  double const e = 1.0 + 1.0e-10;
+  KeplerOrbit orbit(periapsis / (1.0 - e), e, 0.0, 0.0, 0.0, 5.972e24);
+  double const mu = orbit.mu();
+
+  radian_type const v = 1.5;
+  double const D = std::tan(0.5 * v);
+  second_type const t = std::sqrt(2.0*periapsis*periapsis*periapsis/mu) * \
+      (D + D*D*D/3.0);
+
+  OrbitalState state(orbit, v);
+  testNearEqual(state.time(), t, 1.0e-6, 1.0e-6);
+
+  state.setTime(t);
+  testNearEqual(state.trueAnomally(), v, 1.0e-6, 1.0e-9);
+  testNearEqual(state.distance(), 2.0*periapsis / (1.0 + std::cos(v)), \
+      1.0e-6, 1.0e-3);
+}
+
+UNITTEST(OrbitalState, state)
+{
+  std::vector<OrbitalState> states;
+  for (int i = 0; i < 8; ++i) {
+    double const e = i < 4 ? 0.2 * i : 0.5 * i;
+    double const a = e < 1.0 ? 1.496e11 : -1.496e11;
+    KeplerOrbit orbit(a, e, deg2rad(7.155), deg2rad(-11.26064), \
+        deg2rad(114.20783), 1.9885e30);
+    states.emplace_back(orbit, 0.3 * i - 1.0);
+  }
+
+  std::vector<Vector3D> positions(states.size());
+  std::vector<Vector3D> velocities(states.size());
+  OrbitalState::state(states.data(), states.size(), positions.data(), \
+      velocities.data());
+
+  for (size_t i = 0; i < states.size(); ++i) {
+    Vector3D position;
+    Vector3D velocity;
+    states[i].state(&position, &velocity);
+    testEqual(position, states[i].position());
+    testEqual(velocity, states[i].velocity());
+    testEqual(positions[i], position);
+    testEqual(velocities[i], velocity);
+  }
+}
+
+UNITTEST(OrbitalState, advance)
+{
+  // a second of frames along a low orbit, and along a flyby
+  for (double const e : {0.0167, 0.7, 1.3}) {
+    double const a = e < 1.0 ? 7.0e6 : -7.0e6;
+    KeplerOrbit orbit(a, e, deg2rad(51.6), deg2rad(30.0), deg2rad(10.0), \
+        5.972e24);
+    OrbitalState state(orbit, -0.5);
+    OrbitalState expected = state;
+    for (int frame = 0; frame < 60; ++frame) {
+      state.advance(1.0 / 60.0);
+    }
+    expected.setTime(expected.time() + 1.0);
+
+    testNearEqual(state.time(), expected.time(), 1.0e-12, 1.0e-12);
+    testNearEqual(state.eccentricAnomally(), \
+        expected.eccentricAnomally(), 1.0e-12, 1.0e-14);
+    testNearEqual(state.trueAnomally(), expected.trueAnomally(), 1.0e-12, \
+        1.0e-14);
+    testNearEqual(state.position().distance(expected.position()), 0.0, \
+        0.0, 1.0e-6);
+
+    // a step too large to warm start from
+    state.advance(3.0e4);
+    expected.setTime(expected.time() + 3.0e4);
+    testNearEqual(state.trueAnomally(), expected.trueAnomally(), 1.0e-12, \
+        1.0e-12);
+  }
+}
+
 }
@@ -0,0 +1,76 @@
+/**
+* @file Propagator_test.cpp
+* @brief Unit tests for the propagator policies.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Propagator.hpp"
+#include "UnitTest.hpp"
+
+#include <cmath>
+
+
+namespace gravitree
+{
+
+UNITTEST(Propagator, CircularMatchesElliptic)
+{
+  for (double const e : {0.0, 1.0e-9, 1.0e-7, 1.0e-6, \
+      CircularPropagator::MAX_ECCENTRICITY}) {
+    double const ratio = std::sqrt((1.0+e) / (1.0-e));
+    for (int i = -100; i <= 100; ++i) {
+      // including many turns
+      radian_type const mean = i * 0.737;
+      // the rounding of the mean anomally grows with its magnitude
+      double const tolerance = 1.0e-15 * (std::abs(mean) + 10.0);
+
+      radian_type circular;
+      radian_type circularTrue;
+      CircularPropagator::solve(mean, e, ratio, &circular, &circularTrue);
+
+      radian_type elliptic;
+      radian_type ellipticTrue;
+      EllipticPropagator::solve(mean, e, ratio, &elliptic, &ellipticTrue);
+
+      testNearEqual(std::sin(circular), std::sin(elliptic), 0.0, tolerance);
+      testNearEqual(std::cos(circular), std::cos(elliptic), 0.0, tolerance);
+      testNearEqual(std::sin(circularTrue), std::sin(ellipticTrue), 0.0, \
+          tolerance);
+      testNearEqual(std::cos(circularTrue), std::cos(ellipticTrue), 0.0, \
+          tolerance);
+      testTrue(circularTrue >= -Constants::PI);
+      testTrue(circularTrue < Constants::PI);
+    }
+  }
+}
+
+UNITTEST(Propagator, AdvanceMatchesSolve)
+{
+  double const e = 0.4;
+  double const ratio = std::sqrt((1.0+e) / (1.0-e));
+
+  radian_type anomally;
+  radian_type trueAnomally;
+  EllipticPropagator::solve(1.0, e, ratio, &anomally, &trueAnomally);
+
+  radian_type expected;
+  radian_type expectedTrue;
+  EllipticPropagator::solve(1.01, e, ratio, &expected, &expectedTrue);
+  EllipticPropagator::advance(1.01, e, ratio, &anomally, &trueAnomally);
+  testNearEqual(anomally, expected, 0.0, 1.0e-14);
+  testNearEqual(trueAnomally, expectedTrue, 0.0, 1.0e-14);
+
+  double const h = 1.6;
+  double const open = std::sqrt((h+1.0) / (h-1.0));
+  HyperbolicPropagator::solve(2.0, h, open, &anomally, &trueAnomally);
+  HyperbolicPropagator::solve(2.02, h, open, &expected, &expectedTrue);
+  HyperbolicPropagator::advance(2.02, h, open, &anomally, &trueAnomally);
+  testNearEqual(anomally, expected, 0.0, 1.0e-14);
+  testNearEqual(trueAnomally, expectedTrue, 0.0, 1.0e-14);
+}
+
+}
@@ -0,0 +1,60 @@
+/**
+* @file Quaternion_test.cpp
+* @brief Unit tests for the Quaternion class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Quaternion.hpp"
+#include "Constants.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+
+namespace gravitree
+{
+
+UNITTEST(Quaternion, rotate)
+{
+  Quaternion const quarter = Quaternion::fromRotation( \
+      Rotation(Vector3D(0.0, 0.0, 2.0), Constants::PI / 2.0));
+
+  Vector3D const rotated = quarter.rotate(Vector3D(1.0, 0.0, 0.0));
+  testNearEqual(rotated.distance(Vector3D(0.0, 1.0, 0.0)), 0.0, 0.0, 1e-15);
+
+  Vector3D const back = quarter.conjugate().rotate(rotated);
+  testNearEqual(back.distance(Vector3D(1.0, 0.0, 0.0)), 0.0, 0.0, 1e-15);
+
+  testEqual(Quaternion().rotate(Vector3D(1.0, 2.0, 3.0)), \
+      Vector3D(1.0, 2.0, 3.0));
+  testEqual(Quaternion::fromRotation(Rotation()), Quaternion());
+}
+
+UNITTEST(Quaternion, compose)
+{
+  Quaternion const p = Quaternion::fromRotation( \
+      Rotation(Vector3D(1.0, 2.0, -1.0), 0.7));
+  Quaternion const q = Quaternion::fromRotation( \
+      Rotation(Vector3D(-3.0, 0.5, 2.0), 2.1));
+  Vector3D const vec(0.3, -1.2, 4.0);
+
+  // rotating by pq is rotating by q and then p
+  Vector3D const expected = p.rotate(q.rotate(vec));
+  testNearEqual((p*q).rotate(vec).distance(expected), 0.0, 0.0, 1e-14);
+  testNearEqual((p*q).magnitude(), 1.0, 0.0, 1e-15);
+}
+
+UNITTEST(Quaternion, toRotation)
+{
+  Rotation const rot(Vector3D(0.0, 0.6, 0.8), 1.3);
+  Rotation const result = Quaternion::fromRotation(rot).toRotation();
+
+  testNearEqual(result.axis().distance(rot.axis()), 0.0, 0.0, 1e-15);
+  testNearEqual(result.angle(), rot.angle(), 0.0, 1e-15);
+  testEqual(Quaternion(2.0, 0.0, 0.0, 0.0).normalized(), Quaternion());
+}
+
+}
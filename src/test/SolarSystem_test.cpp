@@ -9,8 +9,17 @@
 
 
 #include "SolarSystem.hpp"
+#include "Catalog.hpp"
+#include "CatalogOrbits.hpp"
+#include "Constants.hpp"
+#include "Gravity.hpp"
+#include "Output.hpp"
 #include "UnitTest.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
 
 namespace gravitree
 {
@@ -394,4 +403,1012 @@ UNITTEST(SolarSystem, GetPositionEarthRelativeToMoon)
   testNearEqual(pos.z(), 0.0, 1.0e-9, 1.0);
 }
 
+UNITTEST(SolarSystem, TickAdvancesBodies)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Vector3D pos = system.getBodyPositionRelativeTo(3, 0);
+  testNearEqual(pos.y(), 1.47095e11, 1.0e-3, 1.0);
+
+  // half a year should take the earth from perihelion to aphelion
+  system.tick(182.625*24*60*60);
+
+  pos = system.getBodyPositionRelativeTo(3, 0);
+
+  testNearEqual(pos.magnitude(), 1.521e11, 1.0e-3, 1.0);
+  testNearEqual(pos.y(), -1.521e11, 1.0e-3, 1.0);
+}
+
+UNITTEST(SolarSystem, TickIndependentOfThreads)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem serial(sun, 1);
+  SolarSystem parallel(sun, 4);
+
+  for (Body::id_type id = 1; id < 500; ++id) {
+    Body ship(id, 1.0e3);
+    double const d = static_cast<double>(id);
+    Vector3D const pos(1.0e11 + d*1.0e8, d*1.0e7, d*1.0e6);
+    Vector3D const vel(-d, 3.0e4 + d*10.0, 0);
+    serial.addBody(ship, pos, vel, 0);
+    parallel.addBody(ship, pos, vel, 0);
+  }
+
+  testEqual(parallel.numThreads(), 4U);
+
+  for (int i = 0; i < 10; ++i) {
+    serial.tick(3600.0);
+    parallel.tick(3600.0);
+  }
+
+  for (Body::id_type id = 1; id < 500; ++id) {
+    testEqual(serial.getBodyPositionRelativeTo(id, 0), \
+        parallel.getBodyPositionRelativeTo(id, 0));
+  }
+}
+
+UNITTEST(SolarSystem, RemoveBody)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun, 2);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Body moon(31, 7.342e22);
+  system.addBody(
+      moon,
+      Vector3D(-3.626e8, 0, 0),
+      Vector3D(0, -1.022e3, 0),
+      3);
+
+  Vector3D const before = system.getBodyPositionRelativeTo(31, 0);
+
+  system.removeBody(3);
+
+  Vector3D const after = system.getBodyPositionRelativeTo(31, 0);
+  testNearEqual(after.x(), before.x(), 1.0e-6, 1.0);
+  testNearEqual(after.y(), before.y(), 1.0e-6, 1.0);
+  testNearEqual(after.z(), before.z(), 1.0e-6, 1.0);
+
+  testEqual(system.getRelativeTo(0).size(), 2U);
+
+  // the moon should still move after losing its parent
+  system.tick(3600.0);
+  testTrue(system.getBodyPositionRelativeTo(31, 0).isValid());
+
+  bool caught = false;
+  try {
+    system.removeBody(0);
+  } catch (InvalidOperationException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+UNITTEST(SolarSystem, Handles)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  BodyHandle const sunHandle = system.getHandle(0);
+
+  Body earth(3, 5.97237e24);
+  BodyHandle const earthHandle = system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      sunHandle);
+
+  Body moon(31, 7.342e22);
+  BodyHandle const moonHandle = system.addBody(
+      moon,
+      Vector3D(-3.626e8, 0, 0),
+      Vector3D(0, -1.022e3, 0),
+      3);
+
+  testTrue(system.isValid(sunHandle));
+  testTrue(system.isValid(earthHandle));
+  testFalse(system.isValid(BodyHandle()));
+  testEqual(system.getHandle(31), moonHandle);
+  testEqual(system.getBody(earthHandle)->id(), 3UL);
+  testEqual(system.getBody(moonHandle)->mass(), 7.342e22);
+
+  Vector3D const pos = system.getBodyPositionRelativeTo(moonHandle, \
+      earthHandle);
+  testNearEqual(pos.x(), -3.626e8, 1.0e-9, 1.0);
+  testEqual(system.getRelativeTo(earthHandle).size(), 3U);
+
+  system.removeBody(earthHandle);
+  testFalse(system.isValid(earthHandle));
+  testTrue(system.isValid(moonHandle));
+
+  // the freed slot is reused, but the old handle must stay stale
+  Body mars(4, 6.4171e23);
+  BodyHandle const marsHandle = system.addBody(
+      mars,
+      Vector3D(2.067e11, 0, 0),
+      Vector3D(0, -2.650e4, 0),
+      sunHandle);
+  testEqual(marsHandle.slot(), earthHandle.slot());
+  testNotEqual(marsHandle, earthHandle);
+  testFalse(system.isValid(earthHandle));
+
+  bool caught = false;
+  try {
+    system.getBody(earthHandle);
+  } catch (std::out_of_range const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+UNITTEST(SolarSystem, GetPositionAcrossBranches)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Body moon(31, 7.342e22);
+  system.addBody(
+      moon,
+      Vector3D(-3.626e8, 0, 0),
+      Vector3D(0, -1.022e3, 0),
+      3);
+
+  Body ship(311, 1.0e4);
+  system.addBody(
+      ship,
+      Vector3D(0, 2.0e6, 0),
+      Vector3D(1.5e3, 0, 0),
+      31);
+
+  Body mars(4, 6.4171e23);
+  system.addBody(
+      mars,
+      Vector3D(2.067e11, 0, 0),
+      Vector3D(0, -2.650e4, 0),
+      0);
+
+  system.tick(3.0e5);
+
+  // both ways through the common ancestor should agree with the offsets from
+  // the root
+  Vector3D const shipPos = system.getBodyPositionRelativeTo(311, 0);
+  Vector3D const marsPos = system.getBodyPositionRelativeTo(4, 0);
+  Vector3D const earthPos = system.getBodyPositionRelativeTo(3, 0);
+
+  Vector3D const shipToMars = system.getBodyPositionRelativeTo(311, 4);
+  testNearEqual(shipToMars.x(), shipPos.x() - marsPos.x(), 1.0e-9, 1.0e-3);
+  testNearEqual(shipToMars.y(), shipPos.y() - marsPos.y(), 1.0e-9, 1.0e-3);
+
+  Vector3D const earthToShip = system.getBodyPositionRelativeTo(3, 311);
+  testNearEqual(earthToShip.x(), earthPos.x() - shipPos.x(), 1.0e-9, 1.0e-3);
+  testNearEqual(earthToShip.y(), earthPos.y() - shipPos.y(), 1.0e-9, 1.0e-3);
+
+  testEqual(system.getBodyPositionRelativeTo(311, 311), Vector3D());
+}
+
+UNITTEST(SolarSystem, BatchPositions)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun, 3);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Body moon(31, 7.342e22);
+  system.addBody(
+      moon,
+      Vector3D(-3.626e8, 0, 0),
+      Vector3D(0, -1.022e3, 0),
+      3);
+
+  for (Body::id_type id = 100; id < 200; ++id) {
+    Body ship(id, 1.0e4);
+    double const d = static_cast<double>(id);
+    system.addBody(ship, Vector3D(0, 2.0e6 + d*1.0e3, 0), \
+        Vector3D(1.5e3, 0, 0), 31);
+  }
+
+  system.tick(1.0e4);
+
+  // enough queries to be split between threads
+  std::vector<std::pair<Body::id_type, Body::id_type>> queries;
+  for (size_t i = 0; i < 5000; ++i) {
+    queries.emplace_back(100 + (i % 100), (i % 3 == 0) ? 0 : 100 + (i % 7));
+  }
+
+  std::vector<Vector3D> positions(queries.size());
+  system.getBodyPositionsRelativeTo(queries.data(), queries.size(), \
+      positions.data());
+
+  for (size_t i = 0; i < queries.size(); ++i) {
+    testEqual(positions[i], system.getBodyPositionRelativeTo( \
+        queries[i].first, queries[i].second));
+  }
+
+  std::vector<std::pair<BodyHandle, BodyHandle>> handleQueries{
+      {system.getHandle(31), system.getHandle(3)},
+      {system.getHandle(3), system.getHandle(150)}};
+  system.getBodyPositionsRelativeTo(handleQueries.data(), \
+      handleQueries.size(), positions.data());
+
+  testEqual(positions[0], system.getBodyPositionRelativeTo(31, 3));
+  testEqual(positions[1], system.getBodyPositionRelativeTo(3, 150));
+}
+
+UNITTEST(SolarSystem, RelativeToIntoBuffer)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  // a chain deep enough to overflow a recursive traversal
+  Body::id_type const depth = 100000;
+  for (Body::id_type id = 1; id <= depth; ++id) {
+    Body ship(id, 1.0);
+    system.addBody(ship, Vector3D(1.0, 0, 0), Vector3D(0, 1.0e-6, 0), id-1);
+  }
+
+  std::vector<std::pair<Body const *, Vector3D>> list;
+  system.getRelativeTo(depth, &list);
+  testEqual(list.size(), depth+1);
+
+  for (size_t i = 0; i < list.size(); i += 997) {
+    Body::id_type const id = list[i].first->id();
+    Vector3D const expected = system.getBodyPositionRelativeTo(id, depth);
+    testNearEqual(list[i].second.distance(expected), 0.0, 1.0e-9, 1.0e-3);
+  }
+
+  // refilling the list reuses its storage
+  std::pair<Body const *, Vector3D> const * const data = list.data();
+  system.getRelativeTo(0, &list);
+  testEqual(list.size(), depth+1);
+  testTrue(list.data() == data);
+  testTrue(list == system.getRelativeTo(0));
+}
+
+UNITTEST(SolarSystem, RelativeToSinglePrecision)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(earth, Vector3D(1.496e11, 0, 0), Vector3D(0, 2.978e4, 0), 0);
+
+  Body moon(31, 7.342e22);
+  system.addBody(moon, Vector3D(3.844e8, 0, 0), Vector3D(0, 1.022e3, 0), 3);
+
+  Body station(310, 4.2e5);
+  system.addBody(station, Vector3D(6.8e6, 0, 0), Vector3D(0, 2.6e2, 0), 31);
+
+  system.tick(1.0e5);
+  testTrue(!system.singlePrecision());
+
+  std::vector<std::pair<Body const *, Vector3F>> list;
+  for (int i = 0; i < 4; ++i) {
+    // enabled part way, and kept through ticks and changes to the tree
+    if (i == 1) {
+      system.setSinglePrecision(true);
+      testTrue(system.singlePrecision());
+    } else if (i == 3) {
+      system.addBody(Body(311, 1.0e3), Vector3D(0, 7.0e6, 0), \
+          Vector3D(-7.5e3, 0, 0), 31);
+    }
+
+    system.getRelativeTo(31, &list);
+    testEqual(list.size(), i < 3 ? 4u : 5u);
+
+    // each position is accurate relative to its distance from the origin
+    // body, and evaluated in single precision, relative to the distances
+    // along the path to it
+    for (std::pair<Body const *, Vector3F> const & entry : list) {
+      Vector3D const expected = \
+          system.getBodyPositionRelativeTo(entry.first->id(), 31);
+      meter_type const bound = entry.first->id() > 300 ? 2.0 : \
+          1.0e-6 * expected.magnitude() + 1.0;
+      testNearEqual(entry.second.toVector3D().distance(expected), 0.0, 0.0, \
+          bound);
+    }
+
+    system.tick(60.0);
+  }
+}
+
+UNITTEST(SolarSystem, LeaveSphereOfInfluence)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  OrbitalState const earthState(KeplerOrbit(1.496e11, 0.0, 0.0, 0.0, 0.0, \
+      sun.mass()), 0.0);
+  system.addBody(earth, earthState, 0);
+
+  Body moon(31, 7.342e22);
+  OrbitalState const moonState(KeplerOrbit(3.844e8, 0.0, 0.0, 0.0, 0.0, \
+      earth.mass()), 0.0);
+  system.addBody(moon, moonState, 3);
+
+  // an orbit starting well inside the sphere of the moon, but whose apoapsis
+  // is far outside of it
+  Body ship(100, 1.0e4);
+  OrbitalState const shipState = OrbitalState::fromVectors( \
+      Vector3D(5.0e7, 0, 0), Vector3D(0, 400.0, 0), moon.mass());
+  system.addBody(ship, shipState, 31);
+
+  system.tick(1.0);
+  testEqual(system.getParent(100)->id(), 31U);
+
+  system.tick(1.0e6);
+  testEqual(system.getParent(100)->id(), 3U);
+  testEqual(system.getParent(31)->id(), 3U);
+
+  // the move does not change where the ship is
+  OrbitalState moonNow = moonState;
+  OrbitalState shipNow = shipState;
+  moonNow.setTime(moonNow.time() + 1.0e6 + 1.0);
+  shipNow.setTime(shipNow.time() + 1.0e6 + 1.0);
+  Vector3D const expected = moonNow.position() + shipNow.position();
+  testNearEqual(system.getBodyPositionRelativeTo(100, 3).distance(expected), \
+      0.0, 1.0e-9, 1.0);
+}
+
+UNITTEST(SolarSystem, EnterSphereOfInfluence)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun, 2);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Body moon(31, 7.342e22);
+  system.addBody(
+      moon,
+      Vector3D(-3.626e8, 0, 0),
+      Vector3D(0, -1.022e3, 0),
+      3);
+
+  // a ship orbiting the earth just beside the moon, and one far from it
+  Body near(100, 1.0e4);
+  system.addBody(
+      near,
+      Vector3D(-3.526e8, 0, 0),
+      Vector3D(0, -1.05e3, 0),
+      3);
+  Body far(101, 1.0e4);
+  system.addBody(
+      far,
+      Vector3D(3.626e8, 0, 0),
+      Vector3D(0, 1.05e3, 0),
+      3);
+
+  Vector3D const before = system.getBodyPositionRelativeTo(100, 31);
+
+  system.tick(1.0);
+
+  testEqual(system.getParent(100)->id(), 31U);
+  testEqual(system.getParent(101)->id(), 3U);
+  testEqual(system.getParent(31)->id(), 3U);
+
+  Vector3D const after = system.getBodyPositionRelativeTo(100, 31);
+  testNearEqual(after.distance(before), 0.0, 1.0e-9, 1.0e4);
+}
+
+UNITTEST(SolarSystem, SetMass)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(earth, Vector3D(1.496e11, 0, 0), Vector3D(0, 2.978e4, 0), 0);
+
+  // two ships 50 km apart in low orbit
+  double const radius = 7.0e6;
+  double const speed = std::sqrt(Gravity::G * earth.mass() / radius);
+  Body first(100, 1.0e18);
+  system.addBody(first, Vector3D(radius, 0, 0), Vector3D(0, speed, 0), 3);
+  Body second(101, 1.0);
+  system.addBody(second, Vector3D(radius, 5.0e4, 0), Vector3D(0, speed, 0), \
+      3);
+
+  // a probe in a circular orbit about the first ship
+  double const distance = 1.0e3;
+  Body probe(102, 1.0);
+  system.addBody(probe, Vector3D(distance, 0, 0), \
+      Vector3D(0, std::sqrt(Gravity::G * first.mass() / distance), 0), 100);
+
+  // the second ship is outside the sphere of the first
+  system.tick(1.0);
+  testEqual(system.getParent(101)->id(), 3U);
+  testNearEqual(system.getBodyPositionRelativeTo(102, 100).magnitude(), \
+      distance, 1.0e-6, 1.0e-6);
+
+  Vector3D const before = system.getBodyPositionRelativeTo(102, 100);
+  system.setMass(100, 1.0e20);
+  testEqual(system.getBody(100)->mass(), 1.0e20);
+
+  // the probe continues from where it was, but is now too slow to stay in
+  // a circle about the heavier ship
+  testNearEqual(system.getBodyPositionRelativeTo(102, 100).distance(before), \
+      0.0, 1.0e-9, 1.0e-6);
+  system.tick(0.25);
+  testTrue(system.getBodyPositionRelativeTo(102, 100).magnitude() < \
+      0.9 * distance);
+
+  // the sphere of the first ship has grown to reach the second
+  testEqual(system.getParent(101)->id(), 100U);
+  testEqual(system.getParent(102)->id(), 100U);
+
+  system.setMass(system.getHandle(101), 2.0);
+  testEqual(system.getBody(system.getHandle(101))->mass(), 2.0);
+}
+
+UNITTEST(SolarSystem, BodiesWithin)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun, 2);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  // a ring of ships around the earth
+  for (Body::id_type id = 100; id < 1100; ++id) {
+    Body ship(id, 1.0e4);
+    double const angle = static_cast<double>(id) * 0.1;
+    double const radius = 7.0e6 + static_cast<double>(id) * 1.0e4;
+    double const speed = std::sqrt(Gravity::G * earth.mass() / radius);
+    system.addBody(ship, \
+        Vector3D(radius*std::cos(angle), radius*std::sin(angle), 0), \
+        Vector3D(-speed*std::sin(angle), speed*std::cos(angle), 0), 3);
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    system.tick(600.0);
+
+    std::vector<Body const *> list;
+    system.getBodiesWithin(150, 2.0e6, &list);
+
+    std::vector<Body::id_type> found;
+    for (Body const * const body : list) {
+      found.emplace_back(body->id());
+    }
+    std::sort(found.begin(), found.end());
+
+    std::vector<Body::id_type> expected;
+    for (std::pair<Body const *, Vector3D> const & entry : \
+        system.getRelativeTo(150)) {
+      if (entry.second.magnitude() <= 2.0e6) {
+        expected.emplace_back(entry.first->id());
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    testTrue(found == expected);
+    testTrue(std::find(found.begin(), found.end(), 150) != found.end());
+  }
+
+  // a box around the earth holds the earth and every ship, but not the sun
+  std::vector<Body const *> list;
+  system.getBodiesInside(Vector3D(-3.0e7, -3.0e7, -3.0e7), \
+      Vector3D(3.0e7, 3.0e7, 3.0e7), 3, &list);
+  testEqual(list.size(), 1001U);
+
+  system.getBodiesWithin(Vector3D(0, 0, 0), system.getHandle(0), 1.0e3, \
+      &list);
+  testEqual(list.size(), 1U);
+  testEqual(list[0]->id(), 0U);
+
+  // removing a body rebuilds the index
+  system.removeBody(3);
+  system.getBodiesInside(Vector3D(-1.0e12, -1.0e12, -1.0e12), \
+      Vector3D(1.0e12, 1.0e12, 1.0e12), 0, &list);
+  testEqual(list.size(), 1001U);
+}
+
+UNITTEST(SolarSystem, ConcurrentQueries)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun, 2);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(earth, Vector3D(1.496e11, 0, 0), Vector3D(0, 2.978e4, 0), 0);
+
+  for (Body::id_type id = 100; id < 400; ++id) {
+    Body ship(id, 1.0e4);
+    double const angle = static_cast<double>(id) * 0.1;
+    double const radius = 7.0e6 + static_cast<double>(id) * 1.0e4;
+    double const speed = std::sqrt(Gravity::G * earth.mass() / radius);
+    system.addBody(ship, \
+        Vector3D(radius*std::cos(angle), radius*std::sin(angle), 0), \
+        Vector3D(-speed*std::sin(angle), speed*std::cos(angle), 0), 3);
+  }
+  system.tick(600.0);
+
+  std::vector<std::pair<Body const *, Vector3D>> const expected = \
+      system.getRelativeTo(150);
+
+  // the queries only read the state left by tick(), so each thread sees the
+  // same positions
+  std::vector<int> matches(4, 0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < matches.size(); ++t) {
+    threads.emplace_back([&system, &expected, &matches, t]() {
+      std::vector<std::pair<Body const *, Vector3D>> list;
+      std::vector<Body const *> near;
+      std::pair<Body::id_type, Body::id_type> const query(120, 150);
+      Vector3D batch;
+      for (int round = 0; round < 20; ++round) {
+        system.getRelativeTo(150, &list);
+        system.getBodiesWithin(150, 2.0e6, &near);
+        system.getBodyPositionsRelativeTo(&query, 1, &batch);
+        if (list == expected && \
+            batch == system.getBodyPositionRelativeTo(120, 150)) {
+          ++matches[t];
+        }
+      }
+    });
+  }
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+
+  for (int const count : matches) {
+    testEqual(count, 20);
+  }
+}
+
+UNITTEST(SolarSystem, ClosestApproachHeadOn)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  // two ships on the same circular orbit, going opposite ways, which meet a
+  // quarter of an orbit later
+  double const radius = 1.0e7;
+  Body prograde(100, 1.0e3);
+  OrbitalState const progradeState(KeplerOrbit(radius, 0.0, 0.0, 0.0, 0.0, \
+      earth.mass()), 0.0);
+  system.addBody(prograde, progradeState, 3);
+  Body retrograde(101, 1.0e3);
+  OrbitalState const retrogradeState(KeplerOrbit(radius, 0.0, Constants::PI, \
+      0.0, 0.0, earth.mass()), Constants::PI);
+  system.addBody(retrograde, retrogradeState, 3);
+
+  double const period = progradeState.orbit().period();
+
+  Approach const approach = system.findClosestApproach(100, 101, 0.0, \
+      0.4 * period);
+  testEqual(approach.body()->id(), 101U);
+  testNearEqual(approach.time(), 0.25 * period, 1.0e-6, 1.0e-2);
+  testNearEqual(approach.distance(), 0.0, 1.0e-6, 1.0);
+
+  // the same approach found starting later in the interval
+  Approach const later = system.findClosestApproach(system.getHandle(101), \
+      system.getHandle(100), 0.1 * period, 0.3 * period);
+  testNearEqual(later.time(), 0.25 * period, 1.0e-6, 1.0e-2);
+}
+
+UNITTEST(SolarSystem, ClosestApproachMatchesSampling)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  OrbitalState const earthState(KeplerOrbit(1.496e11, 0.0167, 0.0, 0.0, 0.0, \
+      sun.mass()), 0.0);
+  system.addBody(earth, earthState, 0);
+
+  Body moon(31, 7.342e22);
+  OrbitalState const moonState(KeplerOrbit(3.844e8, 0.0549, 0.09, 0.0, 0.0, \
+      earth.mass()), 1.0);
+  system.addBody(moon, moonState, 3);
+
+  Body ship(100, 1.0e4);
+  OrbitalState const shipState(KeplerOrbit(2.0e8, 0.3, 0.2, 1.0, 2.0, \
+      earth.mass()), 2.0);
+  system.addBody(ship, shipState, 3);
+
+  second_type const duration = 3.0e6;
+  Approach const approach = system.findClosestApproach(100, 31, 0.0, \
+      duration);
+
+  // sample densely
+  meter_type sampled = INFINITY;
+  for (second_type time = 0.0; time <= duration; time += 60.0) {
+    OrbitalState moonNow = moonState;
+    OrbitalState shipNow = shipState;
+    moonNow.setTime(moonNow.time() + time);
+    shipNow.setTime(shipNow.time() + time);
+    sampled = std::min(sampled, \
+        moonNow.position().distance(shipNow.position()));
+  }
+
+  testTrue(approach.distance() <= sampled);
+  testNearEqual(approach.distance(), sampled, 1.0e-3, 1.0);
+  testTrue(approach.time() >= 0.0 && approach.time() <= duration);
+}
+
+UNITTEST(SolarSystem, ClosestApproachFastFlyby)
+{
+  Body earth(3, 5.97237e24);
+
+  SolarSystem system(earth);
+
+  // two ships on open orbits passing each other in opposite directions,
+  // within minutes of the start of a day long interval, where neither orbit
+  // has a period to sample by
+  OrbitalState const firstState(KeplerOrbit(-4.485e7, 1.075, 0.0, 0.0, \
+      2.506, earth.mass()), -0.1626);
+  system.addBody(Body(100, 1.0e3), firstState, 3);
+  OrbitalState const secondState(KeplerOrbit(-1.637e7, 1.08, 3.032, 0.0, \
+      0.2695, earth.mass()), -0.6092);
+  system.addBody(Body(101, 1.0e3), secondState, 3);
+
+  second_type const duration = 1.0e5;
+  Approach const approach = system.findClosestApproach(100, 101, 0.0, \
+      duration);
+
+  // sample densely
+  meter_type sampled = INFINITY;
+  second_type sampledTime = 0.0;
+  for (second_type time = 0.0; time <= duration; time += 5.0) {
+    OrbitalState first = firstState;
+    OrbitalState second = secondState;
+    first.setTime(first.time() + time);
+    second.setTime(second.time() + time);
+    meter_type const distance = first.position().distance(second.position());
+    if (distance < sampled) {
+      sampled = distance;
+      sampledTime = time;
+    }
+  }
+
+  testTrue(sampledTime > 0.0 && sampledTime < 1.0e3);
+  testTrue(approach.distance() <= sampled);
+  testNearEqual(approach.distance(), sampled, 1.0e-3, 1.0);
+  testNearEqual(approach.time(), sampledTime, 0.0, 5.0);
+}
+
+UNITTEST(SolarSystem, ClosestApproaches)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun, 3);
+
+  Body earth(3, 5.97237e24);
+  system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Body mars(4, 6.4171e23);
+  system.addBody(
+      mars,
+      Vector3D(0, 2.067e11, 0),
+      Vector3D(2.65e4, 0, 0),
+      0);
+
+  // ships on inclined orbits of increasing size around the earth, and one
+  // around mars
+  for (Body::id_type id = 100; id < 140; ++id) {
+    Body ship(id, 1.0e3);
+    double const offset = static_cast<double>(id - 100);
+    OrbitalState const state(KeplerOrbit(7.0e6 + offset * 5.0e5, 0.0, \
+        0.01 * offset, 0.3 * offset, 0.0, earth.mass()), offset);
+    system.addBody(ship, state, 3);
+  }
+  Body far(200, 1.0e3);
+  OrbitalState const farState(KeplerOrbit(5.0e6, 0.0, 0.0, 0.0, 0.0, \
+      mars.mass()), 0.0);
+  system.addBody(far, farState, 4);
+
+  meter_type const threshold = 3.5e6;
+  std::vector<Approach> list;
+  system.findClosestApproaches(110, 0.0, 2.0e4, threshold, &list);
+
+  // the same as searching each pair
+  std::vector<Approach> expected;
+  for (Body::id_type const id : {0, 3, 4, 200}) {
+    testTrue(system.findClosestApproach(110, id, 0.0, 2.0e4).distance() > \
+        threshold);
+  }
+  for (Body::id_type id = 100; id < 140; ++id) {
+    if (id != 110) {
+      Approach const approach = system.findClosestApproach(110, id, 0.0, \
+          2.0e4);
+      if (approach.distance() <= threshold) {
+        expected.emplace_back(approach);
+      }
+    }
+  }
+
+  testEqual(list.size(), expected.size());
+  testFalse(list.empty());
+  for (size_t i = 0; i < std::min(list.size(), expected.size()); ++i) {
+    testEqual(list[i].body(), expected[i].body());
+    testEqual(list[i].time(), expected[i].time());
+    testEqual(list[i].distance(), expected[i].distance());
+  }
+}
+
+UNITTEST(SolarSystem, Attitudes)
+{
+  Body sun(0, 1.9885e30);
+  sun.setAngularVelocity(Rotation(Vector3D(0, 0, 1), 2.865e-6));
+
+  SolarSystem system(sun, 2);
+
+  Body earth(3, 5.97237e24);
+  BodyHandle const earthHandle = system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Body moon(4, 7.342e22);
+  system.addBody(
+      moon,
+      Vector3D(0, 3.633e8, 0),
+      Vector3D(1.082e3, 0, 0),
+      3);
+
+  // the earth's axis is tilted and it turns once a sidereal day
+  Rotation const spin(Vector3D(0, std::sin(0.409), std::cos(0.409)), \
+      2.0 * Constants::PI / 86164.1);
+  system.setAngularVelocity(earthHandle, spin);
+  testEqual(system.getBody(earthHandle)->angularVelocity(), spin);
+
+  second_type const step = 60.0;
+  int const steps = 1000;
+  for (int i = 0; i < steps; ++i) {
+    system.tick(step);
+  }
+
+  Quaternion const expected = Quaternion::fromRotation( \
+      Rotation(spin.axis(), spin.angle() * step * steps));
+  Vector3D const east(1, 0, 0);
+  testNearEqual(system.getOrientation(3).rotate(east).distance( \
+      expected.rotate(east)), 0.0, 0.0, 1e-12);
+  testNearEqual(system.getOrientation(0).toRotation().angle(), \
+      2.865e-6 * step * steps, 0.0, 1e-12);
+  testEqual(system.getOrientation(4), Quaternion());
+
+  std::vector<std::pair<Body const *, Quaternion>> list;
+  system.getOrientations(&list);
+  testEqual(list.size(), 3u);
+  for (std::pair<Body const *, Quaternion> const & pair : list) {
+    testEqual(pair.second, system.getOrientation(pair.first->id()));
+  }
+
+  // a removed body's slot is reused at rest
+  system.removeBody(4);
+  system.setOrientation(earthHandle, Quaternion());
+  Body station(5, 4.2e5);
+  system.addBody(station, Vector3D(0, 7.0e6, 0), Vector3D(7.5e3, 0, 0), 3);
+  testEqual(system.getOrientation(5), Quaternion());
+  testEqual(system.getOrientation(3), Quaternion());
+}
+
+UNITTEST(SolarSystem, BodyFixedFrame)
+{
+  Body sun(0, 1.9885e30);
+
+  SolarSystem system(sun);
+
+  Body earth(3, 5.97237e24);
+  earth.setAngularVelocity(Rotation(Vector3D(0, std::sin(0.409), \
+      std::cos(0.409)), 2.0 * Constants::PI / 86164.1));
+  BodyHandle const earthHandle = system.addBody(
+      earth,
+      Vector3D(0, 1.47095e11, 0),
+      Vector3D(3.029e4, 0, 0),
+      0);
+
+  Body moon(4, 7.342e22);
+  BodyHandle const moonHandle = system.addBody(
+      moon,
+      Vector3D(0, 3.633e8, 0),
+      Vector3D(1.082e3, 0, 0),
+      3);
+
+  Body station(5, 4.2e5);
+  system.addBody(station, Vector3D(0, 7.0e6, 0), Vector3D(7.5e3, 0, 0), 3);
+
+  // the inertial frame is the same as giving no frame
+  testEqual(system.getBodyPositionRelativeTo(4, 3, \
+      SolarSystem::frame_type::INERTIAL), \
+      system.getBodyPositionRelativeTo(4, 3));
+
+  system.tick(5.0e3);
+
+  Quaternion const orientation = system.getOrientation(3);
+  testTrue(orientation != Quaternion());
+
+  std::vector<std::pair<Body const *, Vector3D>> inertial;
+  system.getRelativeTo(3, &inertial);
+  std::vector<std::pair<Body const *, Vector3D>> fixed;
+  system.getRelativeTo(earthHandle, SolarSystem::frame_type::BODY_FIXED, \
+      &fixed);
+  std::vector<std::pair<Body const *, Vector3F>> single;
+  system.getRelativeTo(3, SolarSystem::frame_type::BODY_FIXED, &single);
+
+  testEqual(fixed.size(), inertial.size());
+  testEqual(single.size(), inertial.size());
+  for (size_t i = 0; i < fixed.size(); ++i) {
+    testEqual(fixed[i].first, inertial[i].first);
+    Vector3D const expected = \
+        orientation.conjugate().rotate(inertial[i].second);
+    meter_type const distance = expected.magnitude();
+    testNearEqual(fixed[i].second.distance(expected), 0.0, 0.0, \
+        1.0e-15 * distance);
+    testNearEqual(single[i].second.toVector3D().distance(expected), 0.0, \
+        0.0, 1.0e-6 * distance + 1.0);
+
+    // turning back by the orientation gives the inertial position
+    testNearEqual(orientation.rotate(fixed[i].second).distance( \
+        inertial[i].second), 0.0, 0.0, 1.0e-15 * distance);
+
+    // summed along the path between the bodies rather than from the root,
+    // so only the same to the precision of positions about the sun
+    Vector3D const position = system.getBodyPositionRelativeTo( \
+        fixed[i].first->id(), 3, SolarSystem::frame_type::BODY_FIXED);
+    testNearEqual(position.distance(fixed[i].second), 0.0, 0.0, 1.0e-3);
+  }
+
+  testEqual(system.getBodyPositionRelativeTo(moonHandle, earthHandle, \
+      SolarSystem::frame_type::BODY_FIXED), \
+      system.getBodyPositionRelativeTo(4, 3, \
+      SolarSystem::frame_type::BODY_FIXED));
+}
+
+UNITTEST(SolarSystem, AddCatalog)
+{
+  static constexpr CatalogBody const catalog[] = {
+    CatalogBody(0, 1.9885e30),
+    CatalogBody(3, 0, 5.97237e24, 1.49598023e11, 0.0167086, 0.0, -0.1965, \
+        1.9933, 0.3),
+    CatalogBody(4, 3, 7.342e22, 3.844e8, 0.0549, 0.0898, 2.18, 5.55, 1.0),
+    CatalogBody(5, 0, 6.4171e23, 2.279392e11, 0.0934, 0.0323, 0.865, 5.0, \
+        2.0)
+  };
+
+  SolarSystem system(Body(0, 1.9885e30));
+  system.addBodies(catalog, 4);
+
+  testEqual(system.getParent(4)->id(), 3u);
+  testEqual(system.getBody(5)->mass(), 6.4171e23);
+
+  // the same as adding each body by its orbit
+  SolarSystem expected(Body(0, 1.9885e30));
+  for (size_t i = 1; i < 4; ++i) {
+    CatalogBody const & entry = catalog[i];
+    KeplerOrbit const orbit(entry.semimajorAxis(), entry.eccentricity(), \
+        entry.inclination(), entry.longitudeOfAscendingNode(), \
+        entry.argumentOfPeriapsis(), Catalog::parentMass(catalog, i));
+    expected.addBody(Body(entry.id(), entry.mass()), \
+        OrbitalState(orbit, entry.trueAnomally()), entry.parent());
+  }
+  for (Body::id_type const id : {3, 4, 5}) {
+    testEqual(system.getBodyPositionRelativeTo(id, 0), \
+        expected.getBodyPositionRelativeTo(id, 0));
+  }
+
+  // and with the orbits found at compile time, to within their rounding
+  static constexpr CatalogOrbits<4> const orbits(catalog);
+  SolarSystem derived(Body(0, 1.9885e30));
+  derived.addBodies(catalog, orbits.data(), 4);
+  for (Body::id_type const id : {3, 4, 5}) {
+    Vector3D const position = expected.getBodyPositionRelativeTo(id, 0);
+    testNearEqual(derived.getBodyPositionRelativeTo(id, 0).distance( \
+        position), 0.0, 0.0, 1.0e-14 * position.magnitude());
+  }
+
+  // a catalog rooted elsewhere is rejected
+  CatalogBody const other[] = {CatalogBody(9, 1.0e30)};
+  bool caught = false;
+  try {
+    system.addBodies(other, 1);
+  } catch (std::invalid_argument const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  // as is one with a body orbiting an unknown body, and none of its bodies
+  // are added
+  CatalogBody const orphan[] = {
+    CatalogBody(7, 0, 1.0e20, 3.0e11, 0.1, 0.0, 0.0, 0.0, 0.0),
+    CatalogBody(8, 99, 1.0e15, 1.0e7, 0.1, 0.0, 0.0, 0.0, 0.0)
+  };
+  caught = false;
+  try {
+    system.addBodies(orphan, 2);
+  } catch (std::out_of_range const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  caught = false;
+  try {
+    system.getBody(7);
+  } catch (std::out_of_range const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  // as is one with a body orbiting itself
+  CatalogBody const loop[] = {
+    CatalogBody(7, 0, 1.0e20, 3.0e11, 0.1, 0.0, 0.0, 0.0, 0.0),
+    CatalogBody(8, 8, 1.0e15, 1.0e7, 0.1, 0.0, 0.0, 0.0, 0.0)
+  };
+  caught = false;
+  try {
+    system.addBodies(loop, 2);
+  } catch (std::invalid_argument const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  caught = false;
+  try {
+    system.getBody(7);
+  } catch (std::out_of_range const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
 }
@@ -0,0 +1,160 @@
+/**
+* @file SpatialIndex_test.cpp
+* @brief Unit tests for the SpatialIndex class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-22
+*/
+
+
+#include "SpatialIndex.hpp"
+#include "UnitTest.hpp"
+
+#include <algorithm>
+#include <random>
+
+
+namespace gravitree
+{
+
+namespace
+{
+
+std::vector<Vector3D> randomPoints(
+    size_t const num,
+    unsigned const seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> dist(-1.0e3, 1.0e3);
+
+  std::vector<Vector3D> points;
+  for (size_t i = 0; i < num; ++i) {
+    points.emplace_back(dist(rng), dist(rng), dist(rng));
+  }
+
+  return points;
+}
+
+std::vector<size_t> findWithin(
+    SpatialIndex const & index,
+    Vector3D const & center,
+    double const radius)
+{
+  std::vector<size_t> found;
+  index.within(center, radius, [&found](size_t const item) {
+    found.emplace_back(item);
+  });
+  std::sort(found.begin(), found.end());
+
+  return found;
+}
+
+}
+
+UNITTEST(SpatialIndex, WithinMatchesBruteForce)
+{
+  std::vector<Vector3D> const points = randomPoints(5000, 1);
+
+  // index every other point
+  std::vector<size_t> items;
+  for (size_t i = 0; i < points.size(); i += 2) {
+    items.emplace_back(i);
+  }
+
+  SpatialIndex index;
+  index.build(points.data(), items.data(), items.size());
+  testEqual(index.size(), items.size());
+
+  std::vector<Vector3D> const centers = randomPoints(20, 2);
+  for (Vector3D const & center : centers) {
+    for (double const radius : {10.0, 150.0, 800.0, 4000.0}) {
+      std::vector<size_t> expected;
+      for (size_t const item : items) {
+        if (points[item].distance2(center) <= radius*radius) {
+          expected.emplace_back(item);
+        }
+      }
+
+      testTrue(findWithin(index, center, radius) == expected);
+    }
+  }
+}
+
+UNITTEST(SpatialIndex, InsideMatchesBruteForce)
+{
+  std::vector<Vector3D> const points = randomPoints(3000, 3);
+
+  std::vector<size_t> items;
+  for (size_t i = 0; i < points.size(); ++i) {
+    items.emplace_back(i);
+  }
+
+  SpatialIndex index;
+  index.build(points.data(), items.data(), items.size());
+
+  Vector3D const min(-200.0, -500.0, 100.0);
+  Vector3D const max(300.0, 0.0, 900.0);
+
+  std::vector<size_t> expected;
+  for (size_t const item : items) {
+    Vector3D const & p = points[item];
+    if (p.x() >= min.x() && p.x() <= max.x() && \
+        p.y() >= min.y() && p.y() <= max.y() && \
+        p.z() >= min.z() && p.z() <= max.z()) {
+      expected.emplace_back(item);
+    }
+  }
+
+  std::vector<size_t> found;
+  index.inside(min, max, [&found](size_t const item) {
+    found.emplace_back(item);
+  });
+  std::sort(found.begin(), found.end());
+
+  testTrue(found == expected);
+  testFalse(found.empty());
+}
+
+UNITTEST(SpatialIndex, Refit)
+{
+  std::vector<Vector3D> points = randomPoints(1000, 4);
+
+  std::vector<size_t> items;
+  for (size_t i = 0; i < points.size(); ++i) {
+    items.emplace_back(i);
+  }
+
+  SpatialIndex index;
+  index.build(points.data(), items.data(), items.size());
+
+  // move every point, after which the old hierarchy must still find them
+  std::vector<Vector3D> const offsets = randomPoints(points.size(), 5);
+  for (size_t i = 0; i < points.size(); ++i) {
+    points[i] += offsets[i];
+  }
+  index.refit(points.data());
+
+  Vector3D const center(100.0, -100.0, 50.0);
+  double const radius = 700.0;
+
+  std::vector<size_t> expected;
+  for (size_t const item : items) {
+    if (points[item].distance2(center) <= radius*radius) {
+      expected.emplace_back(item);
+    }
+  }
+
+  testTrue(findWithin(index, center, radius) == expected);
+}
+
+UNITTEST(SpatialIndex, Empty)
+{
+  SpatialIndex index;
+  index.build(nullptr, nullptr, 0);
+
+  testEqual(index.size(), 0U);
+  testTrue(findWithin(index, Vector3D(), 1.0e9).empty());
+}
+
+}
@@ -0,0 +1,102 @@
+/**
+* @file ThreadPool_test.cpp
+* @brief Unit tests for the ThreadPool class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-12
+*/
+
+
+#include "ThreadPool.hpp"
+#include "UnitTest.hpp"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace gravitree
+{
+
+UNITTEST(ThreadPool, numThreads)
+{
+  ThreadPool pool(4);
+  testEqual(pool.numThreads(), 4U);
+
+  ThreadPool single(0);
+  testEqual(single.numThreads(), 1U);
+}
+
+UNITTEST(ThreadPool, coversRange)
+{
+  ThreadPool pool(3);
+
+  for (size_t num : {0U, 1U, 2U, 7U, 1000U}) {
+    std::vector<int> hits(num, 0);
+    pool.parallelFor(num, [&hits](size_t const begin, size_t const end) {
+      for (size_t i = begin; i < end; ++i) {
+        ++hits[i];
+      }
+    });
+
+    for (size_t i = 0; i < num; ++i) {
+      testEqual(hits[i], 1);
+    }
+  }
+}
+
+UNITTEST(ThreadPool, rethrows)
+{
+  ThreadPool pool(4);
+
+  bool caught = false;
+  try {
+    pool.parallelFor(100, [](size_t const begin, size_t const end) {
+      if (begin <= 99 && 99 < end) {
+        throw std::runtime_error("last chunk");
+      }
+    });
+  } catch (std::runtime_error const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  // the pool should still be usable
+  size_t count = 0;
+  pool.parallelFor(1, [&count](size_t const begin, size_t const end) {
+    count += end - begin;
+  });
+  testEqual(count, 1U);
+}
+
+UNITTEST(ThreadPool, concurrentCallers)
+{
+  ThreadPool pool(4);
+
+  size_t const num = 1000;
+  std::vector<std::vector<int>> hits(4, std::vector<int>(num, 0));
+  std::vector<std::thread> callers;
+  for (size_t c = 0; c < hits.size(); ++c) {
+    callers.emplace_back([&pool, &hits, c, num]() {
+      for (int round = 0; round < 50; ++round) {
+        pool.parallelFor(num, [&hits, c](size_t const begin, size_t const end) {
+          for (size_t i = begin; i < end; ++i) {
+            ++hits[c][i];
+          }
+        });
+      }
+    });
+  }
+  for (std::thread & caller : callers) {
+    caller.join();
+  }
+
+  for (std::vector<int> const & counts : hits) {
+    for (int const count : counts) {
+      testEqual(count, 50);
+    }
+  }
+}
+
+}
@@ -0,0 +1,151 @@
+/**
+* @file Vector3DArray_test.cpp
+* @brief Unit tests for the Vector3DArray class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Vector3DArray.hpp"
+#include "Gravity.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+
+namespace gravitree
+{
+
+namespace
+{
+
+Vector3DArray makeArray(
+    size_t const num,
+    double const offset)
+{
+  Vector3DArray array;
+  for (size_t i = 0; i < num; ++i) {
+    array.add(Vector3D(i + offset, 2.0*i - offset, 1.0 - i*offset));
+  }
+  return array;
+}
+
+}
+
+UNITTEST(Vector3DArray, addGetSet)
+{
+  Vector3DArray array(2);
+  testEqual(array.size(), 2u);
+  testEqual(array.get(1), Vector3D(0.0, 0.0, 0.0));
+
+  array.add(Vector3D(1.0, 2.0, 3.0));
+  array.add(CompactVector3D(4.0, 5.0, 6.0));
+  testEqual(array.size(), 4u);
+  testEqual(array.get(2), Vector3D(1.0, 2.0, 3.0));
+  testEqual(array.get(3), Vector3D(4.0, 5.0, 6.0));
+  testEqual(array.x()[3], 4.0);
+  testEqual(array.y()[3], 5.0);
+  testEqual(array.z()[3], 6.0);
+
+  array.set(0, Vector3D(-1.0, -2.0, -3.0));
+  testEqual(array.get(0), Vector3D(-1.0, -2.0, -3.0));
+
+  array.clear();
+  testEqual(array.size(), 0u);
+}
+
+UNITTEST(Vector3DArray, matchesVector3D)
+{
+  size_t const num = 37;
+  Vector3DArray const a = makeArray(num, 0.5);
+  Vector3DArray const b = makeArray(num, -1.25);
+
+  Vector3DArray sum = a;
+  sum += b;
+  Vector3DArray difference = a;
+  difference -= b;
+  Vector3DArray scaled = a;
+  scaled *= 3.0;
+  Vector3DArray shifted = a;
+  shifted -= Vector3D(1.0, 2.0, 3.0);
+  Vector3DArray stepped = a;
+  stepped.addScaled(0.25, b);
+  Vector3DArray normal = a;
+  normal.normalize();
+  Vector3DArray crossed;
+  a.cross(b, &crossed);
+
+  std::vector<double> dots(num);
+  a.dot(b, dots.data());
+  std::vector<double> magnitudes(num);
+  a.magnitude(magnitudes.data());
+  std::vector<double> distances(num);
+  a.distance(b, distances.data());
+  std::vector<double> pointDistances(num);
+  a.distance(b.get(3), pointDistances.data());
+
+  testEqual(crossed.size(), num);
+  for (size_t i = 0; i < num; ++i) {
+    Vector3D const u = a.get(i);
+    Vector3D const v = b.get(i);
+    testEqual(sum.get(i), u + v);
+    testEqual(difference.get(i), u - v);
+    testEqual(scaled.get(i), u * 3.0);
+    testEqual(shifted.get(i), u - Vector3D(1.0, 2.0, 3.0));
+    testEqual(stepped.get(i), u + v*0.25);
+    testNearEqual(normal.get(i).distance(u.normalized()), 0.0, 0.0, 1.0e-15);
+    testEqual(crossed.get(i), u.cross(v));
+    testEqual(dots[i], u * v);
+    testNearEqual(magnitudes[i], u.magnitude(), 1.0e-15, 0.0);
+    testNearEqual(distances[i], u.distance(v), 1.0e-15, 0.0);
+    testNearEqual(pointDistances[i], u.distance(b.get(3)), 1.0e-15, 0.0);
+  }
+}
+
+UNITTEST(Vector3DArray, crossInPlace)
+{
+  Vector3DArray a;
+  a.add(Vector3D(1.0, 0.0, 0.0));
+  Vector3DArray b;
+  b.add(Vector3D(0.0, 1.0, 0.0));
+
+  a.cross(b, &a);
+  testEqual(a.get(0), Vector3D(0.0, 0.0, 1.0));
+}
+
+UNITTEST(Vector3DArray, sizeMismatch)
+{
+  Vector3DArray a = makeArray(3, 0.0);
+  Vector3DArray const b = makeArray(4, 0.0);
+
+  bool caught = false;
+  try {
+    a += b;
+  } catch (std::invalid_argument const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+UNITTEST(Vector3DArray, gravity)
+{
+  size_t const num = 16;
+  Vector3DArray const offsets = makeArray(num, 7.0e6);
+
+  Vector3DArray accelerations;
+  Gravity::acceleration(5.9722e24, offsets, &accelerations);
+
+  testEqual(accelerations.size(), num);
+  for (size_t i = 0; i < num; ++i) {
+    Vector3D const expected = \
+        Gravity::acceleration(5.9722e24, offsets.get(i));
+    testNearEqual(accelerations.get(i).distance(expected), 0.0, 0.0, \
+        1.0e-14 * expected.magnitude());
+  }
+}
+
+}
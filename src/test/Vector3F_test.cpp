@@ -0,0 +1,49 @@
+/**
+* @file Vector3F_test.cpp
+* @brief Unit tests for the Vector3F class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "Vector3F.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+
+namespace gravitree
+{
+
+UNITTEST(Vector3F, size)
+{
+  testEqual(sizeof(Vector3F), 3*sizeof(float));
+}
+
+UNITTEST(Vector3F, fromVector3D)
+{
+  Vector3D const v(1.5, -2.25, 1.0e10);
+  Vector3F const f(v);
+
+  testEqual(f.x(), 1.5f);
+  testEqual(f.y(), -2.25f);
+  testEqual(f.z(), static_cast<float>(1.0e10));
+  testNearEqual(f.toVector3D().distance(v), 0.0, 0.0, 1.0e10 * 1.0e-7);
+}
+
+UNITTEST(Vector3F, arithmetic)
+{
+  Vector3F const v(5.0f, 0.0f, 0.0f);
+  Vector3F const u(0.0f, 5.0f, 0.0f);
+
+  testEqual(v + u, Vector3F(5.0f, 5.0f, 0.0f));
+  testEqual(v - u, Vector3F(5.0f, -5.0f, 0.0f));
+  testEqual(v * 2.0f, Vector3F(10.0f, 0.0f, 0.0f));
+  testEqual(v * u, 0.0f);
+  testEqual(v.magnitude(), 5.0f);
+  testEqual(v.distance(u), std::sqrt(50.0f));
+  testTrue(v != u);
+}
+
+}
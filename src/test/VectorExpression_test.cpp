@@ -0,0 +1,48 @@
+/**
+* @file VectorExpression_test.cpp
+* @brief Unit tests for the vector expression templates.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-08-27
+*/
+
+
+#include "VectorExpression.hpp"
+#include "Output.hpp"
+#include "UnitTest.hpp"
+
+
+namespace gravitree
+{
+
+UNITTEST(VectorExpression, matchesEager)
+{
+  Vector3D const r(7.0e6, -1.3e6, 2.2e5);
+  Vector3D const v(1.1e3, 7.4e3, -6.0e2);
+  Vector3D const h = r.cross(v);
+  double const mu = 3.986004418e14;
+
+  Vector3D const eager = (v.cross(h) / mu) - (r / r.magnitude());
+  Vector3D const lazyResult = evaluate((cross(lazy(v), lazy(h)) / mu) - \
+      (lazy(r) / r.magnitude()));
+  testEqual(lazyResult, eager);
+  testEqual(lazyResult.magnitude2(), eager.magnitude2());
+
+  testEqual(evaluate(lazy(r)*2.0 + lazy(v)*-3.0), r*2.0 + v*-3.0);
+  testEqual(evaluate(r + lazy(v) - h), r + v - h);
+  testEqual(evaluate(-(lazy(r) - v)), -(r - v));
+  testEqual(dot(lazy(r), lazy(v) + h), r * (v + h));
+}
+
+UNITTEST(VectorExpression, aliasing)
+{
+  Vector3D sum(1.0, 2.0, 3.0);
+  Vector3D const step(0.5, -1.0, 4.0);
+
+  // the expression is read completely before the result is assigned
+  sum = evaluate(lazy(sum) + lazy(step)*2.0);
+  testEqual(sum, Vector3D(2.0, 0.0, 11.0));
+}
+
+}